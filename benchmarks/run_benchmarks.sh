@@ -0,0 +1,85 @@
+#!/bin/sh
+#
+# Run the A2Geant4 benchmark scenarios and collect their JSON reports.
+#
+# Usage: benchmarks/run_benchmarks.sh <A2Geant4 binary> [output directory] [scenario ...]
+#
+# Must be run from the top-level source directory (detector setup files are
+# read from data/). The number of worker threads is taken from the
+# A2_BENCH_THREADS environment variable (default: 1).
+# The combined report is written to <output directory>/benchmarks.json.
+# Scenarios whose field map is not available (e.g. polarized_proton without
+# data/wouter_field_map.dat.xz, which is not part of the repository) are
+# skipped.
+
+if [ $# -lt 1 ]; then
+    echo "Usage: $0 <A2Geant4 binary> [output directory] [scenario ...]"
+    exit 1
+fi
+
+BIN=$1
+OUTDIR=${2:-benchmark_results}
+[ $# -ge 2 ] && shift 2 || shift 1
+SCENARIOS=${*:-"cb_photon cb_photon_fast standard_pi0 polarized_proton cherenkov_electron"}
+THREADS=${A2_BENCH_THREADS:-1}
+
+# detector setup of each scenario
+detector_setup()
+{
+    case $1 in
+        cb_photon)          echo det_cb ;;
+        cb_photon_fast)     echo det_cb ;;
+        standard_pi0)       echo det_standard ;;
+        polarized_proton)   echo det_polarized ;;
+        cherenkov_electron) echo det_cherenkov ;;
+        *)                  echo "" ;;
+    esac
+}
+
+mkdir -p "$OUTDIR" || exit 1
+REPORT="$OUTDIR/benchmarks.json"
+STATUS=0
+
+echo "[" > "$REPORT"
+FIRST=1
+for S in $SCENARIOS; do
+    DET=$(detector_setup "$S")
+    if [ -z "$DET" ]; then
+        echo "Unknown benchmark scenario '$S'"
+        STATUS=1
+        continue
+    fi
+
+    # skip scenarios whose field map is missing
+    FIELDMAP=$(sed -n 's|^/A2/det/setTargetMagneticFieldMap *||p' "benchmarks/$DET.mac")
+    if [ -n "$FIELDMAP" ] && [ ! -f "$FIELDMAP" ]; then
+        echo "Skipping benchmark '$S': field map $FIELDMAP not found"
+        continue
+    fi
+
+    # wrapper macro setting the output files of the scenario
+    MAC="$OUTDIR/$S.mac"
+    echo "/control/alias benchOut $OUTDIR/$S.root" > "$MAC"
+    echo "/control/alias benchJson $OUTDIR/$S.json" >> "$MAC"
+    echo "/control/execute benchmarks/$S.mac" >> "$MAC"
+    rm -f "$OUTDIR/$S.json"
+
+    echo "Running benchmark '$S' ($THREADS threads)"
+    if ! "$BIN" --det="benchmarks/$DET.mac" --mac="$MAC" --threads="$THREADS" > "$OUTDIR/$S.log" 2>&1 \
+       || [ ! -f "$OUTDIR/$S.json" ]; then
+        echo "Benchmark '$S' failed, see $OUTDIR/$S.log"
+        STATUS=1
+        continue
+    fi
+
+    # add the scenario report to the combined report
+    [ $FIRST -eq 1 ] || echo "," >> "$REPORT"
+    FIRST=0
+    printf '{ "scenario": "%s", "report": ' "$S" >> "$REPORT"
+    cat "$OUTDIR/$S.json" >> "$REPORT"
+    echo "}" >> "$REPORT"
+done
+echo "]" >> "$REPORT"
+
+echo "Benchmark report written to $REPORT"
+exit $STATUS
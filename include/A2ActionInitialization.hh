@@ -0,0 +1,34 @@
+// user action initialization for sequential and multithreaded runs
+
+#ifndef A2ActionInitialization_h
+#define A2ActionInitialization_h 1
+
+#include "G4VUserActionInitialization.hh"
+#include "globals.hh"
+
+class A2DetectorConstruction;
+class A2EventAction;
+
+class A2ActionInitialization : public G4VUserActionInitialization
+{
+public:
+    A2ActionInitialization(A2DetectorConstruction* det, int argc, char** argv,
+                           const char* detSetup, G4int isInteractive,
+                           A2EventAction* masterEventAction = 0);
+    virtual ~A2ActionInitialization() { }
+
+    virtual void Build() const;
+    virtual void BuildForMaster() const;
+    virtual G4VSteppingVerbose* InitializeSteppingVerbose() const;
+
+private:
+    A2DetectorConstruction* fDetCon;        // detector construction
+    int fArgc;                              // number of command line arguments
+    char** fArgv;                           // command line arguments
+    G4String fDetSetup;                     // detector setup macro
+    G4int fIsInteractive;                   // batch(0) or interactive(1) mode
+    A2EventAction* fMasterEventAction;      // event action of the master (merges thread output)
+};
+
+#endif
+
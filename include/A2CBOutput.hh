@@ -1,4 +1,3 @@
-
 #ifndef A2CBOutput_h
 #define A2CBOutput_h 1
 
@@ -7,16 +6,66 @@
 #include "A2Hit.hh"
 #include "G4HCofThisEvent.hh"
 
+#include <vector>
+#include <thread>
+#include <atomic>
 
 #include "TLorentzVector.h"
 #include "TFile.h"
 #include "TTree.h"
 
-const G4int MAXSIZE_NAI= 720;
-const G4int MAXSIZE_TAPS= 512;
-const G4int MAXSIZE_PID= 24;
-const G4int MAXSIZE_MWPC = 400;
-const G4int MAXSIZE_PIZZA = 24;
+//Hit quantities which can be written to an output column
+enum EA2HitQuantity {
+  kHitNone,      //always 0
+  kHitID,        //detector element ID
+  kHitEdep,      //deposited energy
+  kHitWEdep,     //deposited energy weighted with the track weights (biased tracking)
+  kHitTime,      //time
+  kHitParticle,  //index of the primary particle
+  kHitPosX,      //hit position
+  kHitPosY,
+  kHitPosZ
+};
+
+//Output column of a detector, i.e. a variable-length branch indexed by
+//the count branch of the detector
+struct A2OutputColumn_t {
+  G4String fName;            //branch name
+  EA2HitQuantity fQuantity;  //hit quantity stored in the branch
+  G4bool fIsInt;             //integer(true) or float(false) branch
+  G4double fUnit;            //unit of the stored values (float branches)
+  std::vector<Int_t> fI;     //buffer of integer branches
+  std::vector<Float_t> fF;   //buffer of float branches
+};
+
+//Output of a detector: a count branch plus the columns filled from the
+//hits of one or more hits collections
+struct A2OutputDetector_t {
+  G4String fName;                         //detector name
+  G4String fCount;                        //name of the count branch
+  std::vector<G4String> fCollections;     //names of the hits collections
+  std::vector<A2OutputColumn_t> fColumns; //output columns
+  Int_t fN;                               //number of hits in this event
+  G4int fCapacity;                        //size of the column buffers
+  Float_t* fESum;                         //optional sum of the deposited energy [GeV]
+  G4double fThreshold;                    //readout threshold (hits with lower energy are dropped)
+  Long64_t fNSuppressed;                  //number of hits dropped by the threshold
+};
+
+//Memory block of a branch which is copied into the event records of
+//the asynchronous output writer
+struct A2OutputSegment_t {
+  TBranch* fBranch;        //branch
+  void* fAddr;             //address of the branch buffer
+  A2OutputColumn_t* fCol;  //column (address of a growing buffer) or NULL
+  Int_t* fCount;           //number of entries (variable-length arrays) or NULL
+  Int_t fSize;             //size of one entry [bytes]
+};
+
+//Flat copy of all branch buffers of one event
+struct A2OutputRecord_t {
+  std::vector<std::vector<char> > fData; //one memory block per segment
+};
 
 class A2CBOutput 
 {
@@ -32,71 +81,59 @@ protected:
   TFile* fFile;   //Root output file
   TTree* fTree;    //ROOT output tree
 
+  std::vector<A2OutputDetector_t*> fDetectors; //registered detector outputs
+  std::vector<std::pair<G4int,A2OutputDetector_t*> > fWriters; //dispatch table hits collection ID -> detector output
+  G4bool fBranchesSet; //branches were created, no more registration possible
+  Int_t fBasketSize; //basket size of the branches [bytes]
+
+  //asynchronous output writer
+  std::vector<A2OutputSegment_t> fSegments; //branch memory blocks
+  std::vector<A2OutputRecord_t> fQueue; //single-producer single-consumer ring buffer of events
+  std::atomic<size_t> fQueueHead; //next record to be written (writer thread)
+  std::atomic<size_t> fQueueTail; //next free record (event thread)
+  std::atomic<bool> fWriterStop; //no more events will be queued
+  std::thread fWriter; //writer thread
+  Long64_t fNQueueStalls; //number of events waiting for a free record
+  Double_t fWriterTime; //time spent in TTree::Fill() by the writer thread [s]
+
   Float_t fbeam[5]; //beam branch Px,Py,Pz(all unit),Pt,E
-  //  Float_t **fdircos; //direction cosines of generated particles
-  Float_t fdircos[100][3]; //direction cosines of generated particles
-  Float_t fecryst[MAXSIZE_NAI];  //Energy deposited in each NaI crystal
-  Float_t ftcryst[MAXSIZE_NAI];  //Time of hit in each NaI crystal
-  Float_t fectapfs[MAXSIZE_TAPS];  //Fast compenent of energy deposited in TAPS crystals 
-  Float_t fectapsl[MAXSIZE_TAPS];  //Slow compenent of energy deposited in TAPS crystals(currently Edep in taps)
-  Float_t *felab;    //Energy of initial generatd particles
+  std::vector<Float_t> fdircos; //direction cosines of generated particles [fnpart][3]
+  std::vector<Float_t> felab;    //Energy of initial generatd particles
   Float_t feleak;    //Energy leaking out of system (NOT CURRENTLY IMPLEMENTED)
-  Float_t fenai;     //Total energy deposited in NaI
+  Float_t fenai;     //Total energy deposited in NaI (NOT CURRENTLY IMPLEMENTED)
   Float_t fetot;     //Total energy deposited in all detectors
-  Float_t feveto[MAXSIZE_PID];  //Energy deposited in PID elements
-  Float_t ftveto[MAXSIZE_PID];  //Time of hit in PID elements
-  Float_t fevtaps[MAXSIZE_TAPS];  //Energy deposited in TAPS veto counter
-  Int_t ficryst[MAXSIZE_NAI];   //id numbers of Nai hits
-  Int_t fpcryst[MAXSIZE_NAI];  //particle index in each NaI crystal
-  Int_t fictaps[MAXSIZE_TAPS];   //id numbers of TAPS hits
-  Int_t fpctaps[MAXSIZE_TAPS];   //particle index in each TAPS crystal
-  Int_t fivtaps[MAXSIZE_TAPS];   //id numbers of TAPS veto hits
-  Int_t fpvtaps[MAXSIZE_TAPS];   //particle index in each TAPS veto
-  Int_t *fidpart;   //g3 id number of initial generated particle
-  Int_t fiveto[MAXSIZE_PID];    //id number of the PID hits
-  Int_t fpveto[MAXSIZE_PID];    //particle index in each PID element
-  Int_t fnhits;    //Number of NaI hits
+  std::vector<Int_t> fidpart;   //g3 id number of initial generated particle
   Int_t fnpart;    //number of generated particles (not necessarily same as # tracked)
-  Int_t fntaps;    //Number of hits in TAPS
-  Int_t fnvtaps;    //Number of veto hits in TAPS
-  Float_t *fplab;   //momentum of original generated particles
-  Float_t ftctaps[MAXSIZE_TAPS];  //Time of hits in TAPS
+  std::vector<Float_t> fplab;   //momentum of original generated particles
   Float_t *fvertex;  //Vertex position
-  Int_t fvhits;     //Number of hits in PID
- 
-  Int_t fnmwpc; //total no. wc hits
-  Int_t fimwpc[MAXSIZE_MWPC]; //layer id of hit
-  Float_t fmposx[MAXSIZE_MWPC]; //position of hit
-  Float_t fmposy[MAXSIZE_MWPC]; //position of hit
-  Float_t fmposz[MAXSIZE_MWPC]; //position of hit
-  Float_t femwpc[MAXSIZE_MWPC]; //position of hit
-
-  //New TOF hits
-  Int_t fToFTot; //total number of constructed tof bars
-  Int_t fntof; //Number of hits in TOF
-  Int_t *ftofi; //hit bar indexes
-  Float_t *ftofe; //hit bar energy deposits
-  Float_t *ftoft; //hit bar time
-  Float_t *ftofx; //x hit position
-  Float_t *ftofy; //y hit position
-  Float_t *ftofz; //z hit position
-
-  Int_t fnpiz; //Number of hits in Pizza detector
-  Int_t fipiz[MAXSIZE_PIZZA]; //hit sector indexes
-  Float_t fepiz[MAXSIZE_PIZZA]; //hit sector energy deposits
-  Float_t ftpiz[MAXSIZE_PIZZA]; //hit sector time
 
   G4bool fIsGiBUU; // Is this a GiBUU file
   Float_t fweight; // event weight
 
+  G4bool fStoreEventID; // Store the Geant4 event number (multithreaded mode)
+  Int_t feventid; // Geant4 event number
+
+  G4bool fStoreEventStats; // Store the per-event tracking statistics
+  Float_t fevtime; // tracking wall time [s]
+  Int_t fnsteps; // number of steps
+  Int_t fntracks; // number of tracks
+  Float_t frss; // RSS high-water mark [MB]
+
   TLorentzVector** fGenLorentzVec;
   TLorentzVector* fBeamLorentzVec;
   Int_t *fGenPartType;
 
-  G4int fCBCollID;
-  G4int fTAPSCollID;
   G4bool fStorePrimaries;
 
+  void RegisterDetectors();
+  void GrowDetector(A2OutputDetector_t* det, G4int n);
+  void WriteCollection(A2OutputDetector_t* det, G4VHitsCollection* hc);
+  void AddBranch(const char* name, void* addr, const char* leaflist, Int_t size,
+                 Int_t* count=NULL, A2OutputColumn_t* col=NULL);
+  void PackRecord(A2OutputRecord_t& rec);
+  void UnpackRecord(A2OutputRecord_t& rec);
+  void RunWriter();
+
 public:
   void SetFile(TFile* f){fFile=f;fTree->SetDirectory(fFile);}
   TFile* GetFile(){return fFile;}
@@ -104,10 +141,32 @@ public:
   void SetTree(TTree* t){fTree=t;}
   TTree* GetTree(){return fTree;}
  
+  A2OutputDetector_t* AddDetector(const G4String& name, const G4String& count, G4int capacity,
+                                  G4double threshold=0);
+  void AddCollection(A2OutputDetector_t* det, const G4String& collection);
+  void AddColumn(A2OutputDetector_t* det, const G4String& name, EA2HitQuantity quantity,
+                 G4bool isInt, G4double unit=1.);
+
   void SetBranches();
+  void ResolveCollectionIDs();
   void SetStorePrimaries(G4bool val) { fStorePrimaries = val; }
+  G4bool GetStorePrimaries() const { return fStorePrimaries; }
+  void SetTotalEnergy(A2OutputDetector_t* det) { if(det) det->fESum=&fetot; } //energy sum of det is written to etot
+  void SetStoreEventID(G4bool val) { fStoreEventID = val; }
+  void SetBasketSize(Int_t val) { fBasketSize = val; }
+  void SetAutoFlush(Long64_t val) { fTree->SetAutoFlush(val); }
+  void SetAutoSave(Long64_t val) { fTree->SetAutoSave(val); }
+  void SetEventID(G4int id) { feventid = id; }
+  void SetStoreEventStats(G4bool val) { fStoreEventStats = val; }
+  void SetEventStats(Float_t time, Int_t steps, Int_t tracks, Float_t rss)
+    { fevtime = time; fnsteps = steps; fntracks = tracks; frss = rss; }
   
   void WriteTree(){fTree->Write();}
+  void Fill();
+  void StartWriter(G4int depth);
+  void StopWriter();
+  Double_t GetWriterTime() const { return fWriterTime; }
+  const std::vector<A2OutputDetector_t*>& GetDetectors() const { return fDetectors; }
   void WriteHit(G4HCofThisEvent* );
   void WriteGenInput();
 };
@@ -115,13 +174,3 @@ public:
 
 
 #endif
-
-
-
-
-
-
-
-
-
-
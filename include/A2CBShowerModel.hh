@@ -0,0 +1,40 @@
+// parameterised electromagnetic showers in the Crystal Ball crystals
+
+#ifndef A2CBShowerModel_h
+#define A2CBShowerModel_h 1
+
+#include "A2ShowerModel.hh"
+
+class G4Material;
+
+class A2CBShowerModel : public A2ShowerModel
+{
+
+protected:
+    const G4Material* fMaterial;            // material of the cached shower parameters
+    G4double fRadLength;                    // radiation length of fMaterial
+    G4double fMoliere;                      // Moliere radius of fMaterial
+    G4double fCritEnergy;                   // critical energy of fMaterial
+
+    static G4ThreadLocal A2CBShowerModel* fgInstance;  // model of this thread
+    static G4bool fgEnabled;                // model switched on
+    static G4double fgMinEnergy;            // minimum kinetic energy of e+-/gamma
+    static G4double fgSpotEnergy;           // energy of one energy spot
+
+    void SetMaterial(const G4Material* mat);
+
+public:
+    A2CBShowerModel(G4Region* region);
+    virtual ~A2CBShowerModel();
+
+    virtual G4bool ModelTrigger(const G4FastTrack& fastTrack);
+    virtual void DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep);
+
+    static A2CBShowerModel* Instance() { return fgInstance; }
+    static void SetEnabled(G4bool enabled) { fgEnabled = enabled; }
+    static void SetMinEnergy(G4double e) { fgMinEnergy = e; }
+    static void SetSpotEnergy(G4double e) { fgSpotEnergy = e; }
+    static G4bool IsEnabled() { return fgEnabled; }
+};
+
+#endif
@@ -27,6 +27,10 @@ public:
 
   G4VPhysicalVolume* Construct(G4LogicalVolume *MotherLogic);
 
+  //output columns (static: the count branch is also written without the ball, as in cbsim)
+  static void AddOutput(A2CBOutput* out, A2DetectorConstruction* det);
+  void RegisterOutput(A2CBOutput* out, A2DetectorConstruction* det){AddOutput(out,det);}
+
   void MakeCrystals();  //Make the different crystal shapes
   void MakeBall();  //Make the ball
    void MakeOther1();  //Make other non-sensitive materials associated with the ball
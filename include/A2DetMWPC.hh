@@ -29,6 +29,7 @@ public:
   void MakeSensitiveDetector();
 
   G4VPhysicalVolume* Construct(G4LogicalVolume *MotherLogic);
+  void RegisterOutput(A2CBOutput* out, A2DetectorConstruction* det);
 
   void UseAnodes(G4bool use=true){fuseAnodes=use;}
   
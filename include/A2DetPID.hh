@@ -25,6 +25,10 @@ public:
   ~A2DetPID();
 
   G4VPhysicalVolume* Construct(G4LogicalVolume *){return NULL;}
+
+  //output columns (static: the count branch is also written without the PID, as in cbsim)
+  static void AddOutput(A2CBOutput* out, A2DetectorConstruction* det);
+  void RegisterOutput(A2CBOutput* out, A2DetectorConstruction* det){AddOutput(out,det);}
   G4VPhysicalVolume* Construct1(G4LogicalVolume *MotherLogic,G4double Z0);
   G4VPhysicalVolume* Construct2(G4LogicalVolume *MotherLogic,G4double Z0);
 
@@ -27,6 +27,7 @@ public:
   ~A2DetPID3();
 
   G4VPhysicalVolume* Construct(G4LogicalVolume *){return NULL;}
+  void RegisterOutput(A2CBOutput* out, A2DetectorConstruction* det); //same output as A2DetPID
   G4VPhysicalVolume* Construct1(G4LogicalVolume *MotherLogic, G4double Z0);
 
   void MakeDetector1();
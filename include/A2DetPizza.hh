@@ -29,6 +29,9 @@ public:
     void SetCheckOverlap(G4bool b) { fIsCheckOverlap = b; }
 
     virtual G4VPhysicalVolume* Construct(G4LogicalVolume* motherLogic);
+    virtual void RegisterOutput(A2CBOutput* out, A2DetectorConstruction* det) { AddOutput(out, det); }
+
+    static void AddOutput(A2CBOutput* out, A2DetectorConstruction* det);
 
     static const G4double fgDefaultZPos;
 };
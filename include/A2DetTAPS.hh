@@ -29,6 +29,11 @@ public:
 
   G4VPhysicalVolume* Construct(G4LogicalVolume *MotherLogic);
 
+  //output columns of the crystals and the vetos (static: the count branches
+  //are also written without TAPS, as in cbsim)
+  static void AddOutput(A2CBOutput* out, A2DetectorConstruction* det);
+  void RegisterOutput(A2CBOutput* out, A2DetectorConstruction* det){AddOutput(out,det);}
+
   void MakeCrystals();
   void PlaceCrystals();
   void MakeVeto();
@@ -20,6 +20,7 @@ public:
   ~A2DetTOF();
 
   G4VPhysicalVolume* Construct(G4LogicalVolume *MotherLogic);
+  void RegisterOutput(A2CBOutput* out, A2DetectorConstruction* det);
   void ReadParameters(G4String parfile);
 
 private:
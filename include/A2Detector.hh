@@ -10,6 +10,8 @@ Contains general functions for visulisation...
 
 class G4LogicalVolume;
 class G4VPhysicalVolume;
+class A2CBOutput;
+class A2DetectorConstruction;
 
 class A2Detector
 {
@@ -19,6 +21,7 @@ public:
   ~A2Detector();
   
   virtual G4VPhysicalVolume* Construct(G4LogicalVolume *MotherLogic)=0; //Build the detector
+  virtual void RegisterOutput(A2CBOutput*, A2DetectorConstruction*){} //Declare the output columns (default: none)
 
   G4VPhysicalVolume* GetPhysi(){return fMyPhysi;};
   G4LogicalVolume* GetLogic(){return fMyLogic;}
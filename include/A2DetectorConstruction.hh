@@ -22,6 +22,7 @@ class G4LogicalVolume;
 class G4VPhysicalVolume;
 class G4Material;
 class A2DetectorMessenger;
+class A2CBOutput;
 
 
 class A2DetectorConstruction : public G4VUserDetectorConstruction
@@ -34,6 +35,9 @@ class A2DetectorConstruction : public G4VUserDetectorConstruction
   public:
    
      G4VPhysicalVolume* Construct();
+     void ConstructSDandField();
+     void AttachTargetMagneticField();
+     void RegisterOutput(A2CBOutput* out);
 
      void UpdateGeometry();
      void DefineMaterials();
@@ -58,6 +62,15 @@ class A2DetectorConstruction : public G4VUserDetectorConstruction
   void SetTargetZ(G4double zz){fTargetZ=zz;}
   void SetTargetMagneticCoils(G4String &type) { fTypeMagneticCoils = type; }
   void SetTargetMagneticFieldMap(G4String &name) { fNameFileFieldMap = name; }
+  void SetTargetMagneticFieldStorage(G4String &storage) { fFieldStorage = storage; }
+  void SetTargetMagneticFieldTrilinear(G4bool t) { fFieldTrilinear = t; }
+  void BenchmarkTargetMagneticField(G4int nCalls);
+  //target field integration
+  void SetTargetMagneticFieldStepper(G4String stepper) { fFieldStepper = stepper; }
+  void SetTargetMagneticFieldMinStep(G4double s) { fFieldMinStep = s; }
+  void SetTargetMagneticFieldDeltaChord(G4double d) { fFieldDeltaChord = d; }
+  void SetTargetMagneticFieldDeltaOneStep(G4double d) { fFieldDeltaOneStep = d; }
+  void SetTargetMagneticFieldLocal(G4bool l) { fFieldLocal = l; }
   void SetHemiGap(G4ThreeVector zz){fHemiGap=zz;}
   void SetCBCrystGeometry(G4String geo) { fCBCrystGeometry = geo; }
   void SetTAPSFile(G4String file){fTAPSSetupFile=file;}
@@ -68,6 +81,22 @@ class A2DetectorConstruction : public G4VUserDetectorConstruction
   void SetPIDRotation(G4double rot){fPIDRotation=rot;}
   void SetPizzaZ(G4double zz){fPizzaZ=zz;}
 
+  //readout thresholds (hits with lower energy deposits are not written)
+  void SetCBThreshold(G4double e){fCBThreshold=e;}
+  void SetTAPSThreshold(G4double e){fTAPSThreshold=e;}
+  void SetTAPSVetoThreshold(G4double e){fTAPSVetoThreshold=e;}
+  void SetPIDThreshold(G4double e){fPIDThreshold=e;}
+  void SetMWPCThreshold(G4double e){fMWPCThreshold=e;}
+  void SetTOFThreshold(G4double e){fTOFThreshold=e;}
+  void SetPizzaThreshold(G4double e){fPizzaThreshold=e;}
+  G4double GetCBThreshold() const {return fCBThreshold;}
+  G4double GetTAPSThreshold() const {return fTAPSThreshold;}
+  G4double GetTAPSVetoThreshold() const {return fTAPSVetoThreshold;}
+  G4double GetPIDThreshold() const {return fPIDThreshold;}
+  G4double GetMWPCThreshold() const {return fMWPCThreshold;}
+  G4double GetTOFThreshold() const {return fTOFThreshold;}
+  G4double GetPizzaThreshold() const {return fPizzaThreshold;}
+
   A2Target* GetTarget(){return fTarget;}
 
   G4int GetNToFbars(){
@@ -109,6 +138,13 @@ public:
   G4double fTargetZ;
   G4String fTypeMagneticCoils;
   G4String fNameFileFieldMap;
+  G4String fFieldStorage;
+  G4bool fFieldTrilinear;
+  G4String fFieldStepper;
+  G4double fFieldMinStep;
+  G4double fFieldDeltaChord;
+  G4double fFieldDeltaOneStep;
+  G4bool fFieldLocal;   //field only in the target, PID and MWPC volumes
 
   G4String fDetectorSetup; //Configuration macro name
   A2DetectorMessenger* fDetMessenger;  //pointer to the Messenger
@@ -140,6 +176,15 @@ public:
   // Pizza setup
   G4double fPizzaZ;
 
+  //readout thresholds
+  G4double fCBThreshold;
+  G4double fTAPSThreshold;
+  G4double fTAPSVetoThreshold;
+  G4double fPIDThreshold;
+  G4double fMWPCThreshold;
+  G4double fTOFThreshold;
+  G4double fPizzaThreshold;
+
 private:
     
    
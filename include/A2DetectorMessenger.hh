@@ -41,6 +41,13 @@ class A2DetectorMessenger: public G4UImessenger
     G4UIcmdWithADoubleAndUnit* fTargetRadiusCmd;
     G4UIcmdWithADoubleAndUnit* fTargetZCmd;
     G4UIcmdWithAString*      fTargetMagneticFieldCmd;
+    G4UIcmdWithAString*      fTargetFieldInterpolationCmd;
+    G4UIcmdWithAnInteger*      fTargetFieldBenchmarkCmd;
+    G4UIcmdWithAString*      fTargetFieldStepperCmd;
+    G4UIcmdWithADoubleAndUnit* fTargetFieldMinStepCmd;
+    G4UIcmdWithADoubleAndUnit* fTargetFieldDeltaChordCmd;
+    G4UIcmdWithADoubleAndUnit* fTargetFieldDeltaOneStepCmd;
+    G4UIcmdWithAString*      fTargetFieldVolumesCmd;
     G4UIcmdWith3VectorAndUnit* fHemiGapCmd;
     G4UIcmdWithAString*       fCBCrystGeoCmd;
     G4UIcmdWithAString*      fTAPSFileCmd;
@@ -51,6 +58,13 @@ class A2DetectorMessenger: public G4UImessenger
     G4UIcmdWithADoubleAndUnit* fPIDZCmd;
     G4UIcmdWithADoubleAndUnit* fPIDRotCmd;
     G4UIcmdWithADoubleAndUnit* fPizzaZCmd;
+    G4UIcmdWithADoubleAndUnit* fCBThresholdCmd;
+    G4UIcmdWithADoubleAndUnit* fTAPSThresholdCmd;
+    G4UIcmdWithADoubleAndUnit* fTAPSVetoThresholdCmd;
+    G4UIcmdWithADoubleAndUnit* fPIDThresholdCmd;
+    G4UIcmdWithADoubleAndUnit* fMWPCThresholdCmd;
+    G4UIcmdWithADoubleAndUnit* fTOFThresholdCmd;
+    G4UIcmdWithADoubleAndUnit* fPizzaThresholdCmd;
  };
 
 #endif
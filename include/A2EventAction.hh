@@ -8,6 +8,9 @@
 #include "TTree.h"
 #include "TString.h"
 
+#include <vector>
+#include <map>
+
 #include "A2CBOutput.hh"
 
 class A2RunAction;
@@ -30,12 +33,22 @@ class A2EventAction : public G4UserEventAction
    void SetOverwriteFile   (G4bool val)  {fOverwriteFile = val;}
    void SetPrintModulo(G4int    val)  {fprintModulo = val;}
    void SetReqEvents(G4int ev) { fReqEvents = ev; }
-  void SetCBCollID(G4int val){fCBCollID=val;}
   void SetIsInteractive(G4int is){fIsInteractive=is;}
   void SetHitDrawOpt(G4String val){fHitDrawOpt=val;}
   void SetStorePrimaries(G4bool val) { fStorePrimaries = val; }
+  void SetStoreEventStats(G4bool val) { fStoreEventStats = val; }
   void SetOutFileName(TString name){fOutFileName=name;}
+  void SetIsMaster(G4bool val){fIsMaster=val;}
+  void SetCompressionAlgorithm(G4String val){fCompAlgo=val;}
+  void SetCompressionLevel(G4int val){fCompLevel=val;}
+  void SetBasketSize(G4int val){fBasketSize=val;}
+  void SetAutoFlush(G4int val){fAutoFlush=val;}
+  void SetAutoSave(G4int val){fAutoSave=val;}
+  void SetAsyncOutput(G4int val){fAsyncDepth=val;}
+  void SetBenchmarkFile(TString name){fBenchFile=name;}
+  void SetProcessedEvents(G4int n){fNEvtRun=n;}
   G4int PrepareOutput();
+  void ResolveCollectionIDs();
   void CloseOutput();
  private:
    A2RunAction*  frunAct;
@@ -47,26 +60,55 @@ class A2EventAction : public G4UserEventAction
    G4int     fprintModulo;
    G4double fEventRate;
    G4int fReqEvents;
+   G4int fNEvtThread; //events of this run processed by this thread
   TStopwatch* fTimer;
    //G4int     fDrawMode;
   G4String fHitDrawOpt;
   G4bool fOverwriteFile;
   G4bool fStorePrimaries;
+  G4bool fStoreEventStats; //store the per-event tracking statistics as branches
   TString fInvokeCmd;
   TString fStartTime;
   TString fDuration;
   TString fDetSetup;
+  TString fBenchFile; //benchmark report (JSON), not written if empty
+  G4int fNEvtRun; //events processed in this run (all threads)
+  Double_t fInitTime; //time from the program start to the start of the first run [s]
 
    A2EventActionMessenger*  feventMessenger;
 
-  G4int fCBCollID;
+  std::vector<G4int> fVisCollIDs; //IDs of the hits collections drawn in interactive mode
 
   //ROOT output stuff
   TFile* fOutFile;
   TTree* fOutTree;
   TString fOutFileName;
 
+  //ROOT output settings and statistics
+  G4String fCompAlgo; //compression algorithm (default, zlib, lzma, lz4, zstd)
+  G4int fCompLevel; //compression level (-1: ROOT default)
+  G4int fBasketSize; //basket size [bytes]
+  G4int fAutoFlush; //AutoFlush interval (>0: events, <0: bytes, 0: ROOT default)
+  G4int fAutoSave; //AutoSave interval (>0: events, <0: bytes, 0: ROOT default)
+  G4int fAsyncDepth; //queue depth of the output writer thread (0: fill in the event loop)
+  TStopwatch* fOutTimer; //time spent filling and writing the output tree
+  Double_t fWriterTime; //time spent filling the output tree in the writer thread
+  Double_t fTrackTime; //time in the event loop of this thread not spent on output [s]
+  static Double_t fgThreadOutTime; //output time of all worker threads
+  static Double_t fgThreadTrackTime; //tracking time summed over the worker threads
+  static Double_t fgThreadTrackTimeMax; //tracking time of the slowest worker thread
+  static std::map<G4String,Long64_t> fgSuppressed; //hits below the readout thresholds of all threads
+
+  //multithreaded output
+  G4bool fIsMaster; //master of a multithreaded run, merges the thread output
+  static std::vector<TString> fgThreadFiles; //output files of the worker threads
+
+  void OpenOutputFile();
+  void SetCompression(TFile* f);
+  void MergeThreadOutput();
   static void FormatTimeSec(double seconds, TString& out);
+  void WriteBenchmark(Double_t runTime, Double_t trackTime, Double_t trackTimeSum, Double_t outTime,
+                      Double_t zipBytes, Double_t totBytes);
   void ReadDetectorSetup(const char* detSetup);
 };
 
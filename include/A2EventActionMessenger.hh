@@ -30,6 +30,17 @@ class A2EventActionMessenger: public G4UImessenger
    G4UIcmdWithAString*   fHitDrawCmd;
     G4UIcmdWithAnInteger* fPrintCmd;    
     G4UIcmdWithABool* fStorePrimCmd;
+    G4UIcmdWithAString* fCompAlgoCmd;
+    G4UIcmdWithAnInteger* fCompLevelCmd;
+    G4UIcmdWithAnInteger* fBasketSizeCmd;
+    G4UIcmdWithAnInteger* fAutoFlushCmd;
+    G4UIcmdWithAnInteger* fAutoSaveCmd;
+    G4UIcmdWithAnInteger* fAsyncCmd;
+    G4UIcmdWithAString* fBenchFileCmd;
+    G4UIcmdWithABool* fProfileCmd;
+    G4UIcmdWithABool* fEventStatsCmd;
+    G4UIcmdWithAnInteger* fSlowestCmd;
+    G4UIcmdWithAString* fRestoreRndmCmd;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
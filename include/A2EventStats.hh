@@ -0,0 +1,97 @@
+// Per-event statistics of the tracking: wall time, steps, tracks and memory
+// high-water mark, slowest events with their random number state
+
+#ifndef A2EventStats_h
+#define A2EventStats_h 1
+
+#include <vector>
+#include <chrono>
+
+#include "globals.hh"
+#include "TString.h"
+
+class G4Track;
+class G4Event;
+
+class A2EventStats
+{
+
+public:
+    // recorded quantity
+    enum EA2EventQuantity {
+        kWallTime,                          // tracking wall time [s]
+        kSteps,                             // number of steps
+        kTracks,                            // number of tracks
+        kRSS,                               // resident set size high-water mark [MB]
+        kNQuantities
+    };
+
+private:
+    // one of the slowest events
+    struct A2SlowEvent_t {
+        G4double fTime;                     // tracking wall time [s]
+        G4int fEvent;                       // Geant4 event number
+        G4int fInputEvent;                  // input-file event (-1: internal generator)
+        G4long fSteps;                      // number of steps
+        G4long fTracks;                     // number of tracks
+        G4String fRandomState;              // random number state before the event generation
+        bool operator<(const A2SlowEvent_t& e) const { return fTime > e.fTime; }
+    };
+
+    // counters of one quantity
+    struct A2EventHist_t {
+        std::vector<G4double> fCounts;      // log10 bins (with under-/overflow)
+        G4double fSum;                      // sum of the values
+        G4double fMax;                      // maximum value
+        G4int fMaxEvent;                    // event of the maximum value
+        A2EventHist_t();
+        void Fill(G4int q, G4double val, G4int event);
+        void Add(const A2EventHist_t& h);
+    };
+
+    A2EventHist_t fHists[kNQuantities];     // histograms of this thread
+    std::vector<A2SlowEvent_t> fSlowest;    // heap of the slowest events of this thread
+    G4int fNEvents;                         // number of events
+    std::chrono::steady_clock::time_point fStart;  // start of the current event
+    G4long fNSteps;                         // steps of the current event
+    G4long fNTracks;                        // tracks of the current event
+    G4bool fStoreState;                     // random number states are stored in the events
+    G4int fInputEvent;                      // input-file event of the current event (-1: none)
+    G4double fValues[kNQuantities];         // values of the last event
+
+    static G4int fgNSlowest;                // number of slowest events to keep
+    static A2EventHist_t fgHists[kNQuantities];  // histograms of all threads
+    static std::vector<A2SlowEvent_t> fgSlowest; // slowest events of all threads
+    static G4int fgNEvents;                 // number of events of all threads
+    static G4ThreadLocal A2EventStats* fgInstance;  // statistics of this thread
+
+    A2EventStats();
+    static G4double GetPeakRSS();
+
+public:
+    virtual ~A2EventStats() { }
+
+    static A2EventStats* Instance()
+    {
+        if (!fgInstance) fgInstance = new A2EventStats();
+        return fgInstance;
+    }
+
+    void BeginOfRun();
+    void BeginEvent() { fStart = std::chrono::steady_clock::now(); fNSteps = 0; fNTracks = 0; }
+    void SetInputEvent(G4int i) { fInputEvent = i; }
+    void EndTrack(const G4Track* track);
+    void EndEvent(const G4Event* evt);
+    void Merge();
+    G4double GetValue(EA2EventQuantity q) const { return fValues[q]; }
+
+    static void SetNSlowest(G4int n) { fgNSlowest = n; }
+    static G4int GetNSlowest() { return fgNSlowest; }
+    static void ResetTotals();
+    static void PrintSlowest(G4int run);
+    static TString GetSummary();
+    static void WriteHistograms();
+    static G4bool RestoreRandomState(const G4String& fileName);
+};
+
+#endif
@@ -16,13 +16,14 @@ class A2FileGenerator
 public:
     struct A2GenParticle_t {
         G4ParticleDefinition* fDef; // particle definition (mass not used)
+        G4int fPDG;                 // PDG code (for deferred look-ups)
         G4ThreeVector fP;           // momentum [MeV]
         G4double fE;                // total energy [MeV]
         G4double fM;                // mass [MeV]
         G4ThreeVector fX;           // vertex [mm]
         G4double fT;                // vertex time [ns]
         G4bool fIsTrack;            // tracking flag
-        A2GenParticle_t() : fDef(0), fP(0, 0, 0), fE(0),
+        A2GenParticle_t() : fDef(0), fPDG(0), fP(0, 0, 0), fE(0),
                             fM(0), fX(0, 0, 0), fT(0), fIsTrack(false) { }
         void SetCorrectMass(G4bool usePDG = false);
         void Print(const char* pre = "") const;
@@ -39,11 +40,17 @@ public:
 protected:
     EFileGenType fType;                     // type of file generator
     G4String fFileName;                     // input file name
-    G4int fNEvents;                         // number of events
+    G4int fNEntries;                        // number of events in the file
+    G4int fFirstEvent;                      // first file event of the event range
+    G4int fNEvents;                         // number of events (in the event range)
     G4double fWeight;                       // event weight
     A2GenParticle_t fBeam;                  // beam particle
     G4ThreeVector fVertex;                  // primary vertex [mm]
     std::vector<A2GenParticle_t> fPart;     // list of particles
+    G4bool fDeferLookup;                    // defer look-ups of particles missing in the particle cache
+
+    G4int GetEntry(G4int event) const { return fFirstEvent + event; }
+    G4ParticleDefinition* FindParticle(G4int pdg) const;
 
 public:
     A2FileGenerator(const char* filename, EFileGenType type);
@@ -52,9 +59,15 @@ public:
     virtual G4bool Init() = 0;
     virtual G4bool ReadEvent(G4int event) = 0;
     virtual G4int GetMaxParticles() = 0;
+    virtual void ResolveParticles(std::vector<A2GenParticle_t>& part) const;
+    virtual void PrintStatistics() { }
+
+    static A2FileGenerator* Open(const char* filename, G4int shard = 0, G4int nShards = 1);
 
     EFileGenType GetType() const { return fType; }
     const G4String& GetFileName() const { return fFileName; }
+    G4int GetNEntries() const { return fNEntries; }
+    G4int GetFirstEvent() const { return fFirstEvent; }
     G4int GetNEvents() const { return fNEvents; }
     G4double GetWeight() const { return fWeight; }
     const G4ThreeVector& GetVertex() const { return fVertex; }
@@ -73,6 +86,9 @@ public:
 
     void SetParticleIsTrack(G4int p, G4bool t = true);
     void SetWeight(G4double w) { fWeight = w; }
+    G4bool SetEventRange(G4int first, G4int n);
+    G4bool SetShard(G4int shard, G4int nShards);
+    void SetDeferredLookup();
 
     void GenerateVertexCylinder(G4double t_length, G4double t_center,
                                 G4double b_diam);
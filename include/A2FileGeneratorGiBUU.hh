@@ -4,6 +4,8 @@
 #ifndef A2FileGeneratorGiBUU_h
 #define A2FileGeneratorGiBUU_h 1
 
+#include <set>
+
 #include "A2FileGeneratorTree.hh"
 
 class TTreeReader;
@@ -21,6 +23,7 @@ protected:
     std::vector<G4double>* fReaderX;    // particle position
     std::vector<G4double>* fReaderY;    // particle position
     std::vector<G4double>* fReaderZ;    // particle position
+    std::set<G4int> fNoCut;             // particles reported without off-shell cuts
 
     static const G4int fgMaxParticles;
 
@@ -31,6 +34,7 @@ public:
     virtual G4bool Init();
     virtual G4bool ReadEvent(G4int event);
     virtual G4int GetMaxParticles();
+    virtual void ResolveParticles(std::vector<A2GenParticle_t>& part) const;
 };
 
 #endif
@@ -22,7 +22,7 @@ protected:
     TTreeReader* fReader;                       // tree reader
     TTreeReaderArray<PParticle>* fReaderPart;   // particles
 
-    G4ParticleDefinition* PlutoToG4(Int_t id);
+    G4ParticleDefinition* PlutoToG4(Int_t id) const;
 
     static const G4int fgMaxParticles;
     static const G4int fgPlutoG4Conversion[70];
@@ -0,0 +1,66 @@
+// event generator prefetching the events of another file generator
+// in a background thread
+
+#ifndef A2FileGeneratorPrefetch_h
+#define A2FileGeneratorPrefetch_h 1
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "A2FileGenerator.hh"
+
+class A2FileGeneratorPrefetch : public A2FileGenerator
+{
+
+protected:
+    struct A2PrefetchEvent_t {
+        G4int fEvent;                       // event number (in the event range)
+        G4bool fIsRead;                     // read status
+        G4double fWeight;                   // event weight
+        A2GenParticle_t fBeam;              // beam particle
+        G4ThreeVector fVertex;              // primary vertex [mm]
+        std::vector<A2GenParticle_t> fPart; // list of particles
+        A2PrefetchEvent_t() : fEvent(-1), fIsRead(false), fWeight(1) { }
+    };
+
+    A2FileGenerator* fGen;                  // generator decoding the events (owned)
+    G4int fDepth;                           // queue depth
+    G4int fMaxParticles;                    // maximum number of particles
+    G4bool fShiftVertex;                    // add the generated vertex to the particle vertices
+
+    std::vector<A2PrefetchEvent_t> fRing;   // ring buffer of decoded events
+    A2PrefetchEvent_t fDecoded;             // event being decoded
+    G4int fHead;                            // ring buffer index of the next event
+    G4int fCount;                           // number of events in the ring buffer
+    G4int fNextRead;                        // next event to be decoded
+    G4int fInFlight;                        // event being decoded (-1 if none)
+    G4int fGeneration;                      // incremented for every seek
+
+    std::thread fThread;                    // reader thread
+    std::mutex fMutex;                      // ring buffer mutex
+    std::condition_variable fCondReader;    // signals free space in the ring buffer
+    std::condition_variable fCondConsumer;  // signals decoded events in the ring buffer
+    G4bool fStop;                           // stop flag for the reader thread
+
+    G4int fNRead;                           // number of events read
+    G4int fNStalls;                         // number of reads waiting for the reader thread
+    G4int fNSeeks;                          // number of non-sequential reads
+    G4double fStallTime;                    // time spent waiting for the reader thread [s]
+
+    void Run();
+
+public:
+    A2FileGeneratorPrefetch(A2FileGenerator* gen, G4int depth);
+    virtual ~A2FileGeneratorPrefetch();
+
+    virtual G4bool Init();
+    virtual G4bool ReadEvent(G4int event);
+    virtual G4int GetMaxParticles() { return fMaxParticles; }
+    virtual void PrintStatistics();
+
+    G4int GetDepth() const { return fDepth; }
+};
+
+#endif
+
@@ -2,15 +2,19 @@
 #ifndef A2Hit_h
 #define A2Hit_h 1
 
-#include <deque>
-
 #include "G4VHit.hh"
-#include "G4THitsCollection.hh"
-#include "G4Allocator.hh"
 #include "G4ThreeVector.hh"
 #include "G4LogicalVolume.hh"
 
+#include "A2HitArena.hh"
+
 
+// energy deposited in a hit by one primary particle
+struct A2PartEnergy_t
+{
+  G4int fIndex;       // particle index (starting at 1)
+  G4double fEnergy;   // deposited energy
+};
 
 class A2Hit : public G4VHit
 {
@@ -19,8 +23,9 @@ public:
   A2Hit();
   ~A2Hit();
   A2Hit(const A2Hit&);
-  const A2Hit& operator=(const
-						A2Hit&);
+  A2Hit(A2Hit&&);
+  A2Hit& operator=(const A2Hit&);
+  A2Hit& operator=(A2Hit&&);
   //int operator==(const A2Hit&) const;
 
   inline void* operator new(size_t);
@@ -32,44 +37,56 @@ public:
 protected:
 
   G4double fEdep;  // Energy deposited in detector
+  G4double fWEdep; // Deposited energy weighted with the statistical weights of the tracks
   G4ThreeVector fPos; // Position of the hit (in what frame?)
   G4int fID; // ID of detector hit
   G4double fTime; // global time of hit
-  std::deque<G4double> fPartE; // energies deposited by primary particles
+
+  // energies deposited by primary particles: the first fgNPartInline contributors are
+  // stored in the hit itself, more go to a heap array
+  static const G4int fgNPartInline = 4;
+  A2PartEnergy_t fPartInline[fgNPartInline];
+  A2PartEnergy_t* fPart;  // particle energies (fPartInline or heap array)
+  G4int fNPart;           // number of contributing particles
+  G4int fPartCapacity;    // capacity of fPart
+  G4int fPartMax;         // position of the highest energy deposition in fPart (-1 if none)
+
+  void CopyParticles(const A2Hit&);
+  void MoveParticles(A2Hit&);
+  void ReleaseParticles();
+  void UpdatePartMax();
 
 public:
 
-  void AddEnergy(G4double de) {fEdep += de;};
+  void AddEnergy(G4double de, G4double weight = 1) {fEdep += de; fWEdep += weight*de;};
   void SetPos(G4ThreeVector pos) {fPos=pos;};
   void SetID(G4int i) {fID = i;};
   void SetTime(G4double t) {fTime = t;};
   void AddPartEnergy(G4int p, G4double energy);
 
   G4double GetEdep() { return fEdep; };
+  G4double GetWEdep() { return fWEdep; };
   G4ThreeVector GetPos() { return fPos; };
   G4int GetID() { return fID; };
   G4double GetTime() { return fTime; };
   G4int GetNParticles();
-  G4int GetParticle();
+  G4int GetParticle() { return fPartMax >= 0 && fPart[fPartMax].fEnergy > 0 ? fPart[fPartMax].fIndex : 0; }
 };
 
 
-typedef G4THitsCollection<A2Hit> A2HitsCollection;
-
-extern G4Allocator<A2Hit> A2HitAllocator;
+typedef A2ArenaHitsCollection<A2Hit> A2HitsCollection;
 
 
-inline void* A2Hit::operator new(size_t)
+// hits live in the event-scoped arena of the thread
+inline void* A2Hit::operator new(size_t size)
 {
-  void* aHit;
-  aHit = (void*) A2HitAllocator.MallocSingle();
-  return aHit;
+  return A2HitArena::Instance()->AllocateObject(size);
 }
 
 
 inline void A2Hit::operator delete(void* aHit)
 {
-  A2HitAllocator.FreeSingle((A2Hit*) aHit);
+  A2HitArena::Instance()->Release(aHit);
 }
 
 #endif
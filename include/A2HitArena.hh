@@ -0,0 +1,150 @@
+// Event-scoped arena for the hits and hit collections of the sensitive detectors
+
+#ifndef A2HitArena_h
+#define A2HitArena_h 1
+
+#include <vector>
+
+#include "G4VHitsCollection.hh"
+#include "globals.hh"
+
+class A2HitArena
+{
+
+private:
+    struct A2ArenaBlock_t {
+        char* fData;                        // memory of the block
+        size_t fSize;                       // size of the block [bytes]
+    };
+
+    // memory of one event: its blocks are reused when the event has ended
+    // and all its hits and collections were released
+    struct A2ArenaSegment_t {
+        std::vector<A2ArenaBlock_t> fBlocks;    // blocks of the event
+        G4int fNLive;                           // number of objects not yet deleted
+        G4bool fClosed;                         // the event has ended
+    };
+
+    static const size_t kBlockSize = 256*1024;  // default block size [bytes]
+    static const size_t kAlign = 16;            // alignment of the allocations [bytes]
+
+    A2ArenaSegment_t* fSegment;             // segment of the current event
+    std::vector<A2ArenaBlock_t> fFree;      // blocks of released segments
+    size_t fOffset;                         // first free byte in the last block of fSegment
+    G4int fNBlocks;                         // number of allocated blocks
+    G4int fNKept;                           // number of ended events with live objects
+
+    G4long fNEvents;                        // number of events
+    G4long fNRecycled;                      // number of segments whose blocks were reused
+    G4long fNObjects;                       // number of objects allocated
+    G4long fNHeapAllocs;                    // number of heap allocations (blocks)
+    G4long fNEventHeapAllocs;               // number of events with heap allocations
+    G4long fNHeapAllocsAtEvent;             // heap allocations before the current event
+    size_t fMaxUsed;                        // maximum memory used in one event [bytes]
+
+    static G4ThreadLocal A2HitArena* fgInstance;  // arena of this thread
+
+    A2HitArena();
+    void* AllocateBlock(size_t size);
+    void Recycle(A2ArenaSegment_t* seg);
+
+public:
+    virtual ~A2HitArena();
+
+    static A2HitArena* Instance()
+    {
+        if (!fgInstance) fgInstance = new A2HitArena();
+        return fgInstance;
+    }
+
+    // raw memory of the current event, valid until its objects are released
+    void* Allocate(size_t size)
+    {
+        size = (size + kAlign - 1) & ~(kAlign - 1);
+        if (!fSegment->fBlocks.empty() && fOffset + size <= fSegment->fBlocks.back().fSize)
+        {
+            void* p = fSegment->fBlocks.back().fData + fOffset;
+            fOffset += size;
+            return p;
+        }
+        return AllocateBlock(size);
+    }
+
+    // memory of an object deleted with Release(); the memory of an event is
+    // reused when its last object is released, i.e. when the G4Event is
+    // deleted (events kept e.g. for the visualization only hold their own
+    // segment); the segment is stored in front of the object
+    void* AllocateObject(size_t size)
+    {
+        char* p = static_cast<char*>(Allocate(size + kAlign));
+        *reinterpret_cast<A2ArenaSegment_t**>(p) = fSegment;
+        fSegment->fNLive++;
+        fNObjects++;
+        return p + kAlign;
+    }
+    void Release(void* p)
+    {
+        A2ArenaSegment_t* seg = *reinterpret_cast<A2ArenaSegment_t**>(static_cast<char*>(p) - kAlign);
+        if (--seg->fNLive == 0 && seg->fClosed)
+        {
+            fNKept--;
+            Recycle(seg);
+        }
+    }
+
+    void EndOfEvent();
+    void PrintStatistics();
+
+    G4long GetNHeapAllocations() const { return fNHeapAllocs; }
+    G4long GetNObjects() const { return fNObjects; }
+    G4int GetNKept() const { return fNKept; }
+};
+
+// Hits collection storing the hits of type T (allocated in the arena) in an
+// array in the arena
+template <class T>
+class A2ArenaHitsCollection : public G4VHitsCollection
+{
+
+private:
+    T** fHits;                              // hits
+    size_t fN;                              // number of hits
+    size_t fCapacity;                       // capacity of fHits
+
+public:
+    A2ArenaHitsCollection(G4String detName, G4String colName)
+        : G4VHitsCollection(detName, colName), fHits(0), fN(0), fCapacity(0) { }
+    virtual ~A2ArenaHitsCollection()
+    {
+        for (size_t i = 0; i < fN; i++)
+            delete fHits[i];
+    }
+
+    void* operator new(size_t size) { return A2HitArena::Instance()->AllocateObject(size); }
+    void operator delete(void* p) { A2HitArena::Instance()->Release(p); }
+
+    size_t insert(T* hit)
+    {
+        if (fN == fCapacity)
+        {
+            size_t cap = fCapacity ? 2*fCapacity : 64;
+            T** hits = static_cast<T**>(A2HitArena::Instance()->Allocate(cap*sizeof(T*)));
+            for (size_t i = 0; i < fN; i++)
+                hits[i] = fHits[i];
+            fHits = hits;
+            fCapacity = cap;
+        }
+        fHits[fN++] = hit;
+        return fN;
+    }
+
+    T* operator[](size_t i) const { return fHits[i]; }
+    size_t entries() const { return fN; }
+
+    virtual void DrawAllHits() { for (size_t i = 0; i < fN; i++) fHits[i]->Draw(); }
+    virtual void PrintAllHits() { for (size_t i = 0; i < fN; i++) fHits[i]->Print(); }
+    virtual G4VHit* GetHit(size_t i) const { return fHits[i]; }
+    virtual size_t GetSize() const { return fN; }
+};
+
+#endif
@@ -1,44 +1,143 @@
 #ifndef A2MagneticField_h
 #define A2MagneticField_h 1
 
+#include <stdint.h>
+#include <vector>
+
 #include "G4MagneticField.hh"
 #include "G4ThreeVector.hh"
 
 
 class G4FieldManager;
 
+// Header of the binary field map files. The field values (Bx,By,Bz of all grid points,
+// z fastest, Geant4 internal units) follow at A2MagneticField::fgBinaryDataOffset.
+struct A2FieldMapHeader_t
+{
+  char fMagic[8];          // "A2FMAP"
+  uint32_t fVersion;       // format version
+  uint32_t fValueSize;     // size of one field value [bytes]
+  int32_t fPointsN[3];     // number of grid points in x,y,z
+  int32_t fReserved;
+  double fPointMin[3];     // lower bounds of the map [mm]
+  double fPointMax[3];     // upper bounds of the map [mm]
+  double fPointStep[3];    // grid steps [mm]
+  uint64_t fNValues;       // number of field values
+  uint64_t fChecksum;      // FNV-1a checksum of the field values
+  int64_t fSourceSize;     // size of the converted text map [bytes]
+  int64_t fSourceTime;     // modification time of the converted text map
+};
+
+// Representation of the field map in memory
+enum EA2FieldStorage {
+  kFieldFull,              // 3D map of doubles
+  kFieldFloat,             // 3D map of floats
+  kFieldAxial              // axially symmetric (r,z) map of Br,Bz
+};
+
 class A2MagneticField:public G4MagneticField
 {
   public:
-    
+
     A2MagneticField(G4ThreeVector);
-    A2MagneticField();      
-    ~A2MagneticField(); 
-    
+    A2MagneticField();
+    ~A2MagneticField();
+
     virtual void GetFieldValue(const G4double Point[4], G4double*) const;
-    
-    // Read field map from a .dat file and fill fFieldMap array
+
+    // Read the field map: binary maps are memory-mapped, text maps (.dat, .dat.xz) are
+    // taken from their binary cache file, which is created if missing or outdated
     virtual G4bool ReadFieldMap(const G4String&);
-    
+
+    // Read a text field map from a .dat(.xz) file and fill the field map array
+    G4bool ReadTextMap(const G4String&);
+
+    // Memory-map a binary field map read-only (pages are shared by all jobs on a node);
+    // for srcSize/srcTime >= 0 the map has to be converted from a text map of this size/time
+    G4bool MapBinaryMap(const G4String&, G4long srcSize = -1, G4long srcTime = -1);
+
+    // Write the field map in the binary format
+    G4bool WriteBinaryMap(const G4String&) const;
+
+    // Name of the binary cache file of a text map
+    static G4String GetCacheName(const G4String& name) { return name + ".a2fmap"; }
+
+    // Convert the loaded 3D map into the representation "full", "float", "axial" or "auto"
+    // (axial if the map is axially symmetric, otherwise full) and report memory and deviation
+    G4bool SetStorage(const G4String&);
+    EA2FieldStorage GetStorage() const { return fStorage; }
+
+    // Use the value of the nearest grid point (default) or interpolate trilinearly
+    void SetTrilinear(G4bool trilinear) { fTrilinear = trilinear; }
+    G4bool IsTrilinear() const { return fTrilinear; }
+
+    // Measure the number of GetFieldValue() calls per second at random points of the map
+    void Benchmark(G4int nCalls);
+
   protected:
-    
+
     // min, max bounds for the magnetic field area
     G4double fPointMin[3];
     G4double fPointMax[3];
-    
-    // steps of coordinate-measuring and number of points
+
+    // steps of coordinate-measuring, inverse steps and number of points
     G4double fPointStep[3];
+    G4double fInvStep[3];
     G4int fPointsN[3];
-    
-    // Data type for the magnetic induction vector
-    typedef G4double A2Bvector[3];
-    
-    // Magnetic fieled map array
-    A2Bvector*** fFieldMap;
-    
+
+    // Magnetic field map: Bx,By,Bz of all grid points (z fastest) in one cache-line aligned array,
+    // fStride gives the array offset between neighbouring grid points along x,y,z
+    const G4double* fField;
+    G4int fStride[3];
+
+    // Alternative representations: 3D map of floats, (r,z) map of Br,Bz (z fastest) with
+    // fAxialN r grid points at multiples of fAxialStep and the z grid points of the 3D map
+    EA2FieldStorage fStorage;
+    std::vector<float> fFieldFloat;
+    std::vector<G4double> fFieldAxial;
+    G4int fAxialN;
+    G4double fAxialStep;
+    G4double fAxialInvStep;
+
+    // Memory-mapped binary map file (fField points into it)
+    void* fMapping;
+    size_t fMappingSize;
+
+    // Size and modification time of the text map
+    G4long fSourceSize;
+    G4long fSourceTime;
+
+    // Magic string, version and data offset of the binary format
+    static const char fgBinaryMagic[8];
+    static const uint32_t fgBinaryVersion;
+    static const size_t fgBinaryDataOffset;
+
+    // Maximum deviation of the axial map relative to the maximum field for the automatic selection
+    static const G4double fgAxialTolerance;
+
+    // Trilinear interpolation flag
+    G4bool fTrilinear;
+
     // Get index of the point "q" in an arithmetic progression with the first element "q0" and step "d"
     G4int GetPointIndex(const G4double& q, const G4double& q0, const G4double& d) const {return (q-q0)/d;}
-    
+
+    // Allocate the field map array for fPointsN grid points
+    G4double* AllocateFieldMap();
+
+    // Free or unmap the field map
+    void ReleaseFieldMap();
+
+    // Free the float and axial maps and use the 3D map
+    void ClearStorage();
+
+    // Field of the 3D map 'data' or of the axial map at a point inside the map
+    template <typename T>
+    void Interpolate3D(const T* data, const G4double* point, G4bool trilinear, G4double* field) const;
+    void InterpolateAxial(const G4double* point, G4bool trilinear, G4double* field) const;
+
+    // FNV-1a checksum of the field values
+    static uint64_t Checksum(const G4double* values, uint64_t n);
+
     // Find the global Field Manager
 //     G4FieldManager* GetGlobalFieldManager();
 };
@@ -0,0 +1,41 @@
+// Shared cache of Geant4 particle definitions indexed by PDG code
+
+#ifndef A2ParticleCache_h
+#define A2ParticleCache_h 1
+
+#include <vector>
+#include <map>
+#include <unordered_map>
+
+#include "G4Threading.hh"
+#include "globals.hh"
+
+class G4ParticleDefinition;
+
+class A2ParticleCache
+{
+
+private:
+    static const G4int kDenseMax = 10000;   // PDG codes -kDenseMax < pdg < kDenseMax are stored densely
+
+    std::vector<G4ParticleDefinition*> fDense;                  // particles with small PDG codes
+    std::unordered_map<G4int, G4ParticleDefinition*> fIons;     // ions and other large PDG codes of the particle table
+    std::map<G4int, G4long> fUnknown;                           // occurrences of unknown PDG codes
+    G4Mutex fMutex;                                             // protects fUnknown
+
+    static A2ParticleCache* fgInstance;                         // shared instance
+    static G4ThreadLocal std::unordered_map<G4int, G4ParticleDefinition*>* fgThreadIons;  // ions created by this thread
+
+    A2ParticleCache();
+
+public:
+    virtual ~A2ParticleCache() { }
+
+    static A2ParticleCache* Instance();
+    static void PrintUnknown();
+
+    G4ParticleDefinition* Find(G4int pdg, G4bool create = true);
+};
+
+#endif
+
@@ -50,7 +50,10 @@
 
 class A2PhysicsList;
 class G4UIcmdWithADoubleAndUnit;
+class G4UIcmdWithADouble;
 class G4UIcmdWithAString;
+class G4UIcmdWithABool;
+class G4UIcmdWithAnInteger;
 class G4UIcmdWithoutParameter;
 class G4UIdirectory;
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -77,6 +80,22 @@ private:
   G4UIcmdWithoutParameter*   fListCmd;  
   G4UIcmdWithADoubleAndUnit* fRegCutCmd;
   G4UIcmdWithAString*        fRegCmd;
+  G4UIcmdWithABool*          fFastCBCmd;
+  G4UIcmdWithADoubleAndUnit* fFastCBMinECmd;
+  G4UIcmdWithADoubleAndUnit* fFastCBSpotECmd;
+  G4UIcmdWithAString*        fTAPSLibCmd;
+  G4UIcmdWithAString*        fTAPSLibRecCmd;
+  G4UIcmdWithAnInteger*      fTAPSLibMaxCmd;
+  G4UIcmdWithADoubleAndUnit* fRouletteECmd;
+  G4UIcmdWithADouble*        fRouletteSurvCmd;
+  G4UIcmdWithABool*          fRouletteSplitCmd;
+  G4UIcmdWithAString*        fKillBelowCmd;
+  G4UIcmdWithAString*        fKillAfterCmd;
+  G4UIcmdWithAString*        fKillParticleCmd;
+  G4UIcmdWithoutParameter*   fKillClearCmd;
+  G4UIcmdWithoutParameter*   fKillListCmd;
+  G4UIcmdWithABool*          fSteppingCmd;
+  G4UIcmdWithABool*          fStuckPhotonCmd;
   G4UIdirectory* fPhysDir;
 };
 
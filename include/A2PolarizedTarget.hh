@@ -2,9 +2,13 @@
 #ifndef A2PolarizedTarget_h
 #define A2PolarizedTarget_h 1
 
+#include <vector>
+
 #include "A2Target.hh"
 #include "A2MagneticField.hh"
 
+class G4MagIntegratorStepper;
+
 class A2PolarizedTarget: public  A2Target
 {
 
@@ -14,8 +18,19 @@ public:
 
   virtual G4VPhysicalVolume* Construct(G4LogicalVolume *MotherLogic, G4double Z0 = 0);
   
-  // Set magnetic field according to the field map
-  virtual void SetMagneticField(G4String&);
+  // Set magnetic field according to the field map (nearest grid point or trilinear interpolation,
+  // storage full, float, axial or auto, see A2MagneticField::SetStorage())
+  virtual void SetMagneticField(G4String&, G4bool trilinear = false, const G4String& storage = "full");
+  A2MagneticField* GetMagneticField() { return fMagneticField; }
+
+  // Set the field integration: stepper name ("default": Geant4 default), minimum step,
+  // delta chord and delta one step (0: Geant4 defaults)
+  void SetFieldIntegration(const G4String& stepper, G4double minStep, G4double deltaChord, G4double deltaOneStep)
+  { fStepper = stepper; fMinStep = minStep; fDeltaChord = deltaChord; fDeltaOneStep = deltaOneStep; }
+
+  // Use the field as detector field of the global field manager of this thread or,
+  // if volumes are given, of a local field manager of these volumes and their daughters
+  void AttachMagneticField(const std::vector<G4LogicalVolume*>& volumes = std::vector<G4LogicalVolume*>());
   
   // Set magnetic coils type (solenoidal/saddle)
   virtual void SetMagneticCoils(G4String &type) { fTypeMagneticCoils = type; }
@@ -24,5 +39,13 @@ private:
   A2MagneticField* fMagneticField;
   G4String fTypeMagneticCoils;
 
+  // field integration
+  G4String fStepper;
+  G4double fMinStep;
+  G4double fDeltaChord;
+  G4double fDeltaOneStep;
+
+  G4MagIntegratorStepper* CreateStepper();
+
 };
 #endif
@@ -28,6 +28,10 @@ public:
 
   void SetUpFileInput();
   void SetInputFile(TString filename){fInFileName=filename;};
+  void SetShard(G4int shard){fShard=shard;}
+  void SetNShards(G4int n){fNShards=n;}
+  void SetPrefetchDepth(G4int n){fPrefetchDepth=n;}
+  void SetStartEvent(G4int n){fNevent=n;}
   void SetNParticlesToBeTracked(Int_t n){
     fNToBeTracked=n;
     fTrackThis=new Int_t[n];
@@ -60,6 +64,9 @@ private:
   A2PrimaryGeneratorMessenger* fGunMessenger; //messenger of this class
   A2DetectorConstruction* fDetCon;   //pointer to the detector volumes
   TString fInFileName;  //Name of input file
+  G4int fShard;         //Index of the processed event range of the input file
+  G4int fNShards;       //Number of event ranges the input file is split into
+  G4int fPrefetchDepth; //Number of input events decoded in advance (0=no prefetching)
   Int_t fNGenParticles;     //Number of particles in ntuple
   Int_t fNGenMaxParticles;     //Maximum number of particles in ntuple
   Float_t fGenPosition[3]; //vertex position from ntuple, can't be double!
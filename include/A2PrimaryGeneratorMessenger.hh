@@ -34,6 +34,10 @@ class A2PrimaryGeneratorMessenger: public G4UImessenger
   G4UIcmdWithAnInteger* SetTrackCmd;
   G4UIcmdWithAnInteger* SetModeCmd;
   G4UIcmdWithAnInteger* SetSeedCmd;
+  G4UIcmdWithAnInteger* SetShardCmd;
+  G4UIcmdWithAnInteger* SetNShardsCmd;
+  G4UIcmdWithAnInteger* SetPrefetchCmd;
+  G4UIcmdWithAnInteger* SetStartEventCmd;
   G4UIcmdWithADoubleAndUnit* SetTminCmd;
   G4UIcmdWithADoubleAndUnit* SetTmaxCmd;
   G4UIcmdWithADoubleAndUnit* SetThetaminCmd;
@@ -0,0 +1,89 @@
+// Profiler of the tracking: steps, tracks, wall and CPU time per region,
+// particle type and process
+
+#ifndef A2Profiler_h
+#define A2Profiler_h 1
+
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <chrono>
+
+#include "globals.hh"
+
+class G4Track;
+class G4Step;
+
+class A2Profiler
+{
+
+public:
+    // profiled quantity
+    enum EA2ProfileKey {
+        kRegion,                            // region of the pre-step point / track start
+        kParticle,                          // particle type
+        kProcess,                           // process limiting the step
+        kNKeys
+    };
+
+private:
+    // accumulated counters of one region, particle or process
+    struct A2ProfEntry_t {
+        G4long fSteps;                      // number of steps
+        G4long fTracks;                     // number of tracks
+        G4double fWall;                     // wall time [s]
+        G4double fCPU;                      // CPU time [s]
+        A2ProfEntry_t() : fSteps(0), fTracks(0), fWall(0), fCPU(0) { }
+    };
+
+    // entries of one key type, resolved by pointer
+    struct A2ProfTable_t {
+        std::vector<G4String> fNames;       // names of the entries
+        std::vector<A2ProfEntry_t> fEntries;  // counters of the entries
+        std::unordered_map<const void*, G4int> fIndex;  // entry of a pointer
+        const void* fLast;                  // pointer of the last look-up
+        G4int fLastIndex;                   // entry of fLast
+        A2ProfTable_t() : fLast(0), fLastIndex(-1) { }
+    };
+
+    A2ProfTable_t fTables[kNKeys];          // tables of this thread
+    std::chrono::steady_clock::time_point fLastTime;  // end of the last step
+    G4double fTrackCPU;                     // CPU time at the start of the current track [s]
+    G4int fTrackRegion;                     // region entry of the current track
+    G4int fTrackParticle;                   // particle entry of the current track
+
+    static G4bool fgEnabled;                // profiling switched on
+    static std::map<G4String, A2ProfEntry_t> fgTotals[kNKeys];  // totals of all threads
+    static G4ThreadLocal A2Profiler* fgInstance;  // profiler of this thread
+
+    A2Profiler();
+    G4int GetEntry(EA2ProfileKey key, const void* ptr)
+    {
+        A2ProfTable_t& t = fTables[key];
+        return (ptr == t.fLast && t.fLastIndex >= 0) ? t.fLastIndex : AddEntry(key, ptr);
+    }
+    G4int AddEntry(EA2ProfileKey key, const void* ptr);
+    static G4double GetThreadCPUTime();
+
+public:
+    virtual ~A2Profiler() { }
+
+    static A2Profiler* Instance()
+    {
+        if (!fgInstance) fgInstance = new A2Profiler();
+        return fgInstance;
+    }
+
+    void BeginTrack(const G4Track* track);
+    void Step(const G4Step* step);
+    void EndTrack(const G4Track* track);
+    void Merge();
+
+    static void SetEnabled(G4bool enabled) { fgEnabled = enabled; }
+    static G4bool IsEnabled() { return fgEnabled; }
+    static void ResetTotals();
+    static void PrintTable();
+    static void WriteHistogram();
+};
+
+#endif
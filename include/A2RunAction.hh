@@ -11,7 +11,7 @@ class G4Run;
 class A2RunAction : public G4UserRunAction
 {
   public:
-    A2RunAction();
+    A2RunAction(A2EventAction* masterEventAction = NULL);
    ~A2RunAction();
 
   public:
@@ -21,6 +21,7 @@ class A2RunAction : public G4UserRunAction
  
   private:
   A2EventAction *fEventAction;
+  A2EventAction *fMasterEventAction; //master of a multithreaded run, merges the thread output
 };
 
 #endif
@@ -2,11 +2,21 @@
 #ifndef A2SD_h
 #define A2SD_h 1
 
+#include <unordered_map>
+
 #include "G4VSensitiveDetector.hh"
 #include "globals.hh"
 
 class G4HCofThisEvent;
 class G4Step;
+class G4VPhysicalVolume;
+
+//properties of a physical volume resolved from its name on first use
+struct A2SDVolume_t
+{
+  G4bool fCOVR;          // TAPS COVR: id offset by its copy number, 2000 ns ADC gate
+  G4double fTimeThresh;  // min. energy deposit updating the hit time (<0: never)
+};
 
 #include "A2Hit.hh"
 
@@ -23,6 +33,7 @@ public:
   void clear();
   void DrawAll();
   void PrintAll();
+  G4VSensitiveDetector* Clone() const;
   
 private:
   
@@ -34,6 +45,17 @@ private:
   G4int * fHits;
   G4int fNhits;
 
+  //volume properties (per SD instance, i.e. per thread)
+  std::unordered_map<const G4VPhysicalVolume*,A2SDVolume_t> fVolumes;
+  const G4VPhysicalVolume* fLastPV[2];
+  const A2SDVolume_t* fLastProp[2];
+  const A2SDVolume_t* ResolveVolume(const G4VPhysicalVolume* pv);
+  const A2SDVolume_t* GetVolume(const G4VPhysicalVolume* pv, G4int slot)
+  {
+    if(pv!=fLastPV[slot]){ fLastPV[slot]=pv; fLastProp[slot]=ResolveVolume(pv); }
+    return fLastProp[slot];
+  }
+
 };
 
 #endif
@@ -0,0 +1,130 @@
+// library of frozen electromagnetic showers: recording in a dedicated run
+// mode, compact binary file format and memory-mapped read access
+
+#ifndef A2ShowerLibrary_h
+#define A2ShowerLibrary_h 1
+
+#include <stdint.h>
+#include <vector>
+#include <unordered_map>
+
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+class G4Step;
+class G4Region;
+class G4Material;
+class G4ParticleDefinition;
+
+// Header of the shower library files. The tables follow in this order:
+// bin table (number of bins + 1 indices of the first shower of each bin),
+// shower table (A2ShowerLibShower_t) and energy spots (A2ShowerLibSpot_t).
+struct A2ShowerLibHeader_t
+{
+    char fMagic[8];             // "A2SHLIB"
+    uint32_t fVersion;          // format version
+    uint32_t fNParticle;        // particle bins (gamma, e-, e+)
+    uint32_t fNEnergy;          // energy bins (logarithmic)
+    uint32_t fNAngle;           // entry angle bins (to the crystal axis)
+    uint32_t fNCrystal;         // crystal types (BaF2, PbWO4)
+    uint32_t fReserved;
+    double fEMin;               // lower energy limit [MeV]
+    double fEMax;               // upper energy limit [MeV]
+    double fAngleMax;           // upper entry angle limit [rad]
+    uint64_t fNShowers;         // number of showers
+    uint64_t fNSpots;           // number of energy spots
+};
+
+// frozen shower
+struct A2ShowerLibShower_t
+{
+    float fEnergy;              // energy of the recorded particle [MeV]
+    uint32_t fNSpots;           // number of energy spots
+    uint64_t fFirstSpot;        // index of the first energy spot
+};
+
+// energy spot relative to the entry point of the particle: position along
+// the particle direction and in the transverse plane, energy fraction and delay
+struct A2ShowerLibSpot_t
+{
+    float fL;                   // longitudinal position [mm]
+    float fU;                   // transverse position [mm]
+    float fV;                   // transverse position [mm]
+    float fE;                   // deposited energy / particle energy
+    float fT;                   // delay [ns]
+};
+
+class A2ShowerLibrary
+{
+
+private:
+    // recorded shower
+    struct A2RecShower_t {
+        G4float fEnergy;
+        std::vector<A2ShowerLibSpot_t> fSpots;
+    };
+
+    // shower being recorded in the current event of a thread
+    struct A2RecState_t {
+        G4bool fActive;                     // shower started
+        G4int fBin;                         // library bin
+        G4double fEnergy;                   // particle energy
+        G4double fTime;                     // entry time
+        G4ThreeVector fPos;                 // entry point
+        G4ThreeVector fDir, fU, fV;         // shower frame
+        std::unordered_map<G4long, A2ShowerLibSpot_t> fCells;  // energy in cells of the shower frame
+        const G4Region* fRegion;            // TAPS region
+        A2RecState_t() : fActive(false), fBin(-1), fEnergy(0), fTime(0), fRegion(0) { }
+    };
+
+    // mapped library
+    void* fMapping;                         // memory-mapped file
+    size_t fMappingSize;                    // size of the mapping
+    const A2ShowerLibHeader_t* fHeader;     // file header
+    const uint64_t* fBins;                  // bin table
+    const A2ShowerLibShower_t* fShowers;    // shower table
+    const A2ShowerLibSpot_t* fSpots;        // energy spots
+
+    static const char fgMagic[8];           // magic string of the file format
+    static const uint32_t fgVersion;        // file format version
+
+    // recording
+    static G4bool fgRecording;              // record showers in this run
+    static G4String fgRecordFile;           // output file of the recording
+    static G4int fgMaxShowers;              // maximum number of showers per bin
+    static G4double fgCellSize;             // cell size of the recorded energy spots
+    static A2ShowerLibHeader_t fgRecBinning;     // binning of the recorded library
+    static std::vector<std::vector<A2RecShower_t> > fgRecorded;  // recorded showers per bin
+    static G4ThreadLocal A2RecState_t* fgRecState;              // shower of the current event
+
+public:
+    A2ShowerLibrary();
+    virtual ~A2ShowerLibrary();
+
+    // Memory-map the library file read-only
+    G4bool Map(const G4String& name);
+    G4bool IsMapped() const { return fHeader != 0; }
+
+    // Library bin of a particle entering a crystal (-1 if outside of the library)
+    static G4int GetBin(const A2ShowerLibHeader_t* h, const G4ParticleDefinition* part, G4double energy,
+                        G4double angle, const G4Material* mat);
+    G4int GetBin(const G4ParticleDefinition* part, G4double energy, G4double angle, const G4Material* mat) const
+    { return GetBin(fHeader, part, energy, angle, mat); }
+
+    // Number of showers in a bin and random shower of a bin
+    G4int GetNShowers(G4int bin) const { return bin < 0 ? 0 : fBins[bin+1] - fBins[bin]; }
+    const A2ShowerLibShower_t* SampleShower(G4int bin) const;
+    const A2ShowerLibSpot_t* GetSpots(const A2ShowerLibShower_t* s) const { return fSpots + s->fFirstSpot; }
+
+    void Print() const;
+
+    // Recording of the showers of single e+-/gamma entering the TAPS crystals
+    static void SetRecording(const G4String& file);
+    static void SetMaxShowers(G4int n) { fgMaxShowers = n; }
+    static G4bool IsRecording() { return fgRecording; }
+    static void RecordStep(const G4Step* step);
+    static void EndOfEvent();
+    static G4bool WriteRecorded();
+};
+
+#endif
@@ -0,0 +1,67 @@
+// base class of the fast electromagnetic shower models depositing energy
+// spots in the crystals of a calorimeter region
+
+#ifndef A2ShowerModel_h
+#define A2ShowerModel_h 1
+
+#include <map>
+#include <vector>
+
+#include "G4VFastSimulationModel.hh"
+#include "G4TouchableHandle.hh"
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+class G4Region;
+class G4Navigator;
+class G4Step;
+class G4StepPoint;
+class G4VPhysicalVolume;
+class G4VSensitiveDetector;
+
+class A2ShowerModel : public G4VFastSimulationModel
+{
+
+protected:
+    // energy of the spots of the current shower in one crystal
+    struct A2ShowerDeposit_t {
+        G4TouchableHandle fTouchable;       // touchable of the crystal
+        G4VSensitiveDetector* fSD;          // sensitive detector of the crystal
+        G4ThreeVector fPos;                 // position of the earliest spot
+        G4double fTime;                     // time of the earliest spot
+        G4double fEdep;                     // summed energy of the spots
+    };
+    typedef std::pair<const G4VPhysicalVolume*, const G4VPhysicalVolume*> A2CrystalKey_t;
+
+    G4Region* fRegion;                      // calorimeter region (envelope of the model)
+    G4Navigator* fNavigator;                // navigator locating the energy spots
+    G4bool fNavigatorReady;                 // navigator initialised
+    G4TouchableHandle fTouchable;           // touchable of the current energy spot
+    G4Step* fFakeStep;                      // step passed to the sensitive detectors
+    G4StepPoint* fFakePreStepPoint;         // pre-step point of fFakeStep
+    std::vector<A2ShowerDeposit_t> fDeposits;           // crystals of the current shower
+    std::map<A2CrystalKey_t, size_t> fDepositIndex;     // crystal (volume, mother) -> fDeposits
+
+    G4long fNShowers;                       // number of showers
+    G4long fNSpots;                         // number of energy spots
+    G4double fEDeposited;                   // energy deposited in the crystals
+    G4double fETotal;                       // energy of the replaced particles
+
+    void BeginShower(const G4FastTrack& fastTrack, G4FastStep& fastStep);
+    void Deposit(const G4ThreeVector& pos, G4double time, G4double edep);
+    void EndShower();
+
+public:
+    A2ShowerModel(const G4String& name, G4Region* region);
+    virtual ~A2ShowerModel();
+
+    virtual G4bool IsApplicable(const G4ParticleDefinition& particle);
+
+    void PrintStatistics();
+
+    static void AddProcess();
+    static G4double GetShowerEnergy(const G4ParticleDefinition* part, G4double ekin);
+    static G4double GetShowerEnergy(const G4Track* track);
+};
+
+#endif
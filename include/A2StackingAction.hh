@@ -0,0 +1,44 @@
+// A2StackingAction
+// Russian roulette of low-energy e+-/gamma created outside of the sensitive
+// volumes and splitting of weighted tracks entering them
+
+#ifndef A2StackingAction_h
+#define A2StackingAction_h 1
+
+#include "G4UserStackingAction.hh"
+#include "G4TrackVector.hh"
+#include "globals.hh"
+
+class G4Step;
+
+class A2StackingAction : public G4UserStackingAction
+{
+
+private:
+    G4long fNRoulette;                      // number of rouletted tracks
+    G4long fNKilled;                        // number of killed tracks
+    G4long fNSplit;                         // number of track copies created by splitting
+
+    static G4double fgRouletteEnergy;       // kinetic energy threshold (0: off)
+    static G4double fgSurvival;             // survival probability
+    static G4bool fgSplit;                  // split weighted tracks entering sensitive volumes
+    static G4int fgMaxSplit;                // maximum number of copies per track
+    static G4ThreadLocal A2StackingAction* fgInstance;  // stacking action of this thread
+
+public:
+    A2StackingAction();
+    virtual ~A2StackingAction();
+
+    virtual G4ClassificationOfNewTrack ClassifyNewTrack(const G4Track* aTrack);
+
+    void SplitTrack(const G4Step* aStep, G4TrackVector* secondaries);
+    void PrintStatistics();
+
+    static A2StackingAction* Instance() { return fgInstance; }
+    static void SetRouletteEnergy(G4double e) { fgRouletteEnergy = e; }
+    static void SetSurvival(G4double p) { fgSurvival = p; }
+    static void SetSplit(G4bool split) { fgSplit = split; }
+    static G4bool IsEnabled() { return fgRouletteEnergy > 0; }
+};
+
+#endif
@@ -6,6 +6,10 @@
 
 class A2DetectorConstruction;
 class A2EventAction;
+class A2TrackKiller;
+class A2Profiler;
+class G4ParticleDefinition;
+class G4VProcess;
 
 
 class A2SteppingAction : public G4UserSteppingAction
@@ -15,10 +19,31 @@ class A2SteppingAction : public G4UserSteppingAction
    ~A2SteppingAction();
 
     void UserSteppingAction(const G4Step*);
+
+    //resolve the cached pointers and settings, switch off for the run if disabled
+    void BeginOfRun();
+    void EndOfRun();
+
+    static A2SteppingAction* Instance() { return fgInstance; }
+    static void SetActive(G4bool active) { fgActive = active; }
+    static void SetKillStuckPhotons(G4bool kill) { fgKillStuckPhotons = kill; }
     
   private:
     A2DetectorConstruction* detector;
     A2EventAction*          eventaction;  
+
+    A2TrackKiller*          fKiller;            //track killer of this thread
+    G4ParticleDefinition*   fGamma;             //photon definition
+    G4VProcess*             fPhot;              //photoelectric process of photons
+    G4bool                  fKillStuckPhotons;  //kill stuck low-energy photons in this run
+    G4bool                  fSplit;             //split weighted tracks in this run
+    G4bool                  fRecord;            //record the shower library in this run
+    A2Profiler*             fProfiler;          //profiler of this thread
+    G4bool                  fProfile;           //profile the steps in this run
+
+    static G4bool fgActive;                     //stepping action switched on
+    static G4bool fgKillStuckPhotons;           //stuck-photon workaround switched on
+    static G4ThreadLocal A2SteppingAction* fgInstance;  //stepping action of this thread
 };
 
 
@@ -0,0 +1,34 @@
+// fast simulation of electromagnetic showers in the TAPS crystals using a
+// library of frozen showers
+
+#ifndef A2TAPSShowerModel_h
+#define A2TAPSShowerModel_h 1
+
+#include "A2ShowerModel.hh"
+
+class A2ShowerLibrary;
+
+class A2TAPSShowerModel : public A2ShowerModel
+{
+
+protected:
+    G4int fBin;                             // library bin of the triggered particle
+
+    static G4ThreadLocal A2TAPSShowerModel* fgInstance;  // model of this thread
+    static G4bool fgEnabled;                // model switched on
+    static G4String fgLibraryName;          // shower library file
+    static A2ShowerLibrary* fgLibrary;      // shower library (shared by all threads)
+
+public:
+    A2TAPSShowerModel(G4Region* region);
+    virtual ~A2TAPSShowerModel();
+
+    virtual G4bool ModelTrigger(const G4FastTrack& fastTrack);
+    virtual void DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep);
+
+    static A2TAPSShowerModel* Instance() { return fgInstance; }
+    static void SetLibrary(const G4String& name) { fgLibraryName = name; fgEnabled = true; }
+    static G4bool IsEnabled() { return fgEnabled; }
+};
+
+#endif
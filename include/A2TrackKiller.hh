@@ -0,0 +1,89 @@
+// Table-driven killing of tracks by region and particle type: energy floors,
+// time windows and particles that are never tracked
+
+#ifndef A2TrackKiller_h
+#define A2TrackKiller_h 1
+
+#include <vector>
+#include <unordered_map>
+
+#include "globals.hh"
+
+class G4Region;
+class G4ParticleDefinition;
+class G4Track;
+class G4StepPoint;
+
+// type of a kill rule
+enum EA2KillRule {
+    kKillBelow,                             // kill below a kinetic energy
+    kKillAfter,                             // kill after a global time
+    kKillAlways                             // kill always
+};
+
+class A2TrackKiller
+{
+
+private:
+    // kill rule configured via macro commands
+    struct A2KillRule_t {
+        G4String fRegion;                   // region name ("all" for all regions)
+        G4String fParticle;                 // particle name ("all", "neutrino" for all neutrinos)
+        EA2KillRule fType;                  // rule type
+        G4double fValue;                    // energy floor or time limit
+    };
+
+    // cuts of a region/particle cell of the table
+    struct A2KillCut_t {
+        G4double fEMin;                     // tracks below this kinetic energy are killed
+        G4double fTMax;                     // tracks after this global time are killed
+        G4bool fAlways;                     // tracks are always killed (not lifted by fEMin/fTMax)
+    };
+
+    // compiled table (rows: regions, columns: particles, index 0: not named in any rule)
+    G4int fGeneration;                      // rule generation of the table
+    std::vector<G4String> fRegionKeys;      // region names of the rows
+    std::vector<G4String> fPartKeys;        // particle names of the columns
+    std::vector<A2KillCut_t> fTable;        // cuts of all cells
+    std::unordered_map<const G4Region*, G4int> fRegionIndex;                 // row of a region
+    std::unordered_map<const G4ParticleDefinition*, G4int> fPartIndex;      // column of a particle
+    const G4Region* fLastRegion;            // region of the last look-up
+    G4int fLastRow;                         // row of fLastRegion
+    const G4ParticleDefinition* fLastPart;  // particle of the last look-up
+    G4int fLastCol;                         // column of fLastPart
+
+    G4long fNKilled[3];                     // number of killed tracks per rule type
+
+    static std::vector<A2KillRule_t> fgRules;  // configured rules
+    static G4int fgGeneration;              // incremented for every rule change
+    static G4bool fgDefaultRule;            // first rule is the default time limit
+    static G4ThreadLocal A2TrackKiller* fgInstance;  // track killer of this thread
+
+    A2TrackKiller();
+    void Compile();
+    G4int GetRow(const G4Region* region);
+    G4int GetColumn(const G4ParticleDefinition* part);
+    G4bool Check(const G4Region* region, const G4ParticleDefinition* part, G4double ekin, G4double time);
+
+public:
+    virtual ~A2TrackKiller() { }
+
+    static A2TrackKiller* Instance()
+    {
+        if (!fgInstance) fgInstance = new A2TrackKiller();
+        return fgInstance;
+    }
+
+    // kill decision for a new track and at the end point of a step
+    G4bool KillNewTrack(const G4Track* track);
+    G4bool KillAtStepPoint(const G4Track* track, const G4StepPoint* point);
+
+    void PrintStatistics();
+
+    static void AddRule(const G4String& region, const G4String& particle, EA2KillRule type, G4double value);
+    static void ClearRules();
+    static void PrintRules();
+    static G4bool HasStepRules(G4bool withDefault = true);
+};
+
+#endif
@@ -7,12 +7,14 @@
 #include "G4UserTrackingAction.hh"
 
 class A2PrimaryGeneratorAction;
+class A2EventStats;
 
 class A2TrackingAction : public G4UserTrackingAction
 {
 
 private:
     A2PrimaryGeneratorAction* fPGA;     // pointer to generator
+    A2EventStats* fEventStats;          // per-event statistics of this thread
 
 public:
     A2TrackingAction();
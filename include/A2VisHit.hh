@@ -39,22 +39,18 @@ public:
 };
 
 
-typedef G4THitsCollection<A2VisHit> A2VisHitsCollection;
+typedef A2ArenaHitsCollection<A2VisHit> A2VisHitsCollection;
 
-extern G4Allocator<A2VisHit> A2VisHitAllocator;
 
-
-inline void* A2VisHit::operator new(size_t)
+inline void* A2VisHit::operator new(size_t size)
 {
-  void* aHit;
-  aHit = (void*) A2VisHitAllocator.MallocSingle();
-  return aHit;
+  return A2HitArena::Instance()->AllocateObject(size);
 }
 
 
 inline void A2VisHit::operator delete(void* aHit)
 {
-  A2VisHitAllocator.FreeSingle((A2VisHit*) aHit);
+  A2HitArena::Instance()->Release(aHit);
 }
 
 #endif
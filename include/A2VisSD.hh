@@ -23,6 +23,7 @@ public:
   void clear();
   void DrawAll();
   void PrintAll();
+  G4VSensitiveDetector* Clone() const;
   
 private:
   
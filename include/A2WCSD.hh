@@ -2,7 +2,10 @@
 #ifndef A2WCSD_h
 #define A2WCSD_h 1
 
+#include <vector>
+
 #include "G4VSensitiveDetector.hh"
+#include "G4ThreeVector.hh"
 #include "globals.hh"
 
 class G4HCofThisEvent;
@@ -23,18 +26,32 @@ public:
   void clear();
   void DrawAll();
   void PrintAll();
+  G4VSensitiveDetector* Clone() const;
   
 private:
   
   A2HitsCollection*  fCollection;  
   G4int fHCID;
 
-  G4int fNelements;
-  G4int * fhitID;
-  G4int * fHits;
+  G4int fNelements;  //expected number of hits (initial capacity)
   G4int fNhits;
 
- 
+  //spatial hash of the hit positions: cells of the size of the merge radius,
+  //the hits of a cell are chained via fNext (open addressing, linear probing)
+  static const G4double fgMergeRadius;
+  std::vector<G4long> fCellKey;      //cell key of the hash slots
+  std::vector<G4int> fCellHead;      //last hit of the cell in the slot (-1: empty slot)
+  std::vector<G4int> fCellUsed;      //occupied slots
+  std::vector<G4int> fNext;          //previous hit in the same cell (-1: none)
+  std::vector<G4ThreeVector> fPos;   //hit positions
+  size_t fHashMask;
+
+  void ResizeHash(size_t nslots);
+  size_t FindSlot(G4long key) const;
+  G4int FindHit(const G4ThreeVector& pos) const;
+  void AddHit(const G4ThreeVector& pos);
+  static G4long CellKey(G4long ix, G4long iy, G4long iz)
+  { return ((ix&0x1FFFFF)<<42)|((iy&0x1FFFFF)<<21)|(iz&0x1FFFFF); }
 };
 
 #endif
@@ -1,5 +1,8 @@
 
 #include "G4RunManager.hh"
+#ifdef G4MULTITHREADED
+#include "G4MTRunManager.hh"
+#endif
 #include "G4UImanager.hh"
 #include "G4UIterminal.hh"
 #include "G4UItcsh.hh"
@@ -26,12 +29,17 @@
 
 #include "A2DetectorConstruction.hh"
 #include "A2PhysicsList.hh"
+#include "A2ActionInitialization.hh"
 #include "A2PrimaryGeneratorAction.hh"
-#include "A2RunAction.hh"
 #include "A2EventAction.hh"
-#include "A2SteppingAction.hh"
 #include "A2SteppingVerbose.hh"
-#include "A2TrackingAction.hh"
+
+#include "RVersion.h"
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,6,0)
+#include "TROOT.h"
+#else
+#include "TThread.h"
+#endif
 
 //#include "LHEP_BIC.hh"
 
@@ -39,8 +47,17 @@
 
 int main(int argc,char** argv) {
   
+  // ROOT is used concurrently by the worker threads, the output writer
+  // threads and the input prefetching thread: enable its thread safety
+  // once, before any file or tree is created
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,6,0)
+  ROOT::EnableThreadSafety();
+#else
+  TThread::Initialize();
+#endif
+
   // Define options
-  const char *optsShort = "hm:i:o:n:d:";
+  const char *optsShort = "hm:i:o:n:d:t:";
   const struct option optsLong[] = {
     {"help", no_argument,      NULL,'h'},
     {"mac",  required_argument,NULL,'m'},
@@ -48,6 +65,7 @@ int main(int argc,char** argv) {
     {"of",   required_argument,NULL,'o'},
     {"num",  required_argument,NULL,'n'},
     {"det",  required_argument,NULL,'d'},
+    {"threads",required_argument,NULL,'t'},
     {"gui",  no_argument,NULL,'g'},
     {NULL,   0                ,NULL, 0 }
   };
@@ -56,6 +74,7 @@ int main(int argc,char** argv) {
   G4int isInteractive  = 1;			// No macro so interactive (default)
   G4String nameFileMac = "macros/vis.mac";	// Default macro for interactive mode
   G4int numberOfEvents = -1;
+  G4int numberOfThreads = 1;
 #if defined(G4UI_USE_XM) || defined(G4UI_USE_WIN32)
   // Customize the G4UIXm,Win32 menubar with a macro file :
 //   nameFileMac = "visTutor/gui.mac");
@@ -74,7 +93,7 @@ int main(int argc,char** argv) {
     {
       case 'h':
 	G4cout << G4endl;
-	G4cout << "Usage: " << argv[0] << " [--mac=file] [--if=file] [--of=file] [--num=N]  [--det=file] [--help]" << G4endl;
+	G4cout << "Usage: " << argv[0] << " [--mac=file] [--if=file] [--of=file] [--num=N]  [--det=file] [--threads=N] [--help]" << G4endl;
 	G4cout << G4endl;
 	G4cout << "Options: " << G4endl;
 	G4cout << "\t-h --help \t print this help and exit" << G4endl;
@@ -82,6 +101,7 @@ int main(int argc,char** argv) {
 	G4cout << "\t-m --mac  \t .mac file to run in batch mode" << G4endl;
 	G4cout << "\t-n --num  \t # of events to simulate" << G4endl;
 	G4cout << "\t-d --det  \t detector setup macro" << G4endl;
+	G4cout << "\t-t --threads\t # of worker threads (batch mode only)" << G4endl;
 	G4cout << "\t-g --gui  \t use gui" << G4endl;
 	G4cout << "\t-o --of   \t output file (overwrites /A2/event/setOutputputFile command in macro)" << G4endl;
 	G4cout << G4endl;
@@ -116,6 +136,9 @@ int main(int argc,char** argv) {
       case 'g':
 	gui=true;
 	break;
+      case 't':
+	numberOfThreads = atoi(optarg);
+	break;
       case '?':
       default:
 	G4cout << "Unknown option!" << G4endl;
@@ -152,8 +175,31 @@ int main(int argc,char** argv) {
   // My verbose output class
   G4VSteppingVerbose::SetInstance(new A2SteppingVerbose);
      
-  // Construct the default run manager
-  G4RunManager * runManager = new G4RunManager;
+  // Construct the run manager
+  // In multithreaded mode every worker thread writes its own output
+  // file which is merged by the master at the end of the run
+  if (numberOfThreads > 1 && isInteractive)
+  {
+    G4cout << "Multithreading is only supported in batch mode, running sequentially" << G4endl;
+    numberOfThreads = 1;
+  }
+  G4RunManager * runManager = 0;
+#ifdef G4MULTITHREADED
+  if (numberOfThreads > 1)
+  {
+    G4MTRunManager* mtRunManager = new G4MTRunManager;
+    mtRunManager->SetNumberOfThreads(numberOfThreads);
+    runManager = mtRunManager;
+    G4cout << "Running with " << numberOfThreads << " worker threads" << G4endl;
+  }
+#else
+  if (numberOfThreads > 1)
+  {
+    G4cout << "Geant4 was built without multithreading support, running sequentially" << G4endl;
+    numberOfThreads = 1;
+  }
+#endif
+  if (!runManager) runManager = new G4RunManager;
 
   // Set mandatory initialization classes
   A2DetectorConstruction* detector = new A2DetectorConstruction(detSetup);
@@ -179,17 +225,26 @@ int main(int argc,char** argv) {
   if (!session) visManager->SetVerboseLevel("quiet");
 #endif
   // Set user action classes
-  A2PrimaryGeneratorAction* pga=new A2PrimaryGeneratorAction();
-  pga->SetDetCon(detector);
-  runManager->SetUserAction(pga);
-
-  A2RunAction* runaction = new A2RunAction;  
-  runManager->SetUserAction(runaction);
-  A2EventAction* eventaction = new A2EventAction(runaction, pga, argc, argv, detSetup);
-  eventaction->SetIsInteractive(isInteractive);
-  runManager->SetUserAction(eventaction);
-  runManager->SetUserAction(new A2SteppingAction(detector, eventaction));
-  runManager->SetUserAction(new A2TrackingAction());
+  A2PrimaryGeneratorAction* pga=0;
+  A2EventAction* eventaction=0;
+  if (numberOfThreads > 1)
+  {
+    // the user actions are created per worker thread, the master keeps its
+    // own generator and event action to receive the user commands, to set up
+    // the input and to merge the output of the threads
+    pga=new A2PrimaryGeneratorAction();
+    pga->SetDetCon(detector);
+    eventaction = new A2EventAction(0, pga, argc, argv, detSetup);
+    eventaction->SetIsInteractive(isInteractive);
+    eventaction->SetIsMaster(true);
+    runManager->SetUserInitialization(new A2ActionInitialization(detector, argc, argv, detSetup, isInteractive, eventaction));
+  }
+  else
+  {
+    runManager->SetUserInitialization(new A2ActionInitialization(detector, argc, argv, detSetup, isInteractive));
+    pga=const_cast<A2PrimaryGeneratorAction*>(static_cast<const A2PrimaryGeneratorAction*>(runManager->GetUserPrimaryGeneratorAction()));
+    eventaction=const_cast<A2EventAction*>(static_cast<const A2EventAction*>(runManager->GetUserEventAction()));
+  }
   // Initialize G4 kernel
 //   runManager->Initialize();
     
@@ -205,10 +260,11 @@ int main(int argc,char** argv) {
       UI->ApplyCommand("/A2/generator/InputFile " + nameFileInput);
     }
   
-  // Set output file
+  // Set output file (worker threads receive it via the command)
   if (!nameFileOutput.empty())
     {
       eventaction->SetOutFileName(nameFileOutput);
+      if (numberOfThreads > 1) UI->ApplyCommand("/A2/event/setOutputFile " + nameFileOutput);
     }
   
   // Set and prepare input if it has been set
@@ -232,6 +288,12 @@ int main(int argc,char** argv) {
 	{
 	  // Run in batch mode
 	  if (numberOfEvents < 0) numberOfEvents=pga->GetNEvents();
+	  // do not run beyond the input file (or the selected shard of it)
+	  if (pga->GetMode() == EPGA_FILE && numberOfEvents > pga->GetNEvents())
+	    {
+	      G4cout << "Only " << pga->GetNEvents() << " events in the input, " << numberOfEvents << " requested." << G4endl;
+	      numberOfEvents=pga->GetNEvents();
+	    }
 	  G4cout << "Will analyse " << numberOfEvents << " events." << G4endl;
           eventaction->SetReqEvents(numberOfEvents);
 	  runManager->BeamOn(numberOfEvents);
@@ -239,6 +301,11 @@ int main(int argc,char** argv) {
     }
   
   // Job termination
+  if (numberOfThreads > 1)
+  {
+    delete eventaction;
+    delete pga;
+  }
 #ifdef G4VIS_USE
   delete visManager;
 #endif
@@ -0,0 +1,65 @@
+// user action initialization for sequential and multithreaded runs
+
+#include "A2ActionInitialization.hh"
+#include "A2PrimaryGeneratorAction.hh"
+#include "A2RunAction.hh"
+#include "A2EventAction.hh"
+#include "A2SteppingAction.hh"
+#include "A2SteppingVerbose.hh"
+#include "A2TrackingAction.hh"
+#include "A2StackingAction.hh"
+
+//______________________________________________________________________________
+A2ActionInitialization::A2ActionInitialization(A2DetectorConstruction* det, int argc, char** argv,
+                                               const char* detSetup, G4int isInteractive,
+                                               A2EventAction* masterEventAction)
+    : G4VUserActionInitialization()
+{
+    // Constructor.
+
+    fDetCon = det;
+    fArgc = argc;
+    fArgv = argv;
+    fDetSetup = detSetup;
+    fIsInteractive = isInteractive;
+    fMasterEventAction = masterEventAction;
+}
+
+//______________________________________________________________________________
+void A2ActionInitialization::Build() const
+{
+    // Create the user actions of the sequential run manager or of a worker thread.
+
+    A2PrimaryGeneratorAction* pga = new A2PrimaryGeneratorAction();
+    pga->SetDetCon(fDetCon);
+    SetUserAction(pga);
+
+    A2RunAction* runaction = new A2RunAction();
+    SetUserAction(runaction);
+
+    A2EventAction* eventaction = new A2EventAction(runaction, pga, fArgc, fArgv, fDetSetup);
+    eventaction->SetIsInteractive(fIsInteractive);
+    SetUserAction(eventaction);
+
+    SetUserAction(new A2SteppingAction(fDetCon, eventaction));
+    SetUserAction(new A2TrackingAction());
+    SetUserAction(new A2StackingAction());
+}
+
+//______________________________________________________________________________
+void A2ActionInitialization::BuildForMaster() const
+{
+    // Create the run action of the master thread which merges the output
+    // of the worker threads.
+
+    SetUserAction(new A2RunAction(fMasterEventAction));
+}
+
+//______________________________________________________________________________
+G4VSteppingVerbose* A2ActionInitialization::InitializeSteppingVerbose() const
+{
+    // Return the stepping verbose class of the worker threads.
+
+    return new A2SteppingVerbose();
+}
+
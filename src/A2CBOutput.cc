@@ -1,11 +1,22 @@
+
 #include "A2CBOutput.hh"
 #include "A2FileGenerator.hh"
+#include "A2StackingAction.hh"
 #include "G4RunManager.hh"
+#include "G4SDManager.hh"
 #include "CLHEP/Units/SystemOfUnits.h"
 
+#include "TStopwatch.h"
+#include "TBranch.h"
+
+#include <cstring>
+#include <chrono>
+
 using namespace CLHEP;
 
-A2CBOutput::A2CBOutput(){
+A2CBOutput::A2CBOutput()
+  : fQueueHead(0), fQueueTail(0), fWriterStop(false)
+{
   fFile=NULL;
   fTree=NULL;
   fPGA=const_cast<A2PrimaryGeneratorAction*>(static_cast<const A2PrimaryGeneratorAction*>(G4RunManager::GetRunManager()->GetUserPrimaryGeneratorAction()));
@@ -13,222 +24,316 @@ A2CBOutput::A2CBOutput(){
   fDET=const_cast<A2DetectorConstruction*>(static_cast<const A2DetectorConstruction*>(G4RunManager::GetRunManager()->GetUserDetectorConstruction()));
   //Need to get the number of initial particles
   fnpart=fPGA->GetNGenMaxParticles();
-  if(fnpart>100){
-    G4cerr<<"A2CBOutput::A2CBOutput() can only store 100 particles. Need to edit fdircos[100][3] in A2CBOutput.hh if you want more particles."<<G4endl;
-    exit(1);
-  }
   //Get the LorentzVectors of the initial particles
   fGenLorentzVec=(fPGA->GetGenLorentzVecs()); //Only exists if ntuple input
   fBeamLorentzVec=fPGA->GetBeamLorentzVec();//Will take the default beam if no ntuple
   fGenPartType=fPGA->GetGenPartType();
   fvertex=fPGA->GetVertex();
   //Initialise arrays dependent on number of particles
-  //Note can't initialize 2 dimesional arrays like this when writing 
-  //to a ROOT TTree, you only get the correct info for the first particle
-  //fdircos now declared as a 2D array with 100 and 3 dimensions 
-  //fdircos=new Float_t*[fnpart];
-  //for(Int_t i=0;i<fnpart;i++) fdircos[i]=new Float_t[3];
-  felab=new Float_t[fnpart]; 
-  fplab=new Float_t[fnpart]; 
-  fidpart=new Int_t[fnpart]; 
+  //(fdircos is stored flat as [fnpart][3] so that ROOT gets one contiguous block)
+  G4int npartmax=fnpart>0 ? fnpart : 1;
+  fdircos.resize(3*npartmax);
+  felab.resize(npartmax);
+  fplab.resize(npartmax);
+  fidpart.resize(npartmax);
 
   //create Tree
   fTree=new TTree("h12","Crystals");
   fTree->SetAutoSave();
-
-  //Collection IDs for decoding hit collections
-  fCBCollID = -1;
-  fTAPSCollID = -1;
+  fBranchesSet=false;
+  fBasketSize=64000;
 
   // store IDs of primary particles
   fStorePrimaries = true;
 
-  //TOF stuff
-  if(fDET->GetNToFbars()>0){
-    fToFTot=fDET->GetNToFbars();
-    ftofi=new Int_t[fToFTot];
-    ftofe=new Float_t[fToFTot];
-    ftoft=new Float_t[fToFTot];
-    ftofx=new Float_t[fToFTot];
-    ftofy=new Float_t[fToFTot];
-    ftofz=new Float_t[fToFTot];
-  }
-
   fIsGiBUU = false;
   if (fPGA->GetFileGen())
     fIsGiBUU = (fPGA->GetFileGen()->GetType() == A2FileGenerator::kGiBUU);
   fweight = 1;
+
+  feleak=0;
+  fenai=0;
+  fetot=0;
+
+  fStoreEventID = false;
+  feventid = 0;
+
+  fStoreEventStats = false;
+  fevtime = 0;
+  fnsteps = 0;
+  fntracks = 0;
+  frss = 0;
+
+  fNQueueStalls=0;
+  fWriterTime=0;
 }
 A2CBOutput::~A2CBOutput(){
-  delete fidpart;
-  delete fplab;
-  delete felab;
-  // for(Int_t i=0;i<fnpart;i++) delete fdircos[i];
+  StopWriter();
+  for(size_t i=0;i<fDetectors.size();i++) delete fDetectors[i];
   if(fTree)delete fTree;
 }
-//Float_t dircos[4][3];
+A2OutputDetector_t* A2CBOutput::AddDetector(const G4String& name, const G4String& count, G4int capacity,
+                                             G4double threshold){
+  //Register the output of the detector 'name' with the count branch 'count'
+  //The column buffers hold 'capacity' hits initially and grow if needed
+  //Hits with energy deposits below 'threshold' are not written
+  if(fBranchesSet){
+    G4cout<<"A2CBOutput::AddDetector() Can't register "<<count<<" after the branches were created!"<<G4endl;
+    return NULL;
+  }
+  A2OutputDetector_t* det=new A2OutputDetector_t();
+  det->fName=name;
+  det->fCount=count;
+  det->fN=0;
+  det->fCapacity=capacity>0 ? capacity : 1;
+  det->fESum=NULL;
+  det->fThreshold=threshold;
+  det->fNSuppressed=0;
+  fDetectors.push_back(det);
+  return det;
+}
+void A2CBOutput::AddCollection(A2OutputDetector_t* det, const G4String& collection){
+  //Hits of the collection 'collection' are written to the columns of 'det'
+  //(several collections are appended in the order of registration)
+  if(!det) return;
+  det->fCollections.push_back(collection);
+}
+void A2CBOutput::AddColumn(A2OutputDetector_t* det, const G4String& name, EA2HitQuantity quantity,
+                           G4bool isInt, G4double unit){
+  //Add the column 'name' storing 'quantity' of the hits of 'det'
+  //Float values are stored in units of 'unit'
+  if(!det) return;
+  A2OutputColumn_t col;
+  col.fName=name;
+  col.fQuantity=quantity;
+  col.fIsInt=isInt;
+  col.fUnit=unit;
+  if(isInt) col.fI.resize(det->fCapacity);
+  else col.fF.resize(det->fCapacity);
+  det->fColumns.push_back(col);
+}
+void A2CBOutput::RegisterDetectors(){
+  //Every detector declares its own output columns
+  //(the count branches of the cbsim detectors are always written)
+  fDET->RegisterOutput(this);
+
+  //Biased tracking: the energy columns hold the unweighted deposits (used
+  //for the thresholds), add columns "w<name>" with the deposits weighted
+  //with the track weights for unbiased sums
+  if(A2StackingAction::IsEnabled()){
+    for(size_t d=0;d<fDetectors.size();d++){
+      A2OutputDetector_t* det=fDetectors[d];
+      std::vector<A2OutputColumn_t> cols;
+      for(size_t i=0;i<det->fColumns.size();i++)
+        if(det->fColumns[i].fQuantity==kHitEdep) cols.push_back(det->fColumns[i]);
+      for(size_t i=0;i<cols.size();i++)
+        AddColumn(det,"w"+cols[i].fName,kHitWEdep,false,cols[i].fUnit);
+    }
+  }
+}
+void A2CBOutput::ResolveCollectionIDs(){
+  //Look up the IDs of the registered hits collections once per run and
+  //build the dispatch table used by WriteHit()
+  //(collections of detectors which are not built are skipped)
+  G4SDManager* SDman=G4SDManager::GetSDMpointer();
+  fWriters.clear();
+  for(size_t d=0;d<fDetectors.size();d++){
+    A2OutputDetector_t* det=fDetectors[d];
+    for(size_t c=0;c<det->fCollections.size();c++){
+      G4int id=SDman->GetCollectionID(det->fCollections[c]);
+      if(id>=0) fWriters.push_back(std::make_pair(id,det));
+    }
+  }
+}
+void A2CBOutput::GrowDetector(A2OutputDetector_t* det, G4int n){
+  //Enlarge the column buffers of 'det' to hold at least 'n' hits and
+  //update the branch addresses
+  G4int cap=det->fCapacity;
+  while(cap<n) cap*=2;
+  det->fCapacity=cap;
+  for(size_t i=0;i<det->fColumns.size();i++){
+    A2OutputColumn_t& col=det->fColumns[i];
+    if(col.fIsInt) col.fI.resize(cap);
+    else col.fF.resize(cap);
+    //(the writer thread sets the addresses to its event records)
+    if(fWriter.joinable()) continue;
+    if(col.fIsInt) fTree->SetBranchAddress(col.fName,&col.fI[0]);
+    else fTree->SetBranchAddress(col.fName,&col.fF[0]);
+  }
+}
 void A2CBOutput::SetBranches(){
 
   if(!fTree){
     G4cout<<"A2CBOutput::SetBranches() Can't set branches have to set fTree first!"<<G4endl;
     return;
   }
-  Int_t basket =64000;
-
-  fTree->Branch("nhits",&fnhits,"fnhits/I",basket);
-  fTree->Branch("npart",&fnpart,"fnpart/I",basket);
-  fTree->Branch("ntaps",&fntaps,"fntaps/I",basket);
-  fTree->Branch("nvtaps",&fnvtaps,"fnvtaps/I",basket);
-  fTree->Branch("vhits",&fvhits,"fvhits/I",basket);
-  fTree->Branch("plab",fplab,"fplab[fnpart]/F",basket);
-  fTree->Branch("tctaps",ftctaps,"ftctaps[fntaps]/F",basket);
-  fTree->Branch("vertex",fvertex,"fvertex[3]/F",basket);
-  fTree->Branch("beam",fbeam,"fbeam[5]/F",basket);
-  fTree->Branch("dircos",fdircos,"fdircos[fnpart][3]/F",basket);
-  fTree->Branch("ecryst",fecryst,"fecryst[fnhits]/F",basket);
-  fTree->Branch("tcryst",ftcryst,"ftcryst[fnhits]/F",basket);
-  fTree->Branch("ectapfs",fectapfs,"fectapfs[fntaps]/F",basket);
-  fTree->Branch("ectapsl",fectapsl,"fectapsl[fntaps]/F",basket);
-  fTree->Branch("elab",felab,"felab[fnpart]/F",basket);
-  fTree->Branch("eleak",&feleak,"feleak/F",basket);
-  fTree->Branch("enai",&fenai,"fenai/F",basket);
-  fTree->Branch("etot",&fetot,"fetot/F",basket);
-  fTree->Branch("eveto",feveto,"feveto[fvhits]/F",basket);
-  fTree->Branch("tveto",ftveto,"ftveto[fvhits]/F",basket);
-  fTree->Branch("evtaps",fevtaps,"fevtaps[fnvtaps]/F",basket);
-  fTree->Branch("icryst",ficryst,"ficryst[fnhits]/I",basket);
-  fTree->Branch("ictaps",fictaps,"fictaps[fntaps]/I",basket);
-  if (fStorePrimaries)
-  {
-    G4cout << "Storing IDs of primary particles" << G4endl;
-    fTree->Branch("pcryst",fpcryst,"fpcryst[fnhits]/I",basket);
-    fTree->Branch("pctaps",fpctaps,"fpctaps[fntaps]/I",basket);
-    fTree->Branch("pveto",fpveto,"fpveto[fvhits]/I",basket);
-    fTree->Branch("pvtaps",fpvtaps,"fpvtaps[fnvtaps]/I",basket);
-  }
-  fTree->Branch("ivtaps",fivtaps,"fictaps[fnvtaps]/I",basket);
-  fTree->Branch("idpart",fidpart,"fidpart[fnpart]/I",basket);
-  fTree->Branch("iveto",fiveto,"fiveto[fvhits]/I",basket);
-  if (fDET->GetUseMWPC() && fDET->GetUseMWPC() / 10 == 0)
-  {
-    fTree->Branch("nmwpc",&fnmwpc,"fnmwpc/I",basket);
-    fTree->Branch("imwpc",fimwpc,"fimwpc[fnmwpc]/I",basket);
-    fTree->Branch("mposx",fmposx,"fmposx[fnmwpc]/F",basket);
-    fTree->Branch("mposy",fmposy,"fmposy[fnmwpc]/F",basket);
-    fTree->Branch("mposz",fmposz,"fmposz[fnmwpc]/F",basket);
-    fTree->Branch("emwpc",femwpc,"femwpc[fnmwpc]/F",basket);
-  }
-  else
-    G4cout<<"A2CBOutput::SetBranches() Disabling MWPC readout"<<G4endl;
-  //tof stuff
-  if(fToFTot>0){
-    fTree->Branch("ntof",&fntof,"fntof/I",basket);
-    fTree->Branch("tofi",ftofi,"ftofi[fntof]/I",basket);
-    fTree->Branch("tofe",ftofe,"ftofe[fntof]/F",basket);
-    fTree->Branch("toft",ftoft,"ftoft[fntof]/F",basket);
-    fTree->Branch("tofx",ftofx,"ftofx[fntof]/F",basket);
-    fTree->Branch("tofy",ftofy,"ftofy[fntof]/F",basket);
-    fTree->Branch("tofz",ftofz,"ftofz[fntof]/F",basket);
+  fSegments.clear();
+  AddBranch("npart",&fnpart,"fnpart/I",sizeof(Int_t));
+  AddBranch("plab",&fplab[0],"fplab[fnpart]/F",sizeof(Float_t),&fnpart);
+  AddBranch("vertex",fvertex,"fvertex[3]/F",3*sizeof(Float_t));
+  AddBranch("beam",fbeam,"fbeam[5]/F",5*sizeof(Float_t));
+  AddBranch("dircos",&fdircos[0],"fdircos[fnpart][3]/F",3*sizeof(Float_t),&fnpart);
+  AddBranch("elab",&felab[0],"felab[fnpart]/F",sizeof(Float_t),&fnpart);
+  AddBranch("eleak",&feleak,"feleak/F",sizeof(Float_t));
+  AddBranch("enai",&fenai,"fenai/F",sizeof(Float_t));
+  AddBranch("etot",&fetot,"fetot/F",sizeof(Float_t));
+  AddBranch("idpart",&fidpart[0],"fidpart[fnpart]/I",sizeof(Int_t),&fnpart);
+
+  //detector output
+  RegisterDetectors();
+  if (fStorePrimaries) G4cout << "Storing IDs of primary particles" << G4endl;
+  for(size_t d=0;d<fDetectors.size();d++){
+    A2OutputDetector_t* det=fDetectors[d];
+    AddBranch(det->fCount,&det->fN,("f"+det->fCount+"/I").c_str(),sizeof(Int_t));
+    for(size_t i=0;i<det->fColumns.size();i++){
+      A2OutputColumn_t* col=&det->fColumns[i];
+      if(col->fIsInt)
+        AddBranch(col->fName,&col->fI[0],("f"+col->fName+"[f"+det->fCount+"]/I").c_str(),sizeof(Int_t),&det->fN,col);
+      else
+        AddBranch(col->fName,&col->fF[0],("f"+col->fName+"[f"+det->fCount+"]/F").c_str(),sizeof(Float_t),&det->fN,col);
+    }
   }
-  fTree->Branch("npiz",&fnpiz,"fnpiz/I",basket);
-  fTree->Branch("ipiz",fipiz,"fipiz[fnpiz]/I",basket);
-  fTree->Branch("epiz",fepiz,"fepiz[fnpiz]/F",basket);
-  fTree->Branch("tpiz",ftpiz,"ftpiz[fnpiz]/F",basket);
+  fBranchesSet=true;
+
   if (fIsGiBUU)
-    fTree->Branch("weight",&fweight,"fweight/F",basket);
+    AddBranch("weight",&fweight,"fweight/F",sizeof(Float_t));
+  if (fStoreEventID)
+    AddBranch("eventid",&feventid,"feventid/I",sizeof(Int_t));
+  if (fStoreEventStats) {
+    AddBranch("evtime",&fevtime,"fevtime/F",sizeof(Float_t));
+    AddBranch("nsteps",&fnsteps,"fnsteps/I",sizeof(Int_t));
+    AddBranch("ntracks",&fntracks,"fntracks/I",sizeof(Int_t));
+    AddBranch("rss",&frss,"frss/F",sizeof(Float_t));
+  }
  }
+void A2CBOutput::AddBranch(const char* name, void* addr, const char* leaflist, Int_t size,
+                           Int_t* count, A2OutputColumn_t* col){
+  //Create a branch and remember its memory block for the output writer
+  //'size' is the size of one entry of a variable-length array with
+  //'*count' entries or the size of the whole buffer
+  A2OutputSegment_t seg;
+  seg.fBranch=fTree->Branch(name,addr,leaflist,fBasketSize);
+  seg.fAddr=addr;
+  seg.fCol=col;
+  seg.fCount=count;
+  seg.fSize=size;
+  fSegments.push_back(seg);
+}
+void A2CBOutput::PackRecord(A2OutputRecord_t& rec){
+  //Copy the branch buffers of the current event into rec
+  if(rec.fData.size()!=fSegments.size()) rec.fData.resize(fSegments.size());
+  for(size_t i=0;i<fSegments.size();i++){
+    const A2OutputSegment_t& seg=fSegments[i];
+    const void* addr=seg.fAddr;
+    if(seg.fCol) addr=seg.fCol->fIsInt ? (const void*)&seg.fCol->fI[0] : (const void*)&seg.fCol->fF[0];
+    size_t bytes=seg.fSize*(seg.fCount ? *seg.fCount : 1);
+    std::vector<char>& data=rec.fData[i];
+    //(keep at least one entry so that the branch address is valid)
+    if(data.size()<bytes || data.empty()) data.resize(bytes>0 ? bytes : seg.fSize);
+    if(bytes) memcpy(&data[0],addr,bytes);
+  }
+}
+void A2CBOutput::UnpackRecord(A2OutputRecord_t& rec){
+  //Point the branches to the buffers of rec
+  for(size_t i=0;i<fSegments.size();i++) fSegments[i].fBranch->SetAddress(&rec.fData[i][0]);
+}
+void A2CBOutput::Fill(){
+  //Fill the current event into the tree or queue it for the writer thread
+  if(!fWriter.joinable()){
+    fTree->Fill();
+    return;
+  }
+  size_t tail=fQueueTail.load(std::memory_order_relaxed);
+  size_t next=(tail+1)%fQueue.size();
+  if(next==fQueueHead.load(std::memory_order_acquire)){
+    fNQueueStalls++;
+    while(next==fQueueHead.load(std::memory_order_acquire)) std::this_thread::yield();
+  }
+  PackRecord(fQueue[tail]);
+  fQueueTail.store(next,std::memory_order_release);
+}
+void A2CBOutput::StartWriter(G4int depth){
+  //Start a thread filling the tree with the events queued by Fill()
+  //depth is the maximum number of queued events
+  if(fWriter.joinable()||depth<1) return;
+  if(fSegments.empty()){
+    G4cout<<"A2CBOutput::StartWriter() Have to set the branches first!"<<G4endl;
+    return;
+  }
+  fQueue.resize(depth+1);
+  fQueueHead.store(0);
+  fQueueTail.store(0);
+  fWriterStop.store(false);
+  fNQueueStalls=0;
+  fWriterTime=0;
+  fWriter=std::thread(&A2CBOutput::RunWriter,this);
+}
+void A2CBOutput::StopWriter(){
+  //Write the queued events and stop the writer thread
+  if(!fWriter.joinable()) return;
+  fWriterStop.store(true,std::memory_order_release);
+  fWriter.join();
+  G4cout<<"A2CBOutput::StopWriter() Output writer finished, "<<fNQueueStalls
+        <<" events waited for a free queue entry, "<<fWriterTime<<" s filling the tree"<<G4endl;
+}
+void A2CBOutput::RunWriter(){
+  //Main loop of the writer thread
+  TStopwatch timer;
+  timer.Reset();
+  while(true){
+    size_t head=fQueueHead.load(std::memory_order_relaxed);
+    if(head==fQueueTail.load(std::memory_order_acquire)){
+      //drain the queue before stopping
+      if(fWriterStop.load(std::memory_order_acquire)&&head==fQueueTail.load(std::memory_order_acquire)) break;
+      std::this_thread::sleep_for(std::chrono::microseconds(50));
+      continue;
+    }
+    UnpackRecord(fQueue[head]);
+    timer.Start(kFALSE);
+    fTree->Fill();
+    timer.Stop();
+    fQueueHead.store((head+1)%fQueue.size(),std::memory_order_release);
+  }
+  fWriterTime=timer.RealTime();
+}
 void A2CBOutput::WriteHit(G4HCofThisEvent* HitsColl){
-  G4int CollSize=HitsColl->GetNumberOfCollections();
-  //G4cout<<"Collection size "<<CollSize<<" "<<HitsColl->GetHC(0)->GetName()<<" "<<HitsColl->GetHC(1)->GetName()<<G4endl;
-  //G4cout<<"Collection size "<<CollSize<<G4endl;
-  fnhits=fntaps=fnvtaps=fvhits=fntof=fnpiz=fnmwpc=0;
   fetot=0;
-  G4int hci=0;
-  for(G4int i=0;i<CollSize;i++){
-    //Get the ball hit info to be written to output
-    A2HitsCollection* hc;
-    //Look for the hits collections with entries 
-    while(!(hc=static_cast<A2HitsCollection*>(HitsColl->GetHC(hci++))));
-    //if(!hc)continue; //no hits in that detector
-    G4int hc_nhits=hc->entries();
-    //G4cout<<i<<" "<<hc->GetName()<< " "<<hc_nhits<<G4endl;
-    if(hc->GetName()=="A2SDHitsCBSD"||hc->GetName()=="A2SDHitsVisCBSD"){
-      fnhits=hc_nhits;
-      for(Int_t ii=0;ii<fnhits;ii++){
-	A2Hit* hit=static_cast<A2Hit*>(hc->GetHit(ii));
-	fecryst[ii]=hit->GetEdep()/GeV;
-	ftcryst[ii]=hit->GetTime()/ns;
-	ficryst[ii]=hit->GetID();
-	fpcryst[ii]=hit->GetParticle();
-	fetot+=fecryst[ii];
-      }
-    }
-    if(hc->GetName()=="A2SDHitsTAPSSD"||hc->GetName()=="A2SDHitsTAPSVisSD"){
-      fntaps=hc_nhits;
-      for(Int_t ii=0;ii<fntaps;ii++){
-	A2Hit* hit=static_cast<A2Hit*>(hc->GetHit(ii));
-	fectapsl[ii]=hit->GetEdep()/GeV;
-	fictaps[ii]=hit->GetID();
-	ftctaps[ii]=hit->GetTime()/ns;
-	fpctaps[ii]=hit->GetParticle();
-	//fetot+=fectapsl[i];//***TEMP!!!!
-      }
-    }
-    if(hc->GetName()=="A2SDHitsTAPSVSD"||hc->GetName()=="A2SDHitsTAPSVVisSD"){
-      fnvtaps=hc_nhits;
-      for(Int_t ii=0;ii<fnvtaps;ii++){
-	A2Hit* hit=static_cast<A2Hit*>(hc->GetHit(ii));
-	fevtaps[ii]=hit->GetEdep()/GeV;
-	fivtaps[ii]=hit->GetID();
-	fpvtaps[ii]=hit->GetParticle();
-      }
-    }
-    if(hc->GetName()=="A2SDHitsPIDSD"){
-      fvhits=hc_nhits;
-      for(Int_t ii=0;ii<fvhits;ii++){
-	A2Hit* hit=static_cast<A2Hit*>(hc->GetHit(ii));
-	feveto[ii]=hit->GetEdep()/GeV;
-	ftveto[ii]=hit->GetTime()/ns;
-	fiveto[ii]=hit->GetID();
-	fpveto[ii]=hit->GetParticle();
-      }
-    }
-    if(hc->GetName().contains("A2MWPCSD")){
-      // fnmwpc=hc_nhits;
-      for(Int_t ii=0;ii<hc_nhits;ii++){
-	A2Hit* hit=static_cast<A2Hit*>(hc->GetHit(ii));
-	fimwpc[fnmwpc+ii]   = hit->GetID();
-	fmposx[fnmwpc+ii] = (Float_t)hit->GetPos().getX();
-	fmposy[fnmwpc+ii] = (Float_t)hit->GetPos().getY();
-	fmposz[fnmwpc+ii] = (Float_t)hit->GetPos().getZ();
-	femwpc[fnmwpc+ii] = (Float_t)hit->GetEdep()/GeV;
-	//	G4cout<<fnmwpc+i<<" "<<fimwpc[fnmwpc+i]<<" "<<fmpos[fnmwpc+i][0]<<" "<<fmpos[fnmwpc+i][1]<<" "<<fmpos[fnmwpc+i][2]<<G4endl;
-      }
-      fnmwpc+=hc_nhits;
-    }
-    if(hc->GetName()=="A2SDHitsTOFSD"){
-      fntof=hc_nhits;
-      for(Int_t ii=0;ii<fntof;ii++){
-	A2Hit* hit=static_cast<A2Hit*>(hc->GetHit(ii));
-	ftofe[ii]=hit->GetEdep()/GeV;
-	ftoft[ii]=hit->GetTime()/ns;
-	ftofx[ii]=hit->GetPos().x()/cm;
-	ftofy[ii]=hit->GetPos().y()/cm;
-	ftofz[ii]=hit->GetPos().z()/cm;
-	ftofi[ii]=hit->GetID();
-      }
+  for(size_t d=0;d<fDetectors.size();d++) fDetectors[d]->fN=0;
+  for(size_t i=0;i<fWriters.size();i++){
+    G4VHitsCollection* hc=HitsColl->GetHC(fWriters[i].first);
+    if(hc) WriteCollection(fWriters[i].second,hc);
+  }
+}
+void A2CBOutput::WriteCollection(A2OutputDetector_t* det, G4VHitsCollection* hc){
+  //Append the hits of 'hc' above the readout threshold to the columns of 'det'
+  G4int hc_nhits=hc->GetSize();
+  if(det->fN+hc_nhits>det->fCapacity) GrowDetector(det,det->fN+hc_nhits);
+  for(G4int ii=0;ii<hc_nhits;ii++){
+    A2Hit* hit=static_cast<A2Hit*>(hc->GetHit(ii));
+    if(hit->GetEdep()<det->fThreshold){
+      det->fNSuppressed++;
+      continue;
     }
-    if(hc->GetName()=="A2SDHitsPizzaSD" || hc->GetName()=="A2SDHitsPizzaVisSD"){
-      fnpiz=hc_nhits;
-      for(Int_t ii=0;ii<fnpiz;ii++){
-	A2Hit* hit=static_cast<A2Hit*>(hc->GetHit(ii));
-	fepiz[ii]=hit->GetEdep()/GeV;
-	ftpiz[ii]=hit->GetTime()/ns;
-	fipiz[ii]=hit->GetID();
+    G4int k=det->fN++;
+    for(size_t i=0;i<det->fColumns.size();i++){
+      A2OutputColumn_t& col=det->fColumns[i];
+      G4double val=0;
+      switch(col.fQuantity){
+      case kHitID: val=hit->GetID(); break;
+      case kHitEdep: val=hit->GetEdep(); break;
+      case kHitWEdep: val=hit->GetWEdep(); break;
+      case kHitTime: val=hit->GetTime(); break;
+      case kHitParticle: val=hit->GetParticle(); break;
+      case kHitPosX: val=hit->GetPos().x(); break;
+      case kHitPosY: val=hit->GetPos().y(); break;
+      case kHitPosZ: val=hit->GetPos().z(); break;
+      default: break;
       }
+      if(col.fIsInt) col.fI[k]=(Int_t)val;
+      else col.fF[k]=(Float_t)(val/col.fUnit);
     }
+    if(det->fESum) *det->fESum+=(Float_t)(hit->GetEdep()/GeV);
   }
-  
 }
 void A2CBOutput::WriteGenInput(){
   //Note fvertex is already the pointer to fPGA::fGenPosition 
@@ -244,9 +349,9 @@ void A2CBOutput::WriteGenInput(){
   fnpart=fPGA->GetNGenParticles();
   for(Int_t i=0;i<fnpart;i++){
     vec=fGenLorentzVec[i]->Vect().Unit();
-    fdircos[i][0]=static_cast<Float_t>(vec.X());
-    fdircos[i][1]=static_cast<Float_t>(vec.Y());
-    fdircos[i][2]=static_cast<Float_t>(vec.Z());
+    fdircos[3*i]=static_cast<Float_t>(vec.X());
+    fdircos[3*i+1]=static_cast<Float_t>(vec.Y());
+    fdircos[3*i+2]=static_cast<Float_t>(vec.Z());
     felab[i]=fGenLorentzVec[i]->E()/GeV;
     fplab[i]=fGenLorentzVec[i]->Rho()/GeV;
     fidpart[i]=fGenPartType[i];
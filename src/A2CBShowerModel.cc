@@ -0,0 +1,131 @@
+// parameterised electromagnetic showers in the Crystal Ball crystals
+
+#include <cmath>
+
+#include "G4Region.hh"
+#include "G4Track.hh"
+#include "G4Material.hh"
+#include "G4Element.hh"
+#include "G4Gamma.hh"
+#include "Randomize.hh"
+#include "CLHEP/Random/RandGamma.h"
+#include "CLHEP/Units/SystemOfUnits.h"
+#include "CLHEP/Units/PhysicalConstants.h"
+#include "G4ios.hh"
+
+#include "A2CBShowerModel.hh"
+
+using namespace CLHEP;
+
+G4ThreadLocal A2CBShowerModel* A2CBShowerModel::fgInstance = 0;
+G4bool A2CBShowerModel::fgEnabled = false;
+G4double A2CBShowerModel::fgMinEnergy = 50*MeV;
+G4double A2CBShowerModel::fgSpotEnergy = 1*MeV;
+
+//______________________________________________________________________________
+A2CBShowerModel::A2CBShowerModel(G4Region* region)
+    : A2ShowerModel("A2CBShowerModel", region)
+{
+    // Constructor.
+    // The model replaces the tracking of e+-/gamma above the minimum energy in
+    // the crystals of 'region' by a parameterised shower.
+
+    // init members
+    fMaterial = 0;
+    fRadLength = 0;
+    fMoliere = 0;
+    fCritEnergy = 0;
+
+    fgInstance = this;
+
+    G4cout << "A2CBShowerModel::A2CBShowerModel(): Parameterised showers in region " << region->GetName()
+           << " for e+-/gamma above " << fgMinEnergy/MeV << " MeV" << G4endl;
+}
+
+//______________________________________________________________________________
+A2CBShowerModel::~A2CBShowerModel()
+{
+    // Destructor.
+
+    if (fgInstance == this)
+        fgInstance = 0;
+}
+
+//______________________________________________________________________________
+G4bool A2CBShowerModel::ModelTrigger(const G4FastTrack& fastTrack)
+{
+    // Parameterise the shower of particles above the minimum energy.
+
+    return fastTrack.GetPrimaryTrack()->GetKineticEnergy() > fgMinEnergy;
+}
+
+//______________________________________________________________________________
+void A2CBShowerModel::SetMaterial(const G4Material* mat)
+{
+    // Calculate the shower parameters of the material 'mat'.
+
+    if (mat == fMaterial)
+        return;
+
+    // effective Z (by mass fractions) and critical energy (Rossi, solids)
+    G4double zeff = 0;
+    const G4double* frac = mat->GetFractionVector();
+    for (size_t i = 0; i < mat->GetNumberOfElements(); i++)
+        zeff += frac[i] * mat->GetElement(i)->GetZ();
+
+    fMaterial = mat;
+    fRadLength = mat->GetRadlen();
+    fCritEnergy = 610*MeV / (zeff + 1.24);
+    fMoliere = 21.2052*MeV * fRadLength / fCritEnergy;
+}
+
+//______________________________________________________________________________
+void A2CBShowerModel::DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep)
+{
+    // Kill the particle and deposit its energy in energy spots distributed
+    // according to a Gamma distribution along the particle direction
+    // (longitudinal profile) and a two-component radial profile in units of
+    // the Moliere radius. The spots are summed per crystal and passed to its
+    // sensitive detector, spots outside the crystals are lost (leakage).
+
+    const G4Track* track = fastTrack.GetPrimaryTrack();
+    BeginShower(fastTrack, fastStep);
+    G4double energy = GetShowerEnergy(track);
+
+    // longitudinal profile: position of the maximum in radiation lengths
+    SetMaterial(track->GetMaterial());
+    const G4double b = 0.5;
+    G4double tmax = std::log(energy / fCritEnergy) + (track->GetDefinition() == G4Gamma::Definition() ? 0.5 : -0.5);
+    if (tmax < 0) tmax = 0;
+    G4double a = 1 + b*tmax;
+
+    // radial profile: core and tail (about 90% within one Moliere radius)
+    const G4double pCore = 0.8;
+    const G4double rCore = 0.2*fMoliere;
+    const G4double rTail = 0.8*fMoliere;
+
+    // shower axis
+    G4ThreeVector pos = track->GetPosition();
+    G4ThreeVector dir = track->GetMomentumDirection();
+    G4ThreeVector u = dir.orthogonal().unit();
+    G4ThreeVector v = dir.cross(u);
+    G4double time = track->GetGlobalTime();
+
+    // energy spots
+    G4int nSpots = (G4int)(energy / fgSpotEnergy);
+    if (nSpots < 10) nSpots = 10;
+    if (nSpots > 10000) nSpots = 10000;
+    G4double eSpot = energy / nSpots;
+
+    for (G4int i = 0; i < nSpots; i++)
+    {
+        G4double depth = CLHEP::RandGamma::shoot(a, b) * fRadLength;
+        G4double rc = G4UniformRand() < pCore ? rCore : rTail;
+        G4double q = G4UniformRand();
+        G4double r = rc * std::sqrt(q / (1 - q));
+        G4double phi = twopi * G4UniformRand();
+        G4ThreeVector spot = pos + depth*dir + r*(std::cos(phi)*u + std::sin(phi)*v);
+        Deposit(spot, time + depth/c_light, eSpot);
+    }
+    EndShower();
+}
@@ -14,6 +14,8 @@
 #include "G4Colour.hh"
 #include "G4ios.hh"
 #include "CLHEP/Units/SystemOfUnits.h"
+#include "A2CBOutput.hh"
+#include "A2DetectorConstruction.hh"
 
 using namespace CLHEP;
 
@@ -1085,3 +1087,15 @@ void A2DetCrystalBall::MakeRotationMatrices(){
   
   //if(rot[i]) delete rot[i];
 }
+
+void A2DetCrystalBall::AddOutput(A2CBOutput* out, A2DetectorConstruction* det){
+  //Crystal energies, times and IDs, the energy sum is written to etot
+  A2OutputDetector_t* o=out->AddDetector("CB","nhits",720,det->GetCBThreshold());
+  out->AddCollection(o,"A2SDHitsCBSD");
+  out->AddCollection(o,"A2SDHitsVisCBSD");
+  out->AddColumn(o,"ecryst",kHitEdep,false,GeV);
+  out->AddColumn(o,"tcryst",kHitTime,false,ns);
+  out->AddColumn(o,"icryst",kHitID,true);
+  if(out->GetStorePrimaries()) out->AddColumn(o,"pcryst",kHitParticle,true);
+  out->SetTotalEnergy(o);
+}
@@ -8,6 +8,8 @@
 #include "G4Cons.hh"
 #include "G4SubtractionSolid.hh"
 #include "CLHEP/Units/SystemOfUnits.h"
+#include "A2CBOutput.hh"
+#include "A2DetectorConstruction.hh"
 
 using namespace CLHEP;
 
@@ -580,6 +582,7 @@ void A2DetMWPC::MakeDetector() {
 //Sensitive Detector
 
 void A2DetMWPC::MakeSensitiveDetector(){
+  //100 is only the initial hit capacity of the chambers, it grows if needed
   if(!fMWPCSD1){
     G4SDManager* SDman = G4SDManager::GetSDMpointer();
     fMWPCSD1 = new A2WCSD("A2MWPCSD1", 100);
@@ -607,3 +610,19 @@ void A2DetMWPC::MakeSensitiveDetector(){
   fCHCI2Logic->SetSensitiveDetector(fMWPCSD3);
   fCHCO2Logic->SetSensitiveDetector(fMWPCSD4);
 }
+
+void A2DetMWPC::RegisterOutput(A2CBOutput* out, A2DetectorConstruction* det){
+  //Hit IDs, positions and energies of the four chambers
+  //(not read out if the chambers are only passive material, UseMWPC>=10)
+  if(det->GetUseMWPC()/10!=0){
+    G4cout<<"A2DetMWPC::RegisterOutput() Disabling MWPC readout"<<G4endl;
+    return;
+  }
+  A2OutputDetector_t* o=out->AddDetector("MWPC","nmwpc",400,det->GetMWPCThreshold());
+  for(G4int i=1;i<=4;i++) out->AddCollection(o,G4String("A2WCSDHitsA2MWPCSD")+char('0'+i));
+  out->AddColumn(o,"imwpc",kHitID,true);
+  out->AddColumn(o,"mposx",kHitPosX,false,mm);
+  out->AddColumn(o,"mposy",kHitPosY,false,mm);
+  out->AddColumn(o,"mposz",kHitPosZ,false,mm);
+  out->AddColumn(o,"emwpc",kHitEdep,false,GeV);
+}
@@ -8,6 +8,8 @@
 #include "G4Cons.hh"
 #include "G4SubtractionSolid.hh"
 #include "CLHEP/Units/SystemOfUnits.h"
+#include "A2CBOutput.hh"
+#include "A2DetectorConstruction.hh"
 
 using namespace CLHEP;
 
@@ -259,7 +261,7 @@ void A2DetPID::MakeLightGuide(){
 
 
 void A2DetPID::MakeSupports1(){
-  //c Brass tube at upstream end
+  //c Brass tube at upstream end
   // note only for PID1
   G4Tubs* BRTU=new G4Tubs("BRTU",5.455*cm,5.550*cm,77.5/2*mm,0*deg,360*deg);
   fBRTULogic=new G4LogicalVolume(BRTU,fNistManager->FindOrBuildMaterial("A2_BRASS"),"BRTU");
@@ -332,3 +334,13 @@ void A2DetPID::MakeSupports2(){
 
 
 }
+
+void A2DetPID::AddOutput(A2CBOutput* out, A2DetectorConstruction* det){
+  //Element energies, times and IDs (also used by the 2016 PID)
+  A2OutputDetector_t* o=out->AddDetector("PID","vhits",24,det->GetPIDThreshold());
+  out->AddCollection(o,"A2SDHitsPIDSD");
+  out->AddColumn(o,"eveto",kHitEdep,false,GeV);
+  out->AddColumn(o,"tveto",kHitTime,false,ns);
+  out->AddColumn(o,"iveto",kHitID,true);
+  if(out->GetStorePrimaries()) out->AddColumn(o,"pveto",kHitParticle,true);
+}
@@ -8,6 +8,7 @@
 #include "G4Cons.hh"
 #include "G4SubtractionSolid.hh"
 #include "CLHEP/Units/SystemOfUnits.h"
+#include "A2DetPID.hh"
 
 using namespace CLHEP;
 
@@ -259,3 +260,7 @@ void A2DetPID3::MakeSupports1(){
   fPMTRLogic->SetVisAttributes(SupVisAtt);
 
 }
+
+void A2DetPID3::RegisterOutput(A2CBOutput* out, A2DetectorConstruction* det){
+  A2DetPID::AddOutput(out,det);
+}
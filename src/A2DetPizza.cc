@@ -17,6 +17,8 @@
 #include "A2SD.hh"
 #include "A2VisSD.hh"
 #include "A2Utils.hh"
+#include "A2CBOutput.hh"
+#include "A2DetectorConstruction.hh"
 
 using namespace CLHEP;
 
@@ -365,3 +367,16 @@ G4VPhysicalVolume* A2DetPizza::Construct(G4LogicalVolume* motherLogic)
     return fMyPhysi;
 }
 
+//______________________________________________________________________________
+void A2DetPizza::AddOutput(A2CBOutput* out, A2DetectorConstruction* det)
+{
+    // Declare the output columns of the detector elements. Static, as the
+    // count branch is also written if the detector is not built.
+
+    A2OutputDetector_t* o = out->AddDetector("Pizza", "npiz", 24, det->GetPizzaThreshold());
+    out->AddCollection(o, "A2SDHitsPizzaSD");
+    out->AddCollection(o, "A2SDHitsPizzaVisSD");
+    out->AddColumn(o, "ipiz", kHitID, true);
+    out->AddColumn(o, "epiz", kHitEdep, false, GeV);
+    out->AddColumn(o, "tpiz", kHitTime, false, ns);
+}
@@ -3,6 +3,8 @@
 #include "G4Colour.hh"
 #include "G4SDManager.hh"
 #include "CLHEP/Units/SystemOfUnits.h"
+#include "A2CBOutput.hh"
+#include "A2DetectorConstruction.hh"
 
 using namespace CLHEP;
 
@@ -313,3 +315,23 @@ void  A2DetTAPS::MakeVeto(){
   fVDB2Logic->SetVisAttributes(G4VisAttributes::Invisible);
   fTVETLogic->SetVisAttributes(vbox_visatt);
 }
+
+void A2DetTAPS::AddOutput(A2CBOutput* out, A2DetectorConstruction* det){
+  //Crystal times, energies and IDs (ectapfs is always 0)
+  A2OutputDetector_t* o=out->AddDetector("TAPS","ntaps",512,det->GetTAPSThreshold());
+  out->AddCollection(o,"A2SDHitsTAPSSD");
+  out->AddCollection(o,"A2SDHitsTAPSVisSD");
+  out->AddColumn(o,"tctaps",kHitTime,false,ns);
+  out->AddColumn(o,"ectapfs",kHitNone,false);
+  out->AddColumn(o,"ectapsl",kHitEdep,false,GeV);
+  out->AddColumn(o,"ictaps",kHitID,true);
+  if(out->GetStorePrimaries()) out->AddColumn(o,"pctaps",kHitParticle,true);
+
+  //Veto energies and IDs
+  o=out->AddDetector("TAPS veto","nvtaps",512,det->GetTAPSVetoThreshold());
+  out->AddCollection(o,"A2SDHitsTAPSVSD");
+  out->AddCollection(o,"A2SDHitsTAPSVVisSD");
+  out->AddColumn(o,"evtaps",kHitEdep,false,GeV);
+  out->AddColumn(o,"ivtaps",kHitID,true);
+  if(out->GetStorePrimaries()) out->AddColumn(o,"pvtaps",kHitParticle,true);
+}
@@ -12,6 +12,8 @@
 #include "G4SubtractionSolid.hh"
 #include <fstream>
 #include "CLHEP/Units/SystemOfUnits.h"
+#include "A2CBOutput.hh"
+#include "A2DetectorConstruction.hh"
 //using namespace std;
 using namespace CLHEP;
 
@@ -167,3 +169,16 @@ G4VPhysicalVolume* A2DetTOF::Construct(G4LogicalVolume* MotherLogical){
   G4cout<<"Number of TOF bars made "<<fCounter<<" out of "<<fTotBars<<G4endl;
   return fMyPhysi;
 }
+
+void A2DetTOF::RegisterOutput(A2CBOutput* out, A2DetectorConstruction* det){
+  //Bar IDs, energies, times and positions
+  if(fTotBars<=0) return;
+  A2OutputDetector_t* o=out->AddDetector("TOF","ntof",fTotBars,det->GetTOFThreshold());
+  out->AddCollection(o,"A2SDHitsTOFSD");
+  out->AddColumn(o,"tofi",kHitID,true);
+  out->AddColumn(o,"tofe",kHitEdep,false,GeV);
+  out->AddColumn(o,"toft",kHitTime,false,ns);
+  out->AddColumn(o,"tofx",kHitPosX,false,cm);
+  out->AddColumn(o,"tofy",kHitPosY,false,cm);
+  out->AddColumn(o,"tofz",kHitPosZ,false,cm);
+}
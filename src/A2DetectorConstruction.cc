@@ -15,6 +15,9 @@
 #include "G4SolidStore.hh"
 #include "G4SDManager.hh"
 #include "G4UImanager.hh"
+#include "G4Threading.hh"
+#include "G4RegionStore.hh"
+#include "G4RunManager.hh"
 
 #include "G4VisAttributes.hh"
 #include "G4Colour.hh"
@@ -28,6 +31,11 @@
 #include "A2PolarizedTarget.hh"
 #include "A2DetPID.hh"
 #include "A2DetPID3.hh"
+#include "A2CBShowerModel.hh"
+#include "A2TAPSShowerModel.hh"
+#include "A2ShowerLibrary.hh"
+
+#include <map>
 
 using namespace CLHEP;
 
@@ -52,6 +60,8 @@ A2DetectorConstruction::A2DetectorConstruction(G4String detSet)
   fPID=NULL;
   fMWPC=NULL;
   fTOF=NULL;
+  fCherenkov=NULL;
+  fPizza=NULL;
   fWorldSolid=NULL;
   fWorldLogic=NULL;
   fWorldPhysi=NULL;
@@ -64,6 +74,13 @@ A2DetectorConstruction::A2DetectorConstruction(G4String detSet)
   fTargetRadius=0;
   fTargetZ=0;
   fUseTarget=G4String("NO");
+  fFieldStorage="full";
+  fFieldTrilinear=false;
+  fFieldStepper="default";
+  fFieldMinStep=1.0e-2*mm;
+  fFieldDeltaChord=0;
+  fFieldDeltaOneStep=0;
+  fFieldLocal=false;
   //Default taps settings as for 2003
   fTAPSSetupFile="data/taps.dat";
   fTAPSN=510;
@@ -77,6 +94,15 @@ A2DetectorConstruction::A2DetectorConstruction(G4String detSet)
   // default settings for Pizza detector
   fPizzaZ = A2DetPizza::fgDefaultZPos;
 
+  // readout thresholds (0: write all hits)
+  fCBThreshold = 0;
+  fTAPSThreshold = 0;
+  fTAPSVetoThreshold = 0;
+  fPIDThreshold = 0;
+  fMWPCThreshold = 0;
+  fTOFThreshold = 0;
+  fPizzaThreshold = 0;
+
   //has to be done here in case use new material for target
   DefineMaterials();
 
@@ -240,7 +266,7 @@ G4VPhysicalVolume* A2DetectorConstruction::Construct()
     if(fUseTarget=="Polarized")
     {
       G4cout<<"A2DetectorConstruction::Construct() make the polarised target with "<<fTypeMagneticCoils<<" coils"<<G4endl;
-      (static_cast<A2PolarizedTarget*>(fTarget))->SetMagneticField(fNameFileFieldMap);
+      (static_cast<A2PolarizedTarget*>(fTarget))->SetMagneticField(fNameFileFieldMap, fFieldTrilinear, fFieldStorage);
       (static_cast<A2PolarizedTarget*>(fTarget))->SetMagneticCoils(fTypeMagneticCoils);
     }
     if (fTargetZ)
@@ -262,6 +288,95 @@ G4VPhysicalVolume* A2DetectorConstruction::Construct()
 }
 
 
+void A2DetectorConstruction::ConstructSDandField()
+{
+  //parameterised CB showers (thread local, not needed on the master of
+  //multithreaded runs which does not track)
+  if(A2CBShowerModel::IsEnabled()&&fUseCB&&!A2CBShowerModel::Instance()&&
+     G4RunManager::GetRunManager()->GetRunManagerType()!=G4RunManager::masterRM){
+    G4Region* region=G4RegionStore::GetInstance()->GetRegion("CB",false);
+    if(region) new A2CBShowerModel(region);
+  }
+  //frozen TAPS showers (not while recording a new shower library)
+  if(A2TAPSShowerModel::IsEnabled()&&fUseTAPS&&!A2TAPSShowerModel::Instance()&&!A2ShowerLibrary::IsRecording()&&
+     G4RunManager::GetRunManager()->GetRunManagerType()!=G4RunManager::masterRM){
+    G4Region* region=G4RegionStore::GetInstance()->GetRegion("TAPS",false);
+    if(region) new A2TAPSShowerModel(region);
+  }
+
+  //target magnetic field (the field managers are thread local, the master
+  //of multithreaded runs does not track)
+  if(fUseTarget=="Polarized"&&fTarget&&
+     G4RunManager::GetRunManager()->GetRunManagerType()!=G4RunManager::masterRM) AttachTargetMagneticField();
+
+  //The sensitive detectors are thread local.
+  //In sequential mode and on the master they were created in Construct(),
+  //worker threads get their own copies of the master detectors here
+  if(!G4Threading::IsWorkerThread()) return;
+
+  std::map<G4VSensitiveDetector*,G4VSensitiveDetector*> clones;
+  G4LogicalVolumeStore* lvStore=G4LogicalVolumeStore::GetInstance();
+  for(size_t i=0;i<lvStore->size();i++){
+    G4LogicalVolume* lv=(*lvStore)[i];
+    G4VSensitiveDetector* masterSD=lv->GetMasterSensitiveDetector();
+    if(!masterSD) continue;
+    G4VSensitiveDetector*& sd=clones[masterSD];
+    if(!sd){
+      sd=masterSD->Clone();
+      G4SDManager::GetSDMpointer()->AddNewDetector(sd);
+    }
+    lv->SetSensitiveDetector(sd);
+  }
+}
+
+void A2DetectorConstruction::RegisterOutput(A2CBOutput* out)
+{
+  //Every built detector declares its own output columns.
+  //The count branches of the cbsim detectors are written even if they are
+  //not built. The detectors are only read here, so this is also called by
+  //the worker threads of multithreaded runs.
+  if(fCrystalBall) fCrystalBall->RegisterOutput(out,this);
+  else A2DetCrystalBall::AddOutput(out,this);
+  if(fTAPS) fTAPS->RegisterOutput(out,this);
+  else A2DetTAPS::AddOutput(out,this);
+  if(fPID) fPID->RegisterOutput(out,this);
+  else A2DetPID::AddOutput(out,this);
+  if(fMWPC) fMWPC->RegisterOutput(out,this);
+  if(fTOF) fTOF->RegisterOutput(out,this);
+  if(fCherenkov) fCherenkov->RegisterOutput(out,this);
+  if(fPizza) fPizza->RegisterOutput(out,this);
+  else A2DetPizza::AddOutput(out,this);
+}
+
+void A2DetectorConstruction::AttachTargetMagneticField()
+{
+  //attach the target field to the global field manager of this thread or
+  //to a local field manager of the target, PID and MWPC volumes
+  A2PolarizedTarget* target=static_cast<A2PolarizedTarget*>(fTarget);
+  target->SetFieldIntegration(fFieldStepper,fFieldMinStep,fFieldDeltaChord,fFieldDeltaOneStep);
+  std::vector<G4LogicalVolume*> volumes;
+  if(fFieldLocal){
+    volumes.push_back(fTarget->GetLogic());
+    if(fUsePID&&fPID) volumes.push_back(fPID->GetLogic());
+    if(fUseMWPC&&fMWPC) volumes.push_back(fMWPC->GetLogic());
+  }
+  target->AttachMagneticField(volumes);
+}
+
+void A2DetectorConstruction::BenchmarkTargetMagneticField(G4int nCalls)
+{
+  //time the field map look-ups of the polarised target
+  A2MagneticField* field=0;
+  if(fUseTarget=="Polarized"&&fTarget)
+    field=(static_cast<A2PolarizedTarget*>(fTarget))->GetMagneticField();
+  if(!field){
+    G4cout<<"A2DetectorConstruction::BenchmarkTargetMagneticField() No target magnetic field map loaded"<<G4endl;
+    return;
+  }
+  field->Benchmark(nCalls);
+}
+
+
 
 
 
@@ -271,6 +386,8 @@ void A2DetectorConstruction::UpdateGeometry()
 {
 
   G4RunManager::GetRunManager()->DefineWorldVolume(Construct());
+  //the field of the rebuilt target (otherwise attached in ConstructSDandField())
+  if(fUseTarget=="Polarized"&&fTarget) AttachTargetMagneticField();
 }
 
 
@@ -11,6 +11,8 @@
 #include "G4ThreeVector.hh"
 #include "G4Version.hh"
 
+#include <sstream>
+
 #if G4VERSION_NUMBER >= 1030
 G4ApplicationState cmdState = G4State_Init;
 #else
@@ -91,9 +93,72 @@ A2DetectorMessenger::A2DetectorMessenger(
   // Target magnetic field map
   fTargetMagneticFieldCmd = new G4UIcmdWithAString("/A2/det/setTargetMagneticFieldMap",this);
   fTargetMagneticFieldCmd->SetGuidance("Set path/name of the target magnetic field map file");
+  fTargetMagneticFieldCmd->SetGuidance("followed by the optional storage of the map in memory:");
+  fTargetMagneticFieldCmd->SetGuidance("  full  : 3D map of doubles (default)");
+  fTargetMagneticFieldCmd->SetGuidance("  float : 3D map of floats");
+  fTargetMagneticFieldCmd->SetGuidance("  axial : axially symmetric (r,z) map");
+  fTargetMagneticFieldCmd->SetGuidance("  auto  : axial if the map is axially symmetric, otherwise full");
   fTargetMagneticFieldCmd->SetParameterName("TargetMagneticField",false);
   fTargetMagneticFieldCmd->AvailableForStates(cmdState,G4State_Idle);
 
+  fTargetFieldInterpolationCmd = new G4UIcmdWithAString("/A2/det/setTargetMagneticFieldInterpolation",this);
+  fTargetFieldInterpolationCmd->SetGuidance("Set the interpolation of the target magnetic field map");
+  fTargetFieldInterpolationCmd->SetGuidance("  nearest   : value of the nearest grid point (default)");
+  fTargetFieldInterpolationCmd->SetGuidance("  trilinear : trilinear interpolation between the grid points");
+  fTargetFieldInterpolationCmd->SetParameterName("TargetFieldInterpolation",false);
+  fTargetFieldInterpolationCmd->SetCandidates("nearest trilinear");
+  fTargetFieldInterpolationCmd->AvailableForStates(cmdState,G4State_Idle);
+
+  fTargetFieldBenchmarkCmd = new G4UIcmdWithAnInteger("/A2/det/benchmarkTargetMagneticField",this);
+  fTargetFieldBenchmarkCmd->SetGuidance("Time the given number of target magnetic field look-ups and print the calls per second");
+  fTargetFieldBenchmarkCmd->SetParameterName("NCalls",false);
+  fTargetFieldBenchmarkCmd->SetRange("NCalls>0");
+  fTargetFieldBenchmarkCmd->AvailableForStates(G4State_Idle);
+
+  fTargetFieldStepperCmd = new G4UIcmdWithAString("/A2/det/setTargetMagneticFieldStepper",this);
+  fTargetFieldStepperCmd->SetGuidance("Set the stepper integrating the tracks in the target magnetic field");
+  fTargetFieldStepperCmd->SetGuidance("(default: Geant4 default stepper of the chord finder)");
+  fTargetFieldStepperCmd->SetParameterName("TargetFieldStepper",false);
+#if G4VERSION_NUMBER >= 1040
+  fTargetFieldStepperCmd->SetCandidates("default ClassicalRK4 SimpleRunge CashKarpRKF45 NystromRK4 DormandPrince745 "
+                                        "HelixExplicitEuler HelixImplicitEuler HelixSimpleRunge HelixMixed");
+#else
+  fTargetFieldStepperCmd->SetCandidates("default ClassicalRK4 SimpleRunge CashKarpRKF45 NystromRK4 "
+                                        "HelixExplicitEuler HelixImplicitEuler HelixSimpleRunge HelixMixed");
+#endif
+  fTargetFieldStepperCmd->AvailableForStates(cmdState,G4State_Idle);
+
+  fTargetFieldMinStepCmd = new G4UIcmdWithADoubleAndUnit("/A2/det/setTargetMagneticFieldMinStep",this);
+  fTargetFieldMinStepCmd->SetGuidance("Set the minimum step of the chord finder in the target magnetic field");
+  fTargetFieldMinStepCmd->SetParameterName("TargetFieldMinStep",false);
+  fTargetFieldMinStepCmd->SetRange("TargetFieldMinStep>0");
+  fTargetFieldMinStepCmd->SetUnitCategory("Length");
+  fTargetFieldMinStepCmd->AvailableForStates(cmdState,G4State_Idle);
+
+  fTargetFieldDeltaChordCmd = new G4UIcmdWithADoubleAndUnit("/A2/det/setTargetMagneticFieldDeltaChord",this);
+  fTargetFieldDeltaChordCmd->SetGuidance("Set the maximum miss distance between chord and track in the target magnetic field");
+  fTargetFieldDeltaChordCmd->SetGuidance("(0: Geant4 default)");
+  fTargetFieldDeltaChordCmd->SetParameterName("TargetFieldDeltaChord",false);
+  fTargetFieldDeltaChordCmd->SetRange("TargetFieldDeltaChord>=0");
+  fTargetFieldDeltaChordCmd->SetUnitCategory("Length");
+  fTargetFieldDeltaChordCmd->AvailableForStates(cmdState,G4State_Idle);
+
+  fTargetFieldDeltaOneStepCmd = new G4UIcmdWithADoubleAndUnit("/A2/det/setTargetMagneticFieldDeltaOneStep",this);
+  fTargetFieldDeltaOneStepCmd->SetGuidance("Set the position accuracy of one step in the target magnetic field");
+  fTargetFieldDeltaOneStepCmd->SetGuidance("(0: Geant4 default)");
+  fTargetFieldDeltaOneStepCmd->SetParameterName("TargetFieldDeltaOneStep",false);
+  fTargetFieldDeltaOneStepCmd->SetRange("TargetFieldDeltaOneStep>=0");
+  fTargetFieldDeltaOneStepCmd->SetUnitCategory("Length");
+  fTargetFieldDeltaOneStepCmd->AvailableForStates(cmdState,G4State_Idle);
+
+  fTargetFieldVolumesCmd = new G4UIcmdWithAString("/A2/det/setTargetMagneticFieldVolumes",this);
+  fTargetFieldVolumesCmd->SetGuidance("Set the volumes with the target magnetic field");
+  fTargetFieldVolumesCmd->SetGuidance("  global : everywhere (global field manager, default)");
+  fTargetFieldVolumesCmd->SetGuidance("  local  : only in the target, PID and MWPC volumes (local field manager)");
+  fTargetFieldVolumesCmd->SetParameterName("TargetFieldVolumes",false);
+  fTargetFieldVolumesCmd->SetCandidates("global local");
+  fTargetFieldVolumesCmd->AvailableForStates(cmdState,G4State_Idle);
+
   fHemiGapCmd = new G4UIcmdWith3VectorAndUnit("/A2/det/setHemiGap",this);
   fHemiGapCmd->SetGuidance("Set air gap between each hemisphere and equator");
   fHemiGapCmd->SetParameterName("HemiGapUp","HemiGapDown","HemiGapNA",false);
@@ -172,6 +237,55 @@ A2DetectorMessenger::A2DetectorMessenger(
   fPizzaZCmd->SetParameterName("PizzaZ",false);
   fPizzaZCmd->SetUnitCategory("Length");
   fPizzaZCmd->AvailableForStates(cmdState,G4State_Idle);
+
+  fCBThresholdCmd = new G4UIcmdWithADoubleAndUnit("/A2/det/setCBThreshold",this);
+  fCBThresholdCmd->SetGuidance("Set the readout threshold of the Crystal Ball (hits below are not written)");
+  fCBThresholdCmd->SetParameterName("CBThreshold",false);
+  fCBThresholdCmd->SetRange("CBThreshold>=0");
+  fCBThresholdCmd->SetUnitCategory("Energy");
+  fCBThresholdCmd->AvailableForStates(cmdState,G4State_Idle);
+
+  fTAPSThresholdCmd = new G4UIcmdWithADoubleAndUnit("/A2/det/setTAPSThreshold",this);
+  fTAPSThresholdCmd->SetGuidance("Set the readout threshold of the TAPS (hits below are not written)");
+  fTAPSThresholdCmd->SetParameterName("TAPSThreshold",false);
+  fTAPSThresholdCmd->SetRange("TAPSThreshold>=0");
+  fTAPSThresholdCmd->SetUnitCategory("Energy");
+  fTAPSThresholdCmd->AvailableForStates(cmdState,G4State_Idle);
+
+  fTAPSVetoThresholdCmd = new G4UIcmdWithADoubleAndUnit("/A2/det/setTAPSVetoThreshold",this);
+  fTAPSVetoThresholdCmd->SetGuidance("Set the readout threshold of the TAPS veto (hits below are not written)");
+  fTAPSVetoThresholdCmd->SetParameterName("TAPSVetoThreshold",false);
+  fTAPSVetoThresholdCmd->SetRange("TAPSVetoThreshold>=0");
+  fTAPSVetoThresholdCmd->SetUnitCategory("Energy");
+  fTAPSVetoThresholdCmd->AvailableForStates(cmdState,G4State_Idle);
+
+  fPIDThresholdCmd = new G4UIcmdWithADoubleAndUnit("/A2/det/setPIDThreshold",this);
+  fPIDThresholdCmd->SetGuidance("Set the readout threshold of the PID (hits below are not written)");
+  fPIDThresholdCmd->SetParameterName("PIDThreshold",false);
+  fPIDThresholdCmd->SetRange("PIDThreshold>=0");
+  fPIDThresholdCmd->SetUnitCategory("Energy");
+  fPIDThresholdCmd->AvailableForStates(cmdState,G4State_Idle);
+
+  fMWPCThresholdCmd = new G4UIcmdWithADoubleAndUnit("/A2/det/setMWPCThreshold",this);
+  fMWPCThresholdCmd->SetGuidance("Set the readout threshold of the MWPC (hits below are not written)");
+  fMWPCThresholdCmd->SetParameterName("MWPCThreshold",false);
+  fMWPCThresholdCmd->SetRange("MWPCThreshold>=0");
+  fMWPCThresholdCmd->SetUnitCategory("Energy");
+  fMWPCThresholdCmd->AvailableForStates(cmdState,G4State_Idle);
+
+  fTOFThresholdCmd = new G4UIcmdWithADoubleAndUnit("/A2/det/setTOFThreshold",this);
+  fTOFThresholdCmd->SetGuidance("Set the readout threshold of the TOF (hits below are not written)");
+  fTOFThresholdCmd->SetParameterName("TOFThreshold",false);
+  fTOFThresholdCmd->SetRange("TOFThreshold>=0");
+  fTOFThresholdCmd->SetUnitCategory("Energy");
+  fTOFThresholdCmd->AvailableForStates(cmdState,G4State_Idle);
+
+  fPizzaThresholdCmd = new G4UIcmdWithADoubleAndUnit("/A2/det/setPizzaThreshold",this);
+  fPizzaThresholdCmd->SetGuidance("Set the readout threshold of the Pizza detector (hits below are not written)");
+  fPizzaThresholdCmd->SetParameterName("PizzaThreshold",false);
+  fPizzaThresholdCmd->SetRange("PizzaThreshold>=0");
+  fPizzaThresholdCmd->SetUnitCategory("Energy");
+  fPizzaThresholdCmd->AvailableForStates(cmdState,G4State_Idle);
 }
 
 
@@ -201,8 +315,22 @@ A2DetectorMessenger::~A2DetectorMessenger()
   delete fTargetRadiusCmd;
   delete fTargetZCmd;
   delete fTargetMagneticFieldCmd;
+  delete fTargetFieldInterpolationCmd;
+  delete fTargetFieldBenchmarkCmd;
+  delete fTargetFieldStepperCmd;
+  delete fTargetFieldMinStepCmd;
+  delete fTargetFieldDeltaChordCmd;
+  delete fTargetFieldDeltaOneStepCmd;
+  delete fTargetFieldVolumesCmd;
   delete fHemiGapCmd;
   delete fCBCrystGeoCmd;
+  delete fCBThresholdCmd;
+  delete fTAPSThresholdCmd;
+  delete fTAPSVetoThresholdCmd;
+  delete fPIDThresholdCmd;
+  delete fMWPCThresholdCmd;
+  delete fTOFThresholdCmd;
+  delete fPizzaThresholdCmd;
  }
 
 
@@ -256,7 +384,40 @@ void A2DetectorMessenger::SetNewValue(G4UIcommand* command,G4String newValue)
 
   // Target magnetic field map
   if( command == fTargetMagneticFieldCmd )
-    { fA2Detector->SetTargetMagneticFieldMap(newValue); }
+    {
+      // map file and optional storage
+      std::istringstream is(newValue);
+      G4String name, storage = "full";
+      is >> name >> storage;
+      if(storage != "full" && storage != "float" && storage != "axial" && storage != "auto")
+        G4cout << "A2DetectorMessenger::SetNewValue() Unknown field map storage " << storage << G4endl;
+      else
+        {
+          fA2Detector->SetTargetMagneticFieldMap(name);
+          fA2Detector->SetTargetMagneticFieldStorage(storage);
+        }
+    }
+
+  if( command == fTargetFieldInterpolationCmd )
+    { fA2Detector->SetTargetMagneticFieldTrilinear(newValue == "trilinear"); }
+
+  if( command == fTargetFieldBenchmarkCmd )
+    { fA2Detector->BenchmarkTargetMagneticField(fTargetFieldBenchmarkCmd->GetNewIntValue(newValue)); }
+
+  if( command == fTargetFieldStepperCmd )
+    { fA2Detector->SetTargetMagneticFieldStepper(newValue); }
+
+  if( command == fTargetFieldMinStepCmd )
+    { fA2Detector->SetTargetMagneticFieldMinStep(fTargetFieldMinStepCmd->GetNewDoubleValue(newValue)); }
+
+  if( command == fTargetFieldDeltaChordCmd )
+    { fA2Detector->SetTargetMagneticFieldDeltaChord(fTargetFieldDeltaChordCmd->GetNewDoubleValue(newValue)); }
+
+  if( command == fTargetFieldDeltaOneStepCmd )
+    { fA2Detector->SetTargetMagneticFieldDeltaOneStep(fTargetFieldDeltaOneStepCmd->GetNewDoubleValue(newValue)); }
+
+  if( command == fTargetFieldVolumesCmd )
+    { fA2Detector->SetTargetMagneticFieldLocal(newValue == "local"); }
 
    if( command == fHemiGapCmd )
     { fA2Detector->SetHemiGap(fHemiGapCmd->GetNew3VectorValue(newValue));}
@@ -288,6 +449,27 @@ void A2DetectorMessenger::SetNewValue(G4UIcommand* command,G4String newValue)
   
   if( command == fUseTOFCmd )
     { fA2Detector->SetUseTOF(fUseTOFCmd->GetNewIntValue(newValue));}
+
+  if( command == fCBThresholdCmd )
+    { fA2Detector->SetCBThreshold(fCBThresholdCmd->GetNewDoubleValue(newValue));}
+
+  if( command == fTAPSThresholdCmd )
+    { fA2Detector->SetTAPSThreshold(fTAPSThresholdCmd->GetNewDoubleValue(newValue));}
+
+  if( command == fTAPSVetoThresholdCmd )
+    { fA2Detector->SetTAPSVetoThreshold(fTAPSVetoThresholdCmd->GetNewDoubleValue(newValue));}
+
+  if( command == fPIDThresholdCmd )
+    { fA2Detector->SetPIDThreshold(fPIDThresholdCmd->GetNewDoubleValue(newValue));}
+
+  if( command == fMWPCThresholdCmd )
+    { fA2Detector->SetMWPCThreshold(fMWPCThresholdCmd->GetNewDoubleValue(newValue));}
+
+  if( command == fTOFThresholdCmd )
+    { fA2Detector->SetTOFThreshold(fTOFThresholdCmd->GetNewDoubleValue(newValue));}
+
+  if( command == fPizzaThresholdCmd )
+    { fA2Detector->SetPizzaThreshold(fPizzaThresholdCmd->GetNewDoubleValue(newValue));}
   
  }
 
@@ -7,6 +7,9 @@
 #include "A2EventActionMessenger.hh"
 #include "A2Version.hh"
 #include "A2FileGenerator.hh"
+#include "A2ShowerLibrary.hh"
+#include "A2Profiler.hh"
+#include "A2EventStats.hh"
 
 #include "G4Event.hh"
 #include "G4TrajectoryContainer.hh"
@@ -17,17 +20,36 @@
 #include "G4UImanager.hh"
 #include "CLHEP/Units/SystemOfUnits.h"
 #include "G4Version.hh"
+#include "G4Threading.hh"
+#include "G4AutoLock.hh"
+#include "G4SDManager.hh"
 
 #include "Randomize.hh"
 #include "TString.h"
 #include "TSystem.h"
 #include "TStopwatch.h"
+#include "TChain.h"
+#include "TMath.h"
+#include "RVersion.h"
 #include <iomanip>
 #include <sys/utsname.h>
+#include <sys/resource.h>
 #include <fstream>
+#include <chrono>
 
 using namespace CLHEP;
 
+std::vector<TString> A2EventAction::fgThreadFiles;
+Double_t A2EventAction::fgThreadOutTime=0;
+Double_t A2EventAction::fgThreadTrackTime=0;
+Double_t A2EventAction::fgThreadTrackTimeMax=0;
+std::map<G4String,Long64_t> A2EventAction::fgSuppressed;
+namespace {
+  G4Mutex threadFilesMutex = G4MUTEX_INITIALIZER;
+  //(initialized when the program is loaded)
+  const std::chrono::steady_clock::time_point programStart = std::chrono::steady_clock::now();
+}
+
 A2EventAction::A2EventAction(A2RunAction* run, A2PrimaryGeneratorAction* pga,
                              int argc, char** argv, const char* detSetup)
 {
@@ -37,21 +59,33 @@ A2EventAction::A2EventAction(A2RunAction* run, A2PrimaryGeneratorAction* pga,
   fprintModulo = 1;
   fEventRate = 0;
   fReqEvents = 0;
+  fNEvtThread = 0;
+  fTrackTime = 0;
   feventMessenger = new A2EventActionMessenger(this);
   fIsInteractive=1;
-  // hits collections
-  fCBCollID = -1;
   fHitDrawOpt="edep";
 
   fOutFile=NULL;
   fOutTree=NULL;
   fOutFileName=TString("");
+  fIsMaster=false;
 
   fprintModulo=1000;
   fTimer = new TStopwatch();
+  fOutTimer = new TStopwatch();
+  fCompAlgo="default";
+  fCompLevel=-1;
+  fBasketSize=64000;
+  fAutoFlush=0;
+  fAutoSave=0;
+  fAsyncDepth=0;
+  fWriterTime=0;
+  fNEvtRun=0;
+  fInitTime=-1;
   fCBOut=NULL;
   fOverwriteFile=false;
   fStorePrimaries=true;
+  fStoreEventStats=false;
   for (int i = 0; i < argc; i++)
   {
     fInvokeCmd += argv[i];
@@ -67,13 +101,15 @@ A2EventAction::~A2EventAction()
 {
   delete feventMessenger;
   if (fTimer) delete fTimer;
+  if (fOutTimer) delete fOutTimer;
 }
 
 
 
 void A2EventAction::BeginOfEventAction(const G4Event* evt)
 {
-  if (evt->GetEventID() == 0) fTimer->Start();
+  if (fNEvtThread++ == 0) fTimer->Start();
+  A2EventStats::Instance()->BeginEvent();
   if (fPGA->GetMode() == EPGA_FILE && evt->GetEventID() == fReqEvents - 1)
   {
     FormatTimeSec(fTimer->RealTime(), fDuration);
@@ -85,6 +121,9 @@ void A2EventAction::BeginOfEventAction(const G4Event* evt)
 void A2EventAction::EndOfEventAction(const G4Event* evt)
 {
   G4int evtNb = evt->GetEventID();
+  //wall time, steps, tracks and memory of this event
+  A2EventStats* stats = A2EventStats::Instance();
+  stats->EndEvent(evt);
   if (evtNb && evtNb % fprintModulo == 0)
   {
     //CLHEP::HepRandom::showEngineStatus();
@@ -109,40 +148,40 @@ void A2EventAction::EndOfEventAction(const G4Event* evt)
   //In montecarlo mode
   //write to the output ntuple if it exists
   //if not need to set file via /A2/event/setOutputFile XXX.root
-  if(fCBOut){
+  //(events aborted by the generator, e.g. beyond the input file, are not written)
+  if(fCBOut&&!evt->IsAborted()){
+    fCBOut->SetEventID(evtNb);
     fCBOut->WriteHit(HCE);
     fCBOut->WriteGenInput();
-    fCBOut->GetTree()->Fill();
+    if(fStoreEventStats)
+      fCBOut->SetEventStats(stats->GetValue(A2EventStats::kWallTime),stats->GetValue(A2EventStats::kSteps),
+                            stats->GetValue(A2EventStats::kTracks),stats->GetValue(A2EventStats::kRSS));
+    fOutTimer->Start(kFALSE);
+    fCBOut->Fill();
+    fOutTimer->Stop();
   }
 
   //Draw hits for interactive mode
   //Not for CB will change colour of each crystal hit
   //Currently all of TAPS and PID will change colour
   else if(fIsInteractive==1&&HCE){
-    G4int CollSize=HCE->GetNumberOfCollections();
-    G4int hci=0;
-    //G4cout<<CollSize<<G4endl;
-    for(G4int i=0;i<CollSize;i++){
-      //Get the ball hit info to be written to output
-      A2VisHitsCollection* hc;
-    //Look for the hits collections with entries 
-      while(!(hc=static_cast<A2VisHitsCollection*>(HCE->GetHC(hci++))));
-      //G4cout<<hc->GetName()<<G4endl;
-      //if(!hc)continue; //no hits in that detector
+    //collection IDs are resolved at the start of the run
+    for(size_t i=0;i<fVisCollIDs.size();i++){
+      A2VisHitsCollection* hc=static_cast<A2VisHitsCollection*>(HCE->GetHC(fVisCollIDs[i]));
+      if(!hc)continue; //no hits in that detector
       G4int hc_nhits=hc->entries();
-      //      if(hc->GetName()=="A2SDHitsVisCBSD"){
-      if(hc->GetName().contains("Vis")){
-	//	G4cout<<hc_nhits <<" hits"<<G4endl;
-	for(G4int ii=0;ii<hc_nhits;ii++){
-	  A2VisHit* hit=static_cast<A2VisHit*>(hc->GetHit(ii));
-	  // G4cout<<"Got hit "<<hit<<G4endl;
-	  hit->Draw(1*MeV,fHitDrawOpt);
-	  
-	}
-	
+      for(G4int ii=0;ii<hc_nhits;ii++){
+	A2VisHit* hit=static_cast<A2VisHit*>(hc->GetHit(ii));
+	hit->Draw(1*MeV,fHitDrawOpt);
       }
     }
   } 
+
+  //heap allocation statistics of the hit arena
+  A2HitArena::Instance()->EndOfEvent();
+
+  //add the shower of this event to the recorded shower library
+  if(A2ShowerLibrary::IsRecording()) A2ShowerLibrary::EndOfEvent();
   
 
 
@@ -196,6 +235,8 @@ void A2EventAction::EndOfEventAction(const G4Event* evt)
 }  
 
 G4int A2EventAction::PrepareOutput(){
+  fNEvtThread=0;
+  if(fInitTime<0) fInitTime=std::chrono::duration<Double_t>(std::chrono::steady_clock::now()-programStart).count();
   //If no filename don't save output
   //  fOutFileName=TString("test.root");
   if(fOutFileName==TString("")) {
@@ -204,6 +245,84 @@ G4int A2EventAction::PrepareOutput(){
     G4cout<<"/A2/event/SetOutputFile XXX.root"<<G4endl;
     return 0;
   }
+
+  if(G4Threading::IsWorkerThread()){
+    //worker threads write to a temporary file XXX_t#.root which is
+    //merged into the final output file by the master at the end of the run
+    TString threadFileName(fOutFileName);
+    TString threadTag=TString::Format("_t%d",G4Threading::G4GetThreadId());
+    if(threadFileName.EndsWith(".root")) threadFileName.Insert(threadFileName.Length()-5,threadTag);
+    else threadFileName+=threadTag;
+    fOutFile=new TFile(threadFileName,"RECREATE");
+    if(!fOutFile->IsOpen()){
+      G4cout<<"A2EventAction::PrepareOutput() Could not open thread output file "<<threadFileName<<G4endl;
+      exit(1);
+    }
+    G4AutoLock lock(&threadFilesMutex);
+    fgThreadFiles.push_back(threadFileName);
+  }
+  else{
+    OpenOutputFile();
+    fgSuppressed.clear();
+  }
+  SetCompression(fOutFile);
+  fOutTimer->Reset();
+
+  TDatime date;
+  fStartTime = date.AsString();
+
+  //the master only merges the output of the worker threads
+  if(fIsMaster){
+    fgThreadFiles.clear();
+    fgThreadOutTime=0;
+    fgThreadTrackTime=0;
+    fgThreadTrackTimeMax=0;
+    fTimer->Start();
+    return 1;
+  }
+
+  //Create output tree
+  //This is curently made in the same format as the cbsim output
+  fCBOut=new A2CBOutput();
+  fCBOut->SetFile(fOutFile);
+  fCBOut->SetStorePrimaries(fStorePrimaries);
+  fCBOut->SetStoreEventID(G4Threading::IsWorkerThread());
+  fCBOut->SetStoreEventStats(fStoreEventStats);
+  fCBOut->SetBasketSize(fBasketSize);
+  if(fAutoFlush) fCBOut->SetAutoFlush(fAutoFlush);
+  if(fAutoSave) fCBOut->SetAutoSave(fAutoSave);
+  fCBOut->SetBranches();
+  if(fAsyncDepth>0) fCBOut->StartWriter(fAsyncDepth);
+  return 1;
+}
+void A2EventAction::ResolveCollectionIDs(){
+  //Look up the hits collections once per run (called at BeginOfRunAction)
+  //Visualisation collections of detectors which are not built are skipped
+  const char* visColls[]={"A2SDHitsVisCBSD","A2SDHitsTAPSVisSD","A2SDHitsTAPSVVisSD","A2SDHitsPizzaVisSD"};
+  G4SDManager* SDman=G4SDManager::GetSDMpointer();
+  fVisCollIDs.clear();
+  for(size_t i=0;i<sizeof(visColls)/sizeof(visColls[0]);i++){
+    G4int id=SDman->GetCollectionID(visColls[i]);
+    if(id>=0) fVisCollIDs.push_back(id);
+  }
+  if(fCBOut) fCBOut->ResolveCollectionIDs();
+}
+void A2EventAction::SetCompression(TFile* f){
+  //Apply the compression settings to the output file f
+  //ROOT algorithm codes: 1 zlib, 2 lzma, 4 lz4 (ROOT>=6.10), 5 zstd (ROOT>=6.20)
+  if(fCompAlgo=="zlib") f->SetCompressionAlgorithm(1);
+  else if(fCompAlgo=="lzma") f->SetCompressionAlgorithm(2);
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,10,0)
+  else if(fCompAlgo=="lz4") f->SetCompressionAlgorithm(4);
+#endif
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,20,0)
+  else if(fCompAlgo=="zstd") f->SetCompressionAlgorithm(5);
+#endif
+  else if(fCompAlgo!="default")
+    G4cout<<"A2EventAction::SetCompression() Compression algorithm "<<fCompAlgo<<" is not supported by this ROOT version, using the default"<<G4endl;
+  if(fCompLevel>=0) f->SetCompressionLevel(fCompLevel);
+}
+void A2EventAction::OpenOutputFile(){
   //if filename try to open the file
   fOutFile=new TFile(fOutFileName,"CREATE");
   //if file aready exists make a new name by adding XXXA2copy#.root
@@ -248,22 +367,51 @@ G4int A2EventAction::PrepareOutput(){
   //   }
   // }
   G4cout<<"A2EventAction::PrepareOutput() Output will be written to "<<fOutFileName<<G4endl;
-
-  TDatime date;
-  fStartTime = date.AsString();
-
-  //Create output tree
-  //This is curently made in the same format as the cbsim output
-  fCBOut=new A2CBOutput();
-  fCBOut->SetFile(fOutFile);
-  fCBOut->SetStorePrimaries(fStorePrimaries);
-  fCBOut->SetBranches();
-  return 1;
 }
 void  A2EventAction::CloseOutput(){
-  if(!fCBOut) return;
-  fCBOut->WriteTree();
-  delete fCBOut;
+  if(fIsMaster){
+    if(!fOutFile) return;
+    MergeThreadOutput();
+    FormatTimeSec(fTimer->RealTime(), fDuration);
+    //(events processed by all threads, fReqEvents is not known for runs started by macros)
+    if(fTimer->RealTime()>0) fEventRate=fNEvtRun/fTimer->RealTime();
+  }
+  else{
+    if(!fCBOut) return;
+    //time in the event loop (started with the first event) not spent filling the output
+    fTrackTime=0;
+    if(fNEvtThread>0){
+      fTrackTime=TMath::Max(0.,fTimer->RealTime()-fOutTimer->RealTime());
+      fTimer->Continue();
+    }
+    fOutTimer->Start(kFALSE);
+    fCBOut->StopWriter();
+    fCBOut->WriteTree();
+    fOutTimer->Stop();
+    fWriterTime=fCBOut->GetWriterTime();
+    {
+      G4AutoLock lock(&threadFilesMutex);
+      const std::vector<A2OutputDetector_t*>& dets=fCBOut->GetDetectors();
+      for(size_t i=0;i<dets.size();i++)
+        if(dets[i]->fThreshold>0) fgSuppressed[dets[i]->fName]+=dets[i]->fNSuppressed;
+      if(G4Threading::IsWorkerThread()){
+        fgThreadOutTime+=fOutTimer->RealTime()+fWriterTime;
+        fgThreadTrackTime+=fTrackTime;
+        fgThreadTrackTimeMax=TMath::Max(fgThreadTrackTimeMax,fTrackTime);
+      }
+    }
+    delete fCBOut;
+    fCBOut=NULL;
+  }
+
+  //output statistics (uncompressed and compressed size of the event tree)
+  Double_t outTime=fIsMaster ? fgThreadOutTime : fOutTimer->RealTime()+fWriterTime;
+  Double_t totBytes=0, zipBytes=0;
+  TTree* outTree=static_cast<TTree*>(fOutFile->Get("h12"));
+  if(outTree){
+    totBytes=outTree->GetTotBytes();
+    zipBytes=outTree->GetZipBytes();
+  }
 
   // write metadata
 #if defined(__clang__)
@@ -346,13 +494,116 @@ void  A2EventAction::CloseOutput(){
               fStartTime.Data(),
               date.AsString(),
               fDuration.Data(),
-              fReqEvents,
+              fNEvtRun,
               fEventRate
               ).Data());
+  if(fIsMaster){
+    TString title(meta.GetTitle());
+    title+=TString::Format("\n       Worker threads     : %d",(G4int)fgThreadFiles.size());
+    title+=TString::Format("\n       Thread tracking    : %.1f s summed, %.1f s slowest thread",
+                           fgThreadTrackTime,fgThreadTrackTimeMax);
+    meta.SetTitle(title);
+  }
+  TString ioInfo=TString::Format("\n"
+              "       Compression        : %s (algorithm %d, level %d)\n"
+              "       Output size        : %.2f MB (%.2f MB uncompressed)\n"
+              "       Compression ratio  : %.2f\n"
+              "       Output write rate  : %.2f MB/s (uncompressed, %.1f s filling/writing)",
+              fCompAlgo.c_str(),
+              fOutFile->GetCompressionAlgorithm(),
+              fOutFile->GetCompressionLevel(),
+              zipBytes/1024./1024.,
+              totBytes/1024./1024.,
+              zipBytes>0 ? totBytes/zipBytes : 0.,
+              outTime>0 ? totBytes/1024./1024./outTime : 0.,
+              outTime);
+  meta.SetTitle(TString(meta.GetTitle())+ioInfo);
+  //workers only write their own file, the totals are reported by the master
+  if(!G4Threading::IsWorkerThread()&&!fgSuppressed.empty()){
+    TString supp;
+    for(std::map<G4String,Long64_t>::const_iterator it=fgSuppressed.begin();it!=fgSuppressed.end();++it){
+      if(supp!="") supp+=", ";
+      supp+=TString::Format("%s %lld",it->first.c_str(),it->second);
+    }
+    G4cout<<"A2EventAction::CloseOutput() Hits below the readout thresholds: "<<supp<<G4endl;
+    meta.SetTitle(TString(meta.GetTitle())+"\n       Suppressed hits    : "+supp);
+  }
+  //per-event statistics of all threads
+  if(!G4Threading::IsWorkerThread()) meta.SetTitle(TString(meta.GetTitle())+A2EventStats::GetSummary());
   meta.Write();
+  if(!G4Threading::IsWorkerThread()) A2EventStats::WriteHistograms();
+
+  //tracking profile of all threads
+  if(!G4Threading::IsWorkerThread()&&A2Profiler::IsEnabled()) A2Profiler::WriteHistogram();
+
+  //benchmark report
+  //(the tracking time is the time in the event loop not spent on output,
+  // in multithreaded runs the time of the slowest thread and the sum over
+  // the threads, the output time is summed over the threads)
+  if(fBenchFile!=""&&!G4Threading::IsWorkerThread()){
+    Double_t runTime=fTimer->RealTime();
+    if(fIsMaster) WriteBenchmark(runTime,fgThreadTrackTimeMax,fgThreadTrackTime,outTime,zipBytes,totBytes);
+    else WriteBenchmark(runTime,fTrackTime,fTrackTime,outTime,zipBytes,totBytes);
+  }
 
   fOutFile->Close();
   if(fOutFile)delete fOutFile;
+  fOutFile=NULL;
+
+  //remove the merged thread output
+  if(fIsMaster){
+    for(size_t i=0;i<fgThreadFiles.size();i++) gSystem->Unlink(fgThreadFiles[i]);
+    fgThreadFiles.clear();
+  }
+}
+
+void A2EventAction::MergeThreadOutput(){
+  //Copy the trees of the worker threads into the output file.
+  //The events are stored thread by thread, the original order
+  //can be restored using the eventid branch
+  G4cout<<"A2EventAction::MergeThreadOutput() Merging the output of "<<fgThreadFiles.size()<<" threads into "<<fOutFileName<<G4endl;
+  TChain chain("h12");
+  for(size_t i=0;i<fgThreadFiles.size();i++) chain.Add(fgThreadFiles[i]);
+  if(chain.GetEntries()>0) chain.Merge(fOutFile,0,"fast keep");
+  fOutFile->cd();
+}
+
+void A2EventAction::WriteBenchmark(Double_t runTime, Double_t trackTime, Double_t trackTimeSum, Double_t outTime,
+                                   Double_t zipBytes, Double_t totBytes){
+  //Write the performance figures of this run as JSON object to fBenchFile
+  struct rusage usage;
+  getrusage(RUSAGE_SELF,&usage);
+#ifdef __APPLE__
+  Double_t peakRSS=usage.ru_maxrss/1024./1024.; //(ru_maxrss in bytes)
+#else
+  Double_t peakRSS=usage.ru_maxrss/1024.; //(ru_maxrss in kB)
+#endif
+  TString version(G4Version.c_str());
+  version.ReplaceAll("$", "");
+  version.ReplaceAll("Name:", "");
+  version=version.Strip(TString::kBoth);
+  std::ofstream out(fBenchFile.Data());
+  if(!out.is_open()){
+    G4cout<<"A2EventAction::WriteBenchmark() Could not open "<<fBenchFile<<G4endl;
+    return;
+  }
+  out<<"{\n"
+     <<"  \"version\": \""<<A2_VERSION<<"\",\n"
+     <<"  \"geant4\": \""<<version<<"\",\n"
+     <<"  \"threads\": "<<(fIsMaster ? (G4int)fgThreadFiles.size() : 1)<<",\n"
+     <<"  \"events\": "<<fNEvtRun<<",\n"
+     <<"  \"events_per_s\": "<<(runTime>0 ? fNEvtRun/runTime : 0)<<",\n"
+     <<"  \"peak_rss_mb\": "<<peakRSS<<",\n"
+     <<"  \"init_time_s\": "<<fInitTime<<",\n"
+     <<"  \"run_time_s\": "<<runTime<<",\n"
+     <<"  \"tracking_time_s\": "<<trackTime<<",\n"
+     <<"  \"tracking_time_sum_s\": "<<trackTimeSum<<",\n"
+     <<"  \"output_time_s\": "<<outTime<<",\n"
+     <<"  \"output_bytes\": "<<(Long64_t)zipBytes<<",\n"
+     <<"  \"output_bytes_uncompressed\": "<<(Long64_t)totBytes<<",\n"
+     <<"  \"bytes_per_event\": "<<(fNEvtRun>0 ? zipBytes/fNEvtRun : 0)<<"\n"
+     <<"}"<<std::endl;
+  G4cout<<"A2EventAction::WriteBenchmark() Benchmark report written to "<<fBenchFile<<G4endl;
 }
 
 void A2EventAction::FormatTimeSec(double seconds, TString& out)
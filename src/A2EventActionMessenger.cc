@@ -2,6 +2,8 @@
 #include "A2EventActionMessenger.hh"
 
 #include "A2EventAction.hh"
+#include "A2Profiler.hh"
+#include "A2EventStats.hh"
 #include "G4UIdirectory.hh"
 #include "G4UIcmdWithoutParameter.hh"
 #include "G4UIcmdWithAString.hh"
@@ -52,6 +54,75 @@ A2EventActionMessenger::A2EventActionMessenger(A2EventAction* EvAct)
   fStorePrimCmd->SetParameterName("storePrim", true);
   fStorePrimCmd->SetDefaultValue(true);
   fStorePrimCmd->AvailableForStates(G4State_Idle);
+
+  fCompAlgoCmd = new G4UIcmdWithAString("/A2/event/setCompressionAlgorithm",this);
+  fCompAlgoCmd->SetGuidance("Set the compression algorithm of the output file");
+  fCompAlgoCmd->SetGuidance("  Choice : default, zlib, lzma, lz4 (ROOT>=6.10), zstd (ROOT>=6.20)");
+  fCompAlgoCmd->SetParameterName("choice",false);
+  fCompAlgoCmd->SetCandidates("default zlib lzma lz4 zstd");
+  fCompAlgoCmd->AvailableForStates(G4State_Idle);
+
+  fCompLevelCmd = new G4UIcmdWithAnInteger("/A2/event/setCompressionLevel",this);
+  fCompLevelCmd->SetGuidance("Set the compression level of the output file (0=none, 9=maximum, -1=ROOT default)");
+  fCompLevelCmd->SetParameterName("level",false);
+  fCompLevelCmd->SetRange("level>=-1 && level<=9");
+  fCompLevelCmd->AvailableForStates(G4State_Idle);
+
+  fBasketSizeCmd = new G4UIcmdWithAnInteger("/A2/event/setBasketSize",this);
+  fBasketSizeCmd->SetGuidance("Set the basket size of the output branches in bytes");
+  fBasketSizeCmd->SetParameterName("size",false);
+  fBasketSizeCmd->SetRange("size>0");
+  fBasketSizeCmd->AvailableForStates(G4State_Idle);
+
+  fAutoFlushCmd = new G4UIcmdWithAnInteger("/A2/event/setAutoFlush",this);
+  fAutoFlushCmd->SetGuidance("Flush the output baskets every n events (n>0) or every -n bytes (n<0)");
+  fAutoFlushCmd->SetGuidance("  0 : ROOT default");
+  fAutoFlushCmd->SetParameterName("n",false);
+  fAutoFlushCmd->AvailableForStates(G4State_Idle);
+
+  fAutoSaveCmd = new G4UIcmdWithAnInteger("/A2/event/setAutoSave",this);
+  fAutoSaveCmd->SetGuidance("Save the output tree header every n events (n>0) or every -n bytes (n<0)");
+  fAutoSaveCmd->SetGuidance("  0 : ROOT default");
+  fAutoSaveCmd->SetParameterName("n",false);
+  fAutoSaveCmd->AvailableForStates(G4State_Idle);
+
+  fAsyncCmd = new G4UIcmdWithAnInteger("/A2/event/setAsyncOutput",this);
+  fAsyncCmd->SetGuidance("Fill the output tree in a separate writer thread");
+  fAsyncCmd->SetGuidance("  n : number of events queued for the writer thread (0: fill in the event loop)");
+  fAsyncCmd->SetParameterName("n",false);
+  fAsyncCmd->SetRange("n>=0");
+  fAsyncCmd->AvailableForStates(G4State_Idle);
+
+  fBenchFileCmd = new G4UIcmdWithAString("/A2/event/setBenchmarkFile",this);
+  fBenchFileCmd->SetGuidance("Write the performance figures of each run (events/s, memory, timing, output size) as JSON to this file");
+  fBenchFileCmd->SetParameterName("choice",false);
+  fBenchFileCmd->AvailableForStates(G4State_Idle);
+
+  fProfileCmd = new G4UIcmdWithABool("/A2/event/setProfile",this);
+  fProfileCmd->SetGuidance("Profile the tracking: steps, tracks, wall and CPU time per region, particle and process");
+  fProfileCmd->SetGuidance("(table at the end of the run, histogram \"A2Geant4 Profile\" in the output file)");
+  fProfileCmd->SetParameterName("profile",false);
+  fProfileCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fEventStatsCmd = new G4UIcmdWithABool("/A2/event/storeEventStats",this);
+  fEventStatsCmd->SetGuidance("Store the tracking wall time, steps, tracks and RSS high-water mark of each event");
+  fEventStatsCmd->SetGuidance("as branches (the histograms in the output file are always written)");
+  fEventStatsCmd->SetParameterName("store",false);
+  fEventStatsCmd->AvailableForStates(G4State_Idle);
+
+  fSlowestCmd = new G4UIcmdWithAnInteger("/A2/event/dumpSlowestEvents",this);
+  fSlowestCmd->SetGuidance("Print the n slowest events at the end of each run and write their");
+  fSlowestCmd->SetGuidance("random number states to runXevtY.rndm (0: off)");
+  fSlowestCmd->SetParameterName("n",false);
+  fSlowestCmd->SetRange("n>=0");
+  fSlowestCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fRestoreRndmCmd = new G4UIcmdWithAString("/A2/event/restoreRandomState",this);
+  fRestoreRndmCmd->SetGuidance("Restore the random number state of an event dumped by /A2/event/dumpSlowestEvents");
+  fRestoreRndmCmd->SetGuidance("(replay the event with /run/beamOn 1 in a single-threaded run)");
+  fRestoreRndmCmd->SetParameterName("file",false);
+  fRestoreRndmCmd->SetToBeBroadcasted(false);
+  fRestoreRndmCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
 }
 
 
@@ -63,6 +134,17 @@ A2EventActionMessenger::~A2EventActionMessenger()
   delete fPrintCmd;
   delete feventDir;
   delete fStorePrimCmd;
+  delete fCompAlgoCmd;
+  delete fCompLevelCmd;
+  delete fBasketSizeCmd;
+  delete fAutoFlushCmd;
+  delete fAutoSaveCmd;
+  delete fAsyncCmd;
+  delete fBenchFileCmd;
+  delete fProfileCmd;
+  delete fEventStatsCmd;
+  delete fSlowestCmd;
+  delete fRestoreRndmCmd;
 }
 
 
@@ -85,6 +167,39 @@ void A2EventActionMessenger::SetNewValue(
 
   if (command == fStorePrimCmd)
     feventAction->SetStorePrimaries(fStorePrimCmd->GetNewBoolValue(newValue));
+
+  if(command == fCompAlgoCmd)
+    {feventAction->SetCompressionAlgorithm(newValue);}
+
+  if(command == fCompLevelCmd)
+    {feventAction->SetCompressionLevel(fCompLevelCmd->GetNewIntValue(newValue));}
+
+  if(command == fBasketSizeCmd)
+    {feventAction->SetBasketSize(fBasketSizeCmd->GetNewIntValue(newValue));}
+
+  if(command == fAutoFlushCmd)
+    {feventAction->SetAutoFlush(fAutoFlushCmd->GetNewIntValue(newValue));}
+
+  if(command == fAutoSaveCmd)
+    {feventAction->SetAutoSave(fAutoSaveCmd->GetNewIntValue(newValue));}
+
+  if(command == fAsyncCmd)
+    {feventAction->SetAsyncOutput(fAsyncCmd->GetNewIntValue(newValue));}
+
+  if(command == fBenchFileCmd)
+    {feventAction->SetBenchmarkFile(newValue.data());}
+
+  if(command == fProfileCmd)
+    {A2Profiler::SetEnabled(fProfileCmd->GetNewBoolValue(newValue));}
+
+  if(command == fEventStatsCmd)
+    {feventAction->SetStoreEventStats(fEventStatsCmd->GetNewBoolValue(newValue));}
+
+  if(command == fSlowestCmd)
+    {A2EventStats::SetNSlowest(fSlowestCmd->GetNewIntValue(newValue));}
+
+  if(command == fRestoreRndmCmd)
+    {A2EventStats::RestoreRandomState(newValue);}
 }
 
 
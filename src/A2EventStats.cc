@@ -0,0 +1,332 @@
+// Per-event statistics of the tracking: wall time, steps, tracks and memory
+// high-water mark, slowest events with their random number state
+
+#include <cmath>
+#include <fstream>
+#include <algorithm>
+#include <sys/resource.h>
+
+#include "G4Track.hh"
+#include "G4Event.hh"
+#include "G4RunManager.hh"
+#include "G4AutoLock.hh"
+#include "G4ios.hh"
+#include "Randomize.hh"
+#include "TH1D.h"
+
+#include "A2EventStats.hh"
+
+namespace {
+    G4Mutex gEventStatsMutex = G4MUTEX_INITIALIZER;
+
+    // log10 binning of the histograms of the recorded quantities
+    struct A2EventBinning_t {
+        const char* fName;                  // histogram name
+        const char* fTitle;                 // histogram title
+        const char* fLabel;                 // summary label
+        const char* fUnit;                  // summary unit
+        G4double fLogMin;                   // log10 of the lower edge
+        G4int fPerDecade;                   // bins per decade
+        G4int fNBins;                       // number of bins
+    };
+    const A2EventBinning_t gBinning[A2EventStats::kNQuantities] = {
+        { "A2Geant4 EventTime", "Tracking wall time per event;wall time [s];events", "Event wall time", "s", -6, 10, 90 },
+        { "A2Geant4 EventSteps", "Steps per event;steps;events", "Event steps", "", 0, 10, 80 },
+        { "A2Geant4 EventTracks", "Tracks per event;tracks;events", "Event tracks", "", 0, 10, 70 },
+        { "A2Geant4 EventRSS", "RSS high-water mark after the event;RSS [MB];events", "Event peak RSS", "MB", 0, 20, 100 }
+    };
+}
+
+G4int A2EventStats::fgNSlowest = 0;
+A2EventStats::A2EventHist_t A2EventStats::fgHists[A2EventStats::kNQuantities];
+std::vector<A2EventStats::A2SlowEvent_t> A2EventStats::fgSlowest;
+G4int A2EventStats::fgNEvents = 0;
+G4ThreadLocal A2EventStats* A2EventStats::fgInstance = 0;
+
+//______________________________________________________________________________
+A2EventStats::A2EventHist_t::A2EventHist_t()
+    : fSum(0), fMax(0), fMaxEvent(-1)
+{
+    // Constructor.
+
+    G4int n = 0;
+    for (G4int q = 0; q < kNQuantities; q++)
+        n = std::max(n, gBinning[q].fNBins);
+    fCounts.assign(n+2, 0);
+}
+
+//______________________________________________________________________________
+void A2EventStats::A2EventHist_t::Fill(G4int q, G4double val, G4int event)
+{
+    // Add the value 'val' of the quantity 'q' of the event 'event'.
+
+    const A2EventBinning_t& b = gBinning[q];
+    G4int bin = 0;
+    if (val > 0)
+    {
+        G4double x = (std::log10(val) - b.fLogMin) * b.fPerDecade;
+        bin = x < 0 ? 0 : (x >= b.fNBins ? b.fNBins+1 : (G4int)x + 1);
+    }
+    fCounts[bin]++;
+    fSum += val;
+    if (val > fMax || fMaxEvent < 0)
+    {
+        fMax = val;
+        fMaxEvent = event;
+    }
+}
+
+//______________________________________________________________________________
+void A2EventStats::A2EventHist_t::Add(const A2EventHist_t& h)
+{
+    // Add the counters of 'h'.
+
+    for (size_t i = 0; i < fCounts.size(); i++)
+        fCounts[i] += h.fCounts[i];
+    fSum += h.fSum;
+    if (h.fMaxEvent >= 0 && (h.fMax > fMax || fMaxEvent < 0))
+    {
+        fMax = h.fMax;
+        fMaxEvent = h.fMaxEvent;
+    }
+}
+
+//______________________________________________________________________________
+A2EventStats::A2EventStats()
+{
+    // Constructor.
+
+    // init members
+    fNEvents = 0;
+    fNSteps = 0;
+    fNTracks = 0;
+    fStoreState = false;
+    fInputEvent = -1;
+    for (G4int q = 0; q < kNQuantities; q++)
+        fValues[q] = 0;
+    fStart = std::chrono::steady_clock::now();
+}
+
+//______________________________________________________________________________
+G4double A2EventStats::GetPeakRSS()
+{
+    // Return the resident set size high-water mark of the process [MB].
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss/1024./1024.;     // (ru_maxrss in bytes)
+#else
+    return usage.ru_maxrss/1024.;           // (ru_maxrss in kB)
+#endif
+}
+
+//______________________________________________________________________________
+void A2EventStats::BeginOfRun()
+{
+    // Prepare the recording of the slowest events: the run manager of this
+    // thread stores the random number state before the event generation
+    // in the events.
+
+    fStoreState = fgNSlowest > 0;
+    if (fStoreState)
+    {
+        G4RunManager* rm = G4RunManager::GetRunManager();
+        G4int flag = rm->GetFlagRandomNumberStatusToG4Event();
+        if (!(flag & 1))
+            rm->StoreRandomNumberStatusToG4Event(flag | 1);
+    }
+}
+
+//______________________________________________________________________________
+void A2EventStats::EndTrack(const G4Track* track)
+{
+    // Count the track and its steps.
+
+    fNTracks++;
+    fNSteps += track->GetCurrentStepNumber();
+}
+
+//______________________________________________________________________________
+void A2EventStats::EndEvent(const G4Event* evt)
+{
+    // Record the statistics of the event 'evt' and keep it if it is one of
+    // the slowest events of this thread.
+
+    fValues[kWallTime] = std::chrono::duration<G4double>(std::chrono::steady_clock::now() - fStart).count();
+    fValues[kSteps] = fNSteps;
+    fValues[kTracks] = fNTracks;
+    fValues[kRSS] = GetPeakRSS();
+
+    G4int id = evt->GetEventID();
+    for (G4int q = 0; q < kNQuantities; q++)
+        fHists[q].Fill(q, fValues[q], id);
+    fNEvents++;
+
+    // the fastest of the kept events is at the front of the heap
+    if (fgNSlowest > 0 && ((G4int)fSlowest.size() < fgNSlowest || fValues[kWallTime] > fSlowest.front().fTime))
+    {
+        if ((G4int)fSlowest.size() >= fgNSlowest)
+        {
+            std::pop_heap(fSlowest.begin(), fSlowest.end());
+            fSlowest.pop_back();
+        }
+        A2SlowEvent_t e;
+        e.fTime = fValues[kWallTime];
+        e.fEvent = id;
+        e.fInputEvent = fInputEvent;
+        e.fSteps = fNSteps;
+        e.fTracks = fNTracks;
+        if (fStoreState)
+            e.fRandomState = evt->GetRandomNumberStatus();
+        fSlowest.push_back(e);
+        std::push_heap(fSlowest.begin(), fSlowest.end());
+    }
+
+    // (set by the generator of the next event in file-input mode)
+    fInputEvent = -1;
+}
+
+//______________________________________________________________________________
+void A2EventStats::Merge()
+{
+    // Add the statistics of this thread to the totals of all threads and
+    // reset them.
+
+    G4AutoLock lock(&gEventStatsMutex);
+    for (G4int q = 0; q < kNQuantities; q++)
+    {
+        fgHists[q].Add(fHists[q]);
+        fHists[q] = A2EventHist_t();
+    }
+    fgNEvents += fNEvents;
+    fNEvents = 0;
+    fgSlowest.insert(fgSlowest.end(), fSlowest.begin(), fSlowest.end());
+    fSlowest.clear();
+}
+
+//______________________________________________________________________________
+void A2EventStats::ResetTotals()
+{
+    // Reset the totals of all threads.
+
+    G4AutoLock lock(&gEventStatsMutex);
+    for (G4int q = 0; q < kNQuantities; q++)
+        fgHists[q] = A2EventHist_t();
+    fgNEvents = 0;
+    fgSlowest.clear();
+}
+
+//______________________________________________________________________________
+void A2EventStats::PrintSlowest(G4int run)
+{
+    // Print the slowest events of all threads of the run 'run' and write
+    // their random number states to the files runXevtY.rndm. In file-input
+    // mode the index of the input event (within the processed event range)
+    // is printed as well, since the random number state alone does not select
+    // the input event of a replay.
+
+    G4AutoLock lock(&gEventStatsMutex);
+    if (fgNSlowest <= 0 || fgSlowest.empty())
+        return;
+
+    std::sort(fgSlowest.begin(), fgSlowest.end());
+    if ((G4int)fgSlowest.size() > fgNSlowest)
+        fgSlowest.resize(fgNSlowest);
+
+    G4cout << "A2EventStats::PrintSlowest(): " << fgSlowest.size() << " slowest events of run " << run << G4endl;
+    G4cout << TString::Format("  %10s %10s %12s %14s %12s  %s", "event", "input", "wall [s]", "steps", "tracks",
+                              "random number state") << G4endl;
+    G4bool input = false;
+    for (size_t i = 0; i < fgSlowest.size(); i++)
+    {
+        const A2SlowEvent_t& e = fgSlowest[i];
+        TString file("not stored");
+        if (e.fRandomState != "")
+        {
+            file = TString::Format("run%devt%d.rndm", run, e.fEvent);
+            std::ofstream out(file.Data());
+            out << e.fRandomState;
+            if (!out)
+                file = "could not write " + file;
+        }
+        TString in = e.fInputEvent >= 0 ? TString::Format("%d", e.fInputEvent) : TString("-");
+        if (e.fInputEvent >= 0)
+            input = true;
+        G4cout << TString::Format("  %10d %10s %12.3f %14lld %12lld  %s", e.fEvent, in.Data(), e.fTime,
+                                  (Long64_t)e.fSteps, (Long64_t)e.fTracks, file.Data()) << G4endl;
+    }
+    G4cout << "A2EventStats::PrintSlowest(): Replay an event with /A2/event/restoreRandomState runXevtY.rndm ";
+    if (input)
+        G4cout << "and /A2/generator/StartEvent <input> (same input file and shard) ";
+    G4cout << "and /run/beamOn 1 in a single-threaded run" << G4endl;
+}
+
+//______________________________________________________________________________
+TString A2EventStats::GetSummary()
+{
+    // Return the mean and maximum values of all threads as metadata lines.
+
+    G4AutoLock lock(&gEventStatsMutex);
+    TString sum;
+    if (!fgNEvents)
+        return sum;
+    for (G4int q = 0; q < kNQuantities; q++)
+    {
+        const A2EventHist_t& h = fgHists[q];
+        TString unit = gBinning[q].fUnit[0] ? TString(" ") + gBinning[q].fUnit : TString("");
+        sum += TString::Format("\n       %-19s: mean %.4g%s, max %.4g%s (event %d)", gBinning[q].fLabel,
+                               h.fSum/fgNEvents, unit.Data(), h.fMax, unit.Data(), h.fMaxEvent);
+    }
+    return sum;
+}
+
+//______________________________________________________________________________
+void A2EventStats::WriteHistograms()
+{
+    // Write the histograms of all threads (log10 bins) to the current
+    // directory.
+
+    G4AutoLock lock(&gEventStatsMutex);
+    if (!fgNEvents)
+        return;
+
+    for (G4int q = 0; q < kNQuantities; q++)
+    {
+        const A2EventBinning_t& b = gBinning[q];
+        std::vector<Double_t> edges(b.fNBins+1);
+        for (G4int i = 0; i <= b.fNBins; i++)
+            edges[i] = std::pow(10., b.fLogMin + (G4double)i/b.fPerDecade);
+
+        TH1D h(b.fName, b.fTitle, b.fNBins, &edges[0]);
+        h.SetDirectory(0);
+        for (G4int i = 0; i <= b.fNBins+1; i++)
+            h.SetBinContent(i, fgHists[q].fCounts[i]);
+        h.SetEntries(fgNEvents);
+        h.Write();
+    }
+}
+
+//______________________________________________________________________________
+G4bool A2EventStats::RestoreRandomState(const G4String& fileName)
+{
+    // Restore the random number state of an event written by PrintSlowest()
+    // from the file 'fileName'.
+
+    std::ifstream in(fileName);
+    if (!in)
+    {
+        G4cout << "A2EventStats::RestoreRandomState(): Could not open " << fileName << G4endl;
+        return false;
+    }
+    G4Random::restoreFullState(in);
+    if (in.fail())
+    {
+        G4cout << "A2EventStats::RestoreRandomState(): Could not read the random number state from "
+               << fileName << G4endl;
+        return false;
+    }
+
+    G4cout << "A2EventStats::RestoreRandomState(): Random number state restored from " << fileName << G4endl;
+    return true;
+}
@@ -2,11 +2,16 @@
 // Author: Dominik Werthmueller, 2018
 
 #include "TMath.h"
+#include "TFile.h"
 
 #include "G4ParticleDefinition.hh"
 #include "Randomize.hh"
 
 #include "A2FileGenerator.hh"
+#include "A2FileGeneratorMkin.hh"
+#include "A2FileGeneratorPluto.hh"
+#include "A2FileGeneratorGiBUU.hh"
+#include "A2ParticleCache.hh"
 
 //______________________________________________________________________________
 A2FileGenerator::A2FileGenerator(const char* filename, EFileGenType type)
@@ -16,8 +21,162 @@ A2FileGenerator::A2FileGenerator(const char* filename, EFileGenType type)
     // init members
     fType = type;
     fFileName = filename;
+    fNEntries = 0;
+    fFirstEvent = 0;
     fNEvents = 0;
     fWeight = 1;
+    fDeferLookup = false;
+}
+
+//______________________________________________________________________________
+A2FileGenerator* A2FileGenerator::Open(const char* filename, G4int shard, G4int nShards)
+{
+    // Detect the format of the event file 'filename' and return a new,
+    // initialized event generator reading the shard 'shard' of 'nShards'
+    // equally sized, disjoint event ranges of the file.
+    // Every generator has its own file handle, i.e. several generators
+    // can read the same file concurrently.
+    // Return 0 if the file could not be opened.
+
+    // look for supported event trees in ROOT file
+    TFile* ftest = new TFile(filename);
+    G4bool has_mkin = false;
+    G4bool has_pluto = false;
+    G4bool has_gibuu = false;
+    if (ftest && !ftest->IsZombie())
+    {
+        has_mkin = ftest->Get("h1") != 0;
+        has_pluto = ftest->Get("data") != 0;
+        has_gibuu = ftest->Get("RootTuple") != 0;
+        delete ftest;
+    }
+    else
+    {
+        G4cout << "A2FileGenerator::Open(): Could not open ROOT file " << filename << G4endl;
+        if (ftest)
+            delete ftest;
+        return 0;
+    }
+
+    // create the generator
+    A2FileGenerator* gen = 0;
+    if (has_mkin)
+    {
+        gen = new A2FileGeneratorMkin(filename);
+    }
+    else if (has_pluto)
+    {
+#ifdef WITH_PLUTO
+        gen = new A2FileGeneratorPluto(filename);
+#else
+        G4cout << "A2FileGenerator::Open(): Support for Pluto event files was not activated at compile time!" << G4endl;
+        return 0;
+#endif
+    }
+    else if (has_gibuu)
+    {
+        gen = new A2FileGeneratorGiBUU(filename);
+    }
+    else
+    {
+        G4cout << "A2FileGenerator::Open(): ROOT event-tree format is not supported!" << G4endl;
+        return 0;
+    }
+
+    // init the file and select the event range
+    if (!gen->Init() || !gen->SetShard(shard, nShards))
+    {
+        delete gen;
+        return 0;
+    }
+
+    return gen;
+}
+
+//______________________________________________________________________________
+G4bool A2FileGenerator::SetEventRange(G4int first, G4int n)
+{
+    // Restrict the generator to the 'n' file events starting at 'first'.
+    // ReadEvent() then reads the events 0 to n-1 of this range.
+    // Return false if the range is not valid.
+
+    // check range
+    if (first < 0 || n < 0 || first + n > fNEntries)
+    {
+        G4cout << "A2FileGenerator::SetEventRange(): Invalid event range [" << first
+               << ", " << first + n << ") for " << fNEntries << " events in the file "
+               << fFileName << "!" << G4endl;
+        return false;
+    }
+
+    // set range
+    fFirstEvent = first;
+    fNEvents = n;
+
+    return true;
+}
+
+//______________________________________________________________________________
+G4bool A2FileGenerator::SetShard(G4int shard, G4int nShards)
+{
+    // Restrict the generator to the shard 'shard' of 'nShards' equally sized,
+    // disjoint event ranges covering all events of the file.
+    // Return false if the shard is not valid.
+
+    // check shard
+    if (nShards < 1 || shard < 0 || shard >= nShards)
+    {
+        G4cout << "A2FileGenerator::SetShard(): Invalid shard " << shard
+               << " of " << nShards << " shards!" << G4endl;
+        return false;
+    }
+
+    // calculate range (64-bit to avoid overflows for large files)
+    G4int first = (G4int)((long long)fNEntries * shard / nShards);
+    G4int last = (G4int)((long long)fNEntries * (shard + 1) / nShards);
+
+    return SetEventRange(first, last - first);
+}
+
+//______________________________________________________________________________
+G4ParticleDefinition* A2FileGenerator::FindParticle(G4int pdg) const
+{
+    // Return the Geant4 particle definition of the particle with the PDG
+    // code 'pdg' from the shared particle cache.
+    // If the look-up is deferred, 0 is returned for particles missing in
+    // the cache, which have to be resolved later in a Geant4 thread via
+    // ResolveParticles().
+
+    return A2ParticleCache::Instance()->Find(pdg, !fDeferLookup);
+}
+
+//______________________________________________________________________________
+void A2FileGenerator::SetDeferredLookup()
+{
+    // Defer the look-up of all particles not contained in the particle cache.
+    // Afterwards, events can be read from a non-Geant4 thread (see
+    // A2FileGeneratorPrefetch).
+
+    // fill the cache in this thread
+    A2ParticleCache::Instance();
+
+    fDeferLookup = true;
+}
+
+//______________________________________________________________________________
+void A2FileGenerator::ResolveParticles(std::vector<A2GenParticle_t>& part) const
+{
+    // Resolve the deferred look-ups of the particles in 'part'.
+
+    for (G4int i = 0; i < (G4int)part.size(); i++)
+    {
+        if (!part[i].fDef && part[i].fPDG)
+        {
+            part[i].fDef = A2ParticleCache::Instance()->Find(part[i].fPDG);
+            if (part[i].fDef)
+                part[i].SetCorrectMass();
+        }
+    }
 }
 
 //______________________________________________________________________________
@@ -113,6 +272,8 @@ void A2FileGenerator::Print() const
     G4cout << "Generator type      : " << type << G4endl
            << "File name           : " << fFileName << G4endl
            << "Number of events    : " << fNEvents << G4endl
+           << "Event range         : " << fFirstEvent << " - " << fFirstEvent + fNEvents - 1
+                                       << " (of " << fNEntries << ")" << G4endl
            << "Event weight        : " << fWeight << G4endl
            << "Number of particles : " << fPart.size() << G4endl
            << "Primary vertex      : " << fVertex << G4endl
@@ -1,13 +1,13 @@
 // event generator reading GiBUU ROOT files
 // Author: Dominik Werthmueller, 2019
 
-#include "G4ParticleTable.hh"
-#include "G4IonTable.hh"
+#include "G4ParticleDefinition.hh"
 
 #include "TMath.h"
 #include "TTree.h"
 
 #include "A2FileGeneratorGiBUU.hh"
+#include "A2ParticleCache.hh"
 
 using namespace CLHEP;
 
@@ -83,26 +83,16 @@ G4bool A2FileGeneratorGiBUU::ReadEvent(G4int event)
     for (UInt_t i = 0; i < fReaderCode->size(); i++)
     {
         // look-up particle
+        // (undefined particles are summarised at the end of the run,
+        //  deferred look-ups are resolved in ResolveParticles())
         Int_t pdg = fReaderCode->at(i);
-        G4ParticleDefinition* partDef = G4ParticleTable::GetParticleTable()->FindParticle(pdg);
-        if (!partDef)
-        {
-            G4int Z, A, L, J;
-            G4double E;
-            if (G4IonTable::GetNucleusByEncoding(pdg, Z, A, L, E, J))
-                partDef = G4ParticleTable::GetParticleTable()->GetIonTable()->GetIon(Z, A, L, 0.0, J);
-        }
-        if (!partDef)
-        {
-            // user info
-            G4cout << "A2FileGeneratorGiBUU::Init(): Undefined particle with PDG ID " << pdg
-                   << " will not be tracked!" << G4endl;
+        G4ParticleDefinition* partDef = FindParticle(pdg);
+        if (!partDef && !fDeferLookup)
             continue;
-        }
 
         // check for off-shell particles
         Double_t e = 1000 * fReaderE->at(i);
-        switch (partDef->GetPDGEncoding())
+        switch (partDef ? partDef->GetPDGEncoding() : 0)
         {
             case  111: // pi0
             case  211: // pi+
@@ -117,14 +107,19 @@ G4bool A2FileGeneratorGiBUU::ReadEvent(G4int event)
                     continue;
                 else
                     break;
+            case 0: // deferred look-up
+                break;
             default:
-                G4cout << "A2FileGeneratorGiBUU::Init(): No off-shell cuts defined for particle " <<
-                       partDef->GetParticleName() << G4endl;
+                // (reported once per particle, not for every event)
+                if (fNoCut.insert(partDef->GetPDGEncoding()).second)
+                    G4cout << "A2FileGeneratorGiBUU::ReadEvent(): No off-shell cuts defined for particle " <<
+                           partDef->GetParticleName() << G4endl;
         }
 
         // set event particle
         A2GenParticle_t part;
         part.fDef = partDef;
+        part.fPDG = pdg;
         part.fP.set(fReaderPx->at(i)*GeV, fReaderPy->at(i)*GeV, fReaderPz->at(i)*GeV);
         part.fE = fReaderE->at(i)*GeV;
         part.SetCorrectMass(true);
@@ -140,6 +135,33 @@ G4bool A2FileGeneratorGiBUU::ReadEvent(G4int event)
     return true;
 }
 
+//______________________________________________________________________________
+void A2FileGeneratorGiBUU::ResolveParticles(std::vector<A2GenParticle_t>& part) const
+{
+    // Resolve the deferred look-ups of the particles in 'part'.
+    // Undefined particles are removed (and summarised at the end of the run).
+
+    for (std::vector<A2GenParticle_t>::iterator it = part.begin(); it != part.end(); )
+    {
+        if (!it->fDef && it->fPDG)
+        {
+            it->fDef = A2ParticleCache::Instance()->Find(it->fPDG);
+            if (!it->fDef)
+            {
+                it = part.erase(it);
+                continue;
+            }
+            it->SetCorrectMass(true);
+            if (std::isnan(it->fP.mag()))
+            {
+                it = part.erase(it);
+                continue;
+            }
+        }
+        ++it;
+    }
+}
+
 //______________________________________________________________________________
 G4int A2FileGeneratorGiBUU::GetMaxParticles()
 {
@@ -1,8 +1,7 @@
 // event generator reading mkin-files
 // Author: Dominik Werthmueller, 2018
 
-#include "G4ParticleTable.hh"
-#include "G4IonTable.hh"
+#include "G4ParticleDefinition.hh"
 
 #include "CLHEP/Units/SystemOfUnits.h"
 
@@ -71,7 +70,7 @@ G4bool A2FileGeneratorMkin::Init()
     LinkBranch("Pz_bm", &fBeamBr[2]);
     LinkBranch("Pt_bm", &fBeamBr[4]);
     LinkBranch("En_bm", &fBeamBr[3]);
-    fBeam.fDef = G4ParticleTable::GetParticleTable()->FindParticle(22);
+    fBeam.fDef = FindParticle(22);
     fBeam.fM = 0;
     fBeam.fIsTrack = false;
 
@@ -125,21 +124,14 @@ G4bool A2FileGeneratorMkin::Init()
                 }
 
                 // look-up particle
-                G4ParticleDefinition* partDef = G4ParticleTable::GetParticleTable()->FindParticle(GetPDGfromG3(g3_id));
-                if (!partDef && g3_id != 0)
-                {
-                    G4int Z, A, L, J;
-                    G4double E;
-                    if (G4IonTable::GetNucleusByEncoding(GetPDGfromG3(g3_id), Z, A, L, E, J))
-                        partDef = G4ParticleTable::GetParticleTable()->GetIonTable()->GetIon(Z, A, L, 0.0, J);
-                }
+                G4ParticleDefinition* partDef = FindParticle(GetPDGfromG3(g3_id));
 
                 // add particle
                 if (partDef)
                 {
                     // kaon0S bugfix
                     if (g3_id == 16 && partDef->GetPDGEncoding() == 130)
-                        partDef = G4ParticleTable::GetParticleTable()->FindParticle(310);
+                        partDef = FindParticle(310);
 
                     // user info
                     G4cout << "A2FileGeneratorMkin::Init(): Adding a " << partDef->GetParticleName()
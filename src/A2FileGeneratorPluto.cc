@@ -3,8 +3,7 @@
 
 #ifdef WITH_PLUTO
 
-#include "G4ParticleTable.hh"
-#include "G4IonTable.hh"
+#include "G4ParticleDefinition.hh"
 
 #include "TTreeReader.h"
 
@@ -100,10 +99,14 @@ G4bool A2FileGeneratorPluto::Init()
 //______________________________________________________________________________
 G4bool A2FileGeneratorPluto::ReadEvent(G4int event)
 {
-    // Read the event 'event'.
+    // Read the event 'event' of the event range.
 
-    // read event
-    if (!fReader->Next())
+    // check event
+    if (event < 0 || event >= fNEvents)
+        return false;
+
+    // read event (random access)
+    if (fReader->SetEntry(GetEntry(event)) != TTreeReader::kEntryValid)
         return false;
 
     // clear particles
@@ -118,6 +121,8 @@ G4bool A2FileGeneratorPluto::ReadEvent(G4int event)
         // set event particle
         A2GenParticle_t part;
         part.fDef = PlutoToG4(ppart.ID());
+        if (ppart.ID() >= 0 && ppart.ID() < 70)
+            part.fPDG = fgPlutoG4Conversion[ppart.ID()];
         part.fP.set(ppart.Px()*GeV, ppart.Py()*GeV, ppart.Pz()*GeV);
         part.fE = ppart.E()*GeV;
         part.SetCorrectMass();
@@ -152,7 +157,7 @@ G4bool A2FileGeneratorPluto::ReadEvent(G4int event)
             }
 
             // set beam (assume photon beam);
-            fBeam.fDef = G4ParticleTable::GetParticleTable()->FindParticle(22);
+            fBeam.fDef = FindParticle(22);
             fBeam.fP.set(ppart.Px()*GeV, ppart.Py()*GeV, ppart.Pz()*GeV);
             fBeam.fE = (ppart.E() - target_mass)*GeV;
             fBeam.fM = 0;
@@ -167,23 +172,13 @@ G4bool A2FileGeneratorPluto::ReadEvent(G4int event)
 }
 
 //______________________________________________________________________________
-G4ParticleDefinition* A2FileGeneratorPluto::PlutoToG4(Int_t id)
+G4ParticleDefinition* A2FileGeneratorPluto::PlutoToG4(Int_t id) const
 {
     // Convert a particle with Pluto ID 'id' to a Geant4 particle definition.
 
     // check for valid Pluto particle ID range
     if (id >= 0 && id < 70)
-    {
-        G4ParticleDefinition* partDef = G4ParticleTable::GetParticleTable()->FindParticle(fgPlutoG4Conversion[id]);
-        if (!partDef)
-        {
-            G4int Z, A, L, J;
-            G4double E;
-            if (G4IonTable::GetNucleusByEncoding(fgPlutoG4Conversion[id], Z, A, L, E, J))
-                partDef = G4ParticleTable::GetParticleTable()->GetIonTable()->GetIon(Z, A, L, 0.0, J);
-        }
-        return partDef;
-    }
+        return FindParticle(fgPlutoG4Conversion[id]);
     else
         return 0;
 }
@@ -0,0 +1,223 @@
+// event generator prefetching the events of another file generator
+// in a background thread
+
+#include <chrono>
+
+#include "G4ios.hh"
+
+#include "A2FileGeneratorPrefetch.hh"
+
+//______________________________________________________________________________
+A2FileGeneratorPrefetch::A2FileGeneratorPrefetch(A2FileGenerator* gen, G4int depth)
+    : A2FileGenerator(gen->GetFileName().c_str(), gen->GetType())
+{
+    // Constructor.
+    // The initialized generator 'gen' is owned by this class, 'depth' is the
+    // number of events decoded in advance.
+
+    // init members
+    fGen = gen;
+    fDepth = depth > 0 ? depth : 1;
+    fMaxParticles = 0;
+    fShiftVertex = false;
+    fHead = 0;
+    fCount = 0;
+    fNextRead = 0;
+    fInFlight = -1;
+    fGeneration = 0;
+    fStop = false;
+    fNRead = 0;
+    fNStalls = 0;
+    fNSeeks = 0;
+    fStallTime = 0;
+}
+
+//______________________________________________________________________________
+A2FileGeneratorPrefetch::~A2FileGeneratorPrefetch()
+{
+    // Destructor.
+
+    // stop the reader thread
+    if (fThread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(fMutex);
+            fStop = true;
+        }
+        fCondReader.notify_all();
+        fThread.join();
+    }
+
+    if (fGen)
+        delete fGen;
+}
+
+//______________________________________________________________________________
+G4bool A2FileGeneratorPrefetch::Init()
+{
+    // Init the event prefetching and start the reader thread.
+
+    // copy the event range and properties of the generator
+    fType = fGen->GetType();
+    fNEntries = fGen->GetNEntries();
+    fFirstEvent = fGen->GetFirstEvent();
+    fNEvents = fGen->GetNEvents();
+    fMaxParticles = fGen->GetMaxParticles();
+
+    // Pluto/GiBUU events contain vertices relative to the primary vertex
+    // generated in the event loop
+    fShiftVertex = fType != kMkin;
+
+    // particle look-ups not possible in the reader thread are done in ReadEvent()
+    // (ROOT thread safety is enabled at the start of main())
+    fGen->SetDeferredLookup();
+
+    // start the reader thread
+    fRing.resize(fDepth);
+    fThread = std::thread(&A2FileGeneratorPrefetch::Run, this);
+
+    G4cout << "A2FileGeneratorPrefetch::Init(): Prefetching up to " << fDepth
+           << " events of " << fFileName << G4endl;
+
+    return true;
+}
+
+//______________________________________________________________________________
+void A2FileGeneratorPrefetch::Run()
+{
+    // Main loop of the reader thread decoding the events into the ring buffer.
+
+#ifdef G4MULTITHREADED
+    // set up the thread-local output streams
+    G4iosInitialization();
+#endif
+
+    std::unique_lock<std::mutex> lock(fMutex);
+    while (true)
+    {
+        // wait for free space in the ring buffer
+        while (!fStop && (fCount == fDepth || fNextRead >= fNEvents))
+            fCondReader.wait(lock);
+        if (fStop)
+            break;
+
+        // decode the next event without holding the lock
+        G4int event = fNextRead++;
+        G4int generation = fGeneration;
+        fInFlight = event;
+        lock.unlock();
+
+        fDecoded.fEvent = event;
+        fDecoded.fIsRead = fGen->ReadEvent(event);
+        fDecoded.fWeight = fGen->GetWeight();
+        fDecoded.fBeam = fGen->GetBeam();
+        fDecoded.fVertex = fGen->GetVertex();
+        fDecoded.fPart.resize(fGen->GetNParticles());
+        for (G4int i = 0; i < fGen->GetNParticles(); i++)
+            fDecoded.fPart[i] = fGen->GetParticle(i);
+
+        lock.lock();
+        fInFlight = -1;
+
+        // drop the event if the consumer has seeked meanwhile
+        if (generation != fGeneration)
+        {
+            fCondConsumer.notify_one();
+            continue;
+        }
+
+        // add the event to the ring buffer
+        std::swap(fRing[(fHead + fCount) % fDepth], fDecoded);
+        fCount++;
+        fCondConsumer.notify_one();
+    }
+    lock.unlock();
+
+#ifdef G4MULTITHREADED
+    G4iosFinalization();
+#endif
+}
+
+//______________________________________________________________________________
+G4bool A2FileGeneratorPrefetch::ReadEvent(G4int event)
+{
+    // Read the event 'event' of the event range from the ring buffer.
+    // Non-sequential reads restart the reader thread at 'event'.
+
+    // check event
+    if (event < 0 || event >= fNEvents)
+        return false;
+
+    // take the decoded event from the ring buffer
+    G4ThreeVector fileVertex;
+    G4bool isRead;
+    {
+        std::unique_lock<std::mutex> lock(fMutex);
+
+        // check for the expected event, otherwise restart the reader
+        G4int expected = fCount ? fRing[fHead].fEvent : (fInFlight >= 0 ? fInFlight : fNextRead);
+        if (expected != event)
+        {
+            fGeneration++;
+            fHead = 0;
+            fCount = 0;
+            fNextRead = event;
+            fNSeeks++;
+            fCondReader.notify_one();
+        }
+
+        // wait for the reader thread
+        if (!fCount)
+        {
+            fNStalls++;
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            while (!fCount)
+                fCondConsumer.wait(lock);
+            fStallTime += std::chrono::duration<G4double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        // pop event
+        A2PrefetchEvent_t& ev = fRing[fHead];
+        fPart.swap(ev.fPart);
+        fBeam = ev.fBeam;
+        fWeight = ev.fWeight;
+        fileVertex = ev.fVertex;
+        isRead = ev.fIsRead;
+        fHead = (fHead + 1) % fDepth;
+        fCount--;
+        fNRead++;
+    }
+    fCondReader.notify_one();
+
+    // resolve deferred particle look-ups in this (Geant4) thread
+    fGen->ResolveParticles(fPart);
+
+    // set vertex
+    if (fShiftVertex)
+    {
+        for (G4int i = 0; i < (G4int)fPart.size(); i++)
+            fPart[i].fX += fVertex;
+    }
+    else
+    {
+        fVertex = fileVertex;
+    }
+
+    return isRead;
+}
+
+//______________________________________________________________________________
+void A2FileGeneratorPrefetch::PrintStatistics()
+{
+    // Print the prefetching statistics and reset them.
+
+    G4cout << "A2FileGeneratorPrefetch::PrintStatistics(): " << fNRead << " events read (queue depth "
+           << fDepth << "), " << fNStalls << " stalls waiting " << fStallTime << " s for the reader thread, "
+           << fNSeeks << " non-sequential reads" << G4endl;
+
+    fNRead = 0;
+    fNStalls = 0;
+    fNSeeks = 0;
+    fStallTime = 0;
+}
+
@@ -52,8 +52,14 @@ G4bool A2FileGeneratorTree::Init()
 {
     // Init the file event reader.
 
+    // check tree
+    if (!fTree)
+        return false;
+
     // set number of events
-    fNEvents = fTree->GetEntries();
+    fNEntries = fTree->GetEntries();
+    fFirstEvent = 0;
+    fNEvents = fNEntries;
 
     return true;
 }
@@ -61,10 +67,14 @@ G4bool A2FileGeneratorTree::Init()
 //______________________________________________________________________________
 G4bool A2FileGeneratorTree::ReadEvent(G4int event)
 {
-    // Read the event 'event'.
+    // Read the event 'event' of the event range.
+
+    // check event
+    if (event < 0 || event >= fNEvents)
+        return false;
 
     // read tree entry
-    fTree->GetEntry(event);
+    fTree->GetEntry(GetEntry(event));
 
     return true;
 }
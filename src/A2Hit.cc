@@ -3,41 +3,78 @@
 #include "G4Color.hh"
 #include "G4VisAttributes.hh"
 
-G4Allocator<A2Hit> A2HitAllocator;
-
 
 A2Hit::A2Hit()
 {
   fEdep=0;
+  fWEdep=0;
   fPos.setRThetaPhi(0,0,0);
   fID=0;
   fTime=0;
+  fPart=fPartInline;
+  fNPart=0;
+  fPartCapacity=fgNPartInline;
+  fPartMax=-1;
 }
 
 
 A2Hit::~A2Hit()
-{ ;}
+{
+  ReleaseParticles();
+}
 
 
 A2Hit::A2Hit(const A2Hit& right)
-  :G4VHit()
+  :G4VHit(right)
+{
+  fEdep=right.fEdep;
+  fWEdep=right.fWEdep;
+  fPos=right.fPos;
+  fID=right.fID;
+  fTime=right.fTime;
+  fPart=fPartInline;
+  fPartCapacity=fgNPartInline;
+  CopyParticles(right);
+}
+
+
+A2Hit::A2Hit(A2Hit&& right)
+  :G4VHit(right)
 {
   fEdep=right.fEdep;
-  fPos+right.fPos;
+  fWEdep=right.fWEdep;
+  fPos=right.fPos;
   fID=right.fID;
   fTime=right.fTime;
-  fPartE=right.fPartE;
+  fPart=fPartInline;
+  fPartCapacity=fgNPartInline;
+  MoveParticles(right);
 }
 
 
-const A2Hit& A2Hit::operator=(const A2Hit& right)
+A2Hit& A2Hit::operator=(const A2Hit& right)
 {
+  if(this==&right) return *this;
+  fEdep=right.fEdep;
+  fWEdep=right.fWEdep;
+  fPos=right.fPos;
+  fID=right.fID;
+  fTime=right.fTime;
+  CopyParticles(right);
+  return *this;
+}
 
+
+A2Hit& A2Hit::operator=(A2Hit&& right)
+{
+  if(this==&right) return *this;
   fEdep=right.fEdep;
-  fPos+right.fPos;
+  fWEdep=right.fWEdep;
+  fPos=right.fPos;
   fID=right.fID;
   fTime=right.fTime;
-  fPartE=right.fPartE;
+  ReleaseParticles();
+  MoveParticles(right);
   return *this;
 }
 
@@ -53,46 +90,125 @@ void A2Hit::Draw()
 
 }
 
+void A2Hit::ReleaseParticles()
+{
+    // Free the heap array of the particle energies and clear the list.
+
+    if (fPart != fPartInline)
+        delete [] fPart;
+    fPart = fPartInline;
+    fPartCapacity = fgNPartInline;
+    fNPart = 0;
+    fPartMax = -1;
+}
+
+void A2Hit::CopyParticles(const A2Hit& right)
+{
+    // Copy the particle energies of 'right' (keeps an existing heap array
+    // if it is large enough).
+
+    if (right.fNPart > fPartCapacity)
+    {
+        ReleaseParticles();
+        fPart = new A2PartEnergy_t[right.fNPart];
+        fPartCapacity = right.fNPart;
+    }
+    for (G4int i = 0; i < right.fNPart; i++)
+        fPart[i] = right.fPart[i];
+    fNPart = right.fNPart;
+    fPartMax = right.fPartMax;
+}
+
+void A2Hit::MoveParticles(A2Hit& right)
+{
+    // Take over the particle energies of 'right' which is left empty
+    // (the particle list of this hit has to be released before).
+
+    if (right.fPart != right.fPartInline)
+    {
+        fPart = right.fPart;
+        fPartCapacity = right.fPartCapacity;
+    }
+    else
+    {
+        for (G4int i = 0; i < right.fNPart; i++)
+            fPart[i] = right.fPart[i];
+    }
+    fNPart = right.fNPart;
+    fPartMax = right.fPartMax;
+
+    right.fPart = right.fPartInline;
+    right.fPartCapacity = fgNPartInline;
+    right.fNPart = 0;
+    right.fPartMax = -1;
+}
+
+void A2Hit::UpdatePartMax()
+{
+    // Search the particle with the highest energy deposition
+    // (lowest particle index for equal energies).
+
+    fPartMax = -1;
+    for (G4int i = 0; i < fNPart; i++)
+    {
+        if (fPartMax < 0 || fPart[i].fEnergy > fPart[fPartMax].fEnergy ||
+            (fPart[i].fEnergy == fPart[fPartMax].fEnergy && fPart[i].fIndex < fPart[fPartMax].fIndex))
+            fPartMax = i;
+    }
+}
+
 G4int A2Hit::GetNParticles()
 {
     // Return the number of contributing particles.
 
     G4int n = 0;
-    for (size_t i = 0; i < fPartE.size(); i++)
-        if (fPartE[i] > 0) n++;
+    for (G4int i = 0; i < fNPart; i++)
+        if (fPart[i].fEnergy > 0) n++;
     return n;
 }
 
-G4int A2Hit::GetParticle()
+void A2Hit::AddPartEnergy(G4int p, G4double energy)
 {
-    // Return the index of the particle with the highest
-    // energy deposition.
+    // Add the energy deposited by the particle with index 'p' (starting at 1)
+    // and keep track of the particle with the highest energy deposition.
 
-    G4int p = 0;
-    G4double emax = 0;
-    for (size_t i = 0; i < fPartE.size(); i++)
+    if (p < 1)
+        return;
+
+    // find the particle, add it if necessary
+    G4int i = 0;
+    while (i < fNPart && fPart[i].fIndex != p)
+        i++;
+    if (i == fNPart)
     {
-        if (fPartE[i] > emax)
+        if (fNPart == fPartCapacity)
         {
-            p = i+1;
-            emax = fPartE[i];
+            A2PartEnergy_t* part = new A2PartEnergy_t[2*fPartCapacity];
+            for (G4int j = 0; j < fNPart; j++)
+                part[j] = fPart[j];
+            if (fPart != fPartInline)
+                delete [] fPart;
+            fPart = part;
+            fPartCapacity *= 2;
         }
+        fPart[i].fIndex = p;
+        fPart[i].fEnergy = 0;
+        fNPart++;
     }
-    return p;
-}
-
-void A2Hit::AddPartEnergy(G4int p, G4double energy)
-{
-    // resize list if necessary
-    if (p > (G4int)fPartE.size())
-        fPartE.resize(p, 0.0);
 
     //G4cout << "Hit " << fID << " adding " << energy
     //       << " by particle " << p
     //       << " now at " << fEdep<< G4endl;
 
     // add energy
-    fPartE[p-1] += energy;
+    fPart[i].fEnergy += energy;
+
+    // update the running maximum
+    if (energy < 0 && i == fPartMax)
+        UpdatePartMax();
+    else if (fPartMax < 0 || fPart[i].fEnergy > fPart[fPartMax].fEnergy ||
+             (fPart[i].fEnergy == fPart[fPartMax].fEnergy && p < fPart[fPartMax].fIndex))
+        fPartMax = i;
 }
 
 void A2Hit::Print()
@@ -104,9 +220,8 @@ void A2Hit::Print()
            << " part: " << GetParticle()
            << " #part: " << GetNParticles()
            << " fPartE: ";
-    for (size_t i = 0; i < fPartE.size(); i++)
-        G4cout << fPartE[i] << "(" << i+1 << ") ";
+    for (G4int i = 0; i < fNPart; i++)
+        G4cout << fPart[i].fEnergy << "(" << fPart[i].fIndex << ") ";
 
     G4cout << G4endl;
 }
-
@@ -0,0 +1,137 @@
+// Event-scoped arena for the hits and hit collections of the sensitive detectors
+
+#include <cstdlib>
+
+#include "G4ios.hh"
+
+#include "A2HitArena.hh"
+
+G4ThreadLocal A2HitArena* A2HitArena::fgInstance = 0;
+
+//______________________________________________________________________________
+A2HitArena::A2HitArena()
+{
+    // Constructor.
+
+    // init members
+    fSegment = new A2ArenaSegment_t();
+    fSegment->fNLive = 0;
+    fSegment->fClosed = false;
+    fOffset = 0;
+    fNBlocks = 0;
+    fNKept = 0;
+    fNEvents = 0;
+    fNRecycled = 0;
+    fNObjects = 0;
+    fNHeapAllocs = 0;
+    fNEventHeapAllocs = 0;
+    fNHeapAllocsAtEvent = 0;
+    fMaxUsed = 0;
+}
+
+//______________________________________________________________________________
+A2HitArena::~A2HitArena()
+{
+    // Destructor. The segments of kept events are released by their objects.
+
+    for (size_t i = 0; i < fSegment->fBlocks.size(); i++)
+        free(fSegment->fBlocks[i].fData);
+    delete fSegment;
+    for (size_t i = 0; i < fFree.size(); i++)
+        free(fFree[i].fData);
+}
+
+//______________________________________________________________________________
+void* A2HitArena::AllocateBlock(size_t size)
+{
+    // Continue the current event in a new block with at least 'size' bytes,
+    // taken from the blocks of released events if possible.
+
+    // reuse a free block if large enough
+    A2ArenaBlock_t block;
+    block.fData = 0;
+    for (size_t i = 0; i < fFree.size(); i++)
+    {
+        if (size <= fFree[i].fSize)
+        {
+            block = fFree[i];
+            fFree[i] = fFree.back();
+            fFree.pop_back();
+            break;
+        }
+    }
+
+    // allocate a new block
+    if (!block.fData)
+    {
+        block.fSize = size > kBlockSize ? size : kBlockSize;
+        block.fData = static_cast<char*>(malloc(block.fSize));
+        if (!block.fData)
+        {
+            G4cout << "A2HitArena::AllocateBlock(): Could not allocate " << block.fSize << " bytes!" << G4endl;
+            exit(1);
+        }
+        fNHeapAllocs++;
+        fNBlocks++;
+    }
+
+    fSegment->fBlocks.push_back(block);
+    fOffset = size;
+    return block.fData;
+}
+
+//______________________________________________________________________________
+void A2HitArena::Recycle(A2ArenaSegment_t* seg)
+{
+    // Reuse the blocks of the ended event of the segment 'seg', whose objects
+    // were all released.
+
+    fFree.insert(fFree.end(), seg->fBlocks.begin(), seg->fBlocks.end());
+    delete seg;
+    fNRecycled++;
+}
+
+//______________________________________________________________________________
+void A2HitArena::EndOfEvent()
+{
+    // Close the segment of the current event and start a new one for the next
+    // event. Count the events needing heap allocations.
+
+    size_t used = fOffset;
+    for (size_t i = 0; i + 1 < fSegment->fBlocks.size(); i++)
+        used += fSegment->fBlocks[i].fSize;
+    if (used > fMaxUsed) fMaxUsed = used;
+
+    // the blocks are reused when the last object of the event is released
+    fSegment->fClosed = true;
+    if (fSegment->fNLive == 0)
+        Recycle(fSegment);
+    else
+        fNKept++;
+    fSegment = new A2ArenaSegment_t();
+    fSegment->fNLive = 0;
+    fSegment->fClosed = false;
+    fOffset = 0;
+
+    if (fNHeapAllocs > fNHeapAllocsAtEvent) fNEventHeapAllocs++;
+    fNHeapAllocsAtEvent = fNHeapAllocs;
+    fNEvents++;
+}
+
+//______________________________________________________________________________
+void A2HitArena::PrintStatistics()
+{
+    // Print the allocation statistics of the arena of this thread and reset them.
+
+    G4cout << "A2HitArena::PrintStatistics(): " << fNObjects << " hits/collections in " << fNEvents
+           << " events, " << fNHeapAllocs << " heap allocations in " << fNEventHeapAllocs << " events, "
+           << fNBlocks << " blocks, max. " << fMaxUsed/1024. << " kB used per event, "
+           << fNRecycled << " events reused, " << fNKept << " events still alive" << G4endl;
+
+    fNEvents = 0;
+    fNRecycled = 0;
+    fNObjects = 0;
+    fNHeapAllocs = 0;
+    fNEventHeapAllocs = 0;
+    fNHeapAllocsAtEvent = 0;
+}
@@ -1,12 +1,27 @@
 #include <fstream>
+#include <cstdlib>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "TString.h"
 #include "A2MagneticField.hh"
 #include "G4FieldManager.hh"
 #include "G4TransportationManager.hh"
 #include "CLHEP/Units/SystemOfUnits.h"
+#include "CLHEP/Random/MTwistEngine.h"
 
 using namespace CLHEP;
 
+const char A2MagneticField::fgBinaryMagic[8] = { 'A', '2', 'F', 'M', 'A', 'P', 0, 0 };
+const uint32_t A2MagneticField::fgBinaryVersion = 1;
+const size_t A2MagneticField::fgBinaryDataOffset = 256;
+const G4double A2MagneticField::fgAxialTolerance = 1e-2;
+
 //______________________________________________________________________________________________________
 // G4FieldManager*  A2MagneticField::GetGlobalFieldManager()
 // {
@@ -16,7 +31,16 @@ using namespace CLHEP;
 //______________________________________________________________________________________________________
 A2MagneticField::A2MagneticField()
 {
-  fFieldMap = NULL;
+  fField = NULL;
+  fMapping = NULL;
+  fMappingSize = 0;
+  fSourceSize = -1;
+  fSourceTime = -1;
+  fStorage = kFieldFull;
+  fAxialN = 0;
+  fAxialStep = 0;
+  fAxialInvStep = 0;
+  fTrilinear = false;
   
   //
 //   GetGlobalFieldManager()->SetDetectorField(this);
@@ -27,27 +51,226 @@ A2MagneticField::A2MagneticField()
 A2MagneticField::~A2MagneticField()
 {
   // Deallocate memory
-  if(fFieldMap)
+  ReleaseFieldMap();
+}
+
+//______________________________________________________________________________________________________
+// Free or unmap the field map
+void A2MagneticField::ReleaseFieldMap()
+{
+  if(fMapping) munmap(fMapping, fMappingSize);
+  else if(fField) free(const_cast<G4double*>(fField));
+  fField = NULL;
+  fMapping = NULL;
+  fMappingSize = 0;
+}
+
+//______________________________________________________________________________________________________
+// Free the float and axial maps and use the 3D map
+void A2MagneticField::ClearStorage()
+{
+  fStorage = kFieldFull;
+  std::vector<float>().swap(fFieldFloat);
+  std::vector<G4double>().swap(fFieldAxial);
+}
+
+//______________________________________________________________________________________________________
+// Allocate the field map array for fPointsN grid points and set the strides
+G4double* A2MagneticField::AllocateFieldMap()
+{
+  ReleaseFieldMap();
+  ClearStorage();
+
+  // x slowest, z fastest
+  fStride[2] = 3;
+  fStride[1] = fStride[2]*fPointsN[2];
+  fStride[0] = fStride[1]*fPointsN[1];
+
+  // Align to the cache line size
+  size_t size = (size_t)fStride[0]*fPointsN[0]*sizeof(G4double);
+  void* mem = NULL;
+  if(posix_memalign(&mem, 64, size)) return NULL;
+  G4double* field = static_cast<G4double*>(mem);
+  for(size_t i=0; i<size/sizeof(G4double); ++i) field[i] = 0.;
+  fField = field;
+  return field;
+}
+
+//______________________________________________________________________________________________________
+// FNV-1a checksum of the field values (64-bit words)
+uint64_t A2MagneticField::Checksum(const G4double* values, uint64_t n)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  for(uint64_t i=0; i<n; ++i)
   {
-    for(int i=0; i<fPointsN[0]; ++i)
-    {
-      for(int j=0; j<fPointsN[1]; ++j)
-      {
-	delete [] fFieldMap[i][j];
-      }
-      delete [] fFieldMap[i];
-    }
-    delete [] fFieldMap;
+    uint64_t w;
+    memcpy(&w, values+i, sizeof(w));
+    hash ^= w;
+    hash *= 1099511628211ULL;
   }
+  return hash;
 }
 
 //______________________________________________________________________________________________________
-// Read field map from a field_map.dat file and fill fFieldMap array
+// Read the field map: binary maps are memory-mapped, text maps are taken from their binary cache
 G4bool A2MagneticField::ReadFieldMap(const G4String &nameFileMap)
+{
+  TString name(nameFileMap.data());
+
+  // Binary map
+  if (name.EndsWith(".a2fmap")) return MapBinaryMap(nameFileMap);
+
+  // Text map: use the cache file if it was converted from the current text map
+  struct stat st;
+  if (stat(name.Data(), &st))
+  {
+    G4cout << "A2MagneticField::ReadFieldMap() **ERROR** - File " << nameFileMap << " not found." << G4endl;
+    return false;
+  }
+  G4String cacheName = GetCacheName(nameFileMap);
+  if (access(cacheName.c_str(), R_OK) == 0 && MapBinaryMap(cacheName, st.st_size, st.st_mtime)) return true;
+
+  // Parse the text map and write the cache file for the next jobs
+  if (!ReadTextMap(nameFileMap)) return false;
+  WriteBinaryMap(cacheName);
+  return true;
+}
+
+//______________________________________________________________________________________________________
+// Memory-map a binary field map read-only
+G4bool A2MagneticField::MapBinaryMap(const G4String &nameFileMap, G4long srcSize, G4long srcTime)
+{
+  G4cout.setf(std::ios_base::unitbuf);
+  G4cout << "A2MagneticField::MapBinaryMap() Mapping target magnetic field map " << nameFileMap << "...";
+
+  ReleaseFieldMap();
+  ClearStorage();
+
+  // Map the whole file
+  int fd = open(nameFileMap.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    G4cout << " **ERROR** - File " << nameFileMap << " not found." << G4endl;
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) || (size_t)st.st_size < fgBinaryDataOffset)
+  {
+    G4cout << " **ERROR** - File too short." << G4endl;
+    close(fd);
+    return false;
+  }
+  void* map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED)
+  {
+    G4cout << " **ERROR** - mmap() failed." << G4endl;
+    return false;
+  }
+
+  // Check the header
+  const A2FieldMapHeader_t* h = static_cast<const A2FieldMapHeader_t*>(map);
+  const char* error = 0;
+  if (memcmp(h->fMagic, fgBinaryMagic, sizeof(fgBinaryMagic)) || h->fVersion != fgBinaryVersion ||
+      h->fValueSize != sizeof(G4double))
+    error = "Unknown file format";
+  else if (h->fNValues != 3ULL*h->fPointsN[0]*h->fPointsN[1]*h->fPointsN[2] ||
+           (uint64_t)st.st_size < fgBinaryDataOffset + h->fNValues*sizeof(G4double))
+    error = "Inconsistent grid description";
+  else if (srcSize >= 0 && (h->fSourceSize != srcSize || h->fSourceTime != srcTime))
+    error = "Outdated cache file";
+  else if (Checksum((const G4double*)((const char*)map + fgBinaryDataOffset), h->fNValues) != h->fChecksum)
+    error = "Checksum mismatch";
+  if (error)
+  {
+    G4cout << " **ERROR** - " << error << "." << G4endl;
+    munmap(map, st.st_size);
+    return false;
+  }
+
+  // Set the grid
+  for(G4int i=0; i<3; ++i)
+  {
+    fPointMin[i]  = h->fPointMin[i];
+    fPointMax[i]  = h->fPointMax[i];
+    fPointStep[i] = h->fPointStep[i];
+    fPointsN[i]   = h->fPointsN[i];
+    fInvStep[i]   = 1./fPointStep[i];
+  }
+  fStride[2] = 3;
+  fStride[1] = fStride[2]*fPointsN[2];
+  fStride[0] = fStride[1]*fPointsN[1];
+  fSourceSize = h->fSourceSize;
+  fSourceTime = h->fSourceTime;
+
+  fMapping = map;
+  fMappingSize = st.st_size;
+  fField = (const G4double*)((const char*)map + fgBinaryDataOffset);
+
+  G4cout << " OK (" << h->fNValues/3 << " data points)" << G4endl;
+  return true;
+}
+
+//______________________________________________________________________________________________________
+// Write the field map in the binary format
+G4bool A2MagneticField::WriteBinaryMap(const G4String &nameFileMap) const
+{
+  if (!fField) return false;
+
+  // Header
+  A2FieldMapHeader_t h;
+  memset(&h, 0, sizeof(h));
+  memcpy(h.fMagic, fgBinaryMagic, sizeof(fgBinaryMagic));
+  h.fVersion = fgBinaryVersion;
+  h.fValueSize = sizeof(G4double);
+  for(G4int i=0; i<3; ++i)
+  {
+    h.fPointsN[i]   = fPointsN[i];
+    h.fPointMin[i]  = fPointMin[i];
+    h.fPointMax[i]  = fPointMax[i];
+    h.fPointStep[i] = fPointStep[i];
+  }
+  h.fNValues = 3ULL*fPointsN[0]*fPointsN[1]*fPointsN[2];
+  h.fChecksum = Checksum(fField, h.fNValues);
+  h.fSourceSize = fSourceSize;
+  h.fSourceTime = fSourceTime;
+
+  // Write to a temporary file and rename it, so that concurrent jobs never see a partial file
+  TString tmpName = TString::Format("%s.%d.tmp", nameFileMap.c_str(), (G4int)getpid());
+  FILE* fout = fopen(tmpName.Data(), "wb");
+  if (!fout)
+  {
+    G4cout << "A2MagneticField::WriteBinaryMap() Could not write the binary field map " << nameFileMap << G4endl;
+    return false;
+  }
+  std::vector<char> pad(fgBinaryDataOffset, 0);
+  memcpy(&pad[0], &h, sizeof(h));
+  G4bool ok = fwrite(&pad[0], 1, pad.size(), fout) == pad.size() &&
+              fwrite(fField, sizeof(G4double), h.fNValues, fout) == h.fNValues;
+  ok = (fclose(fout) == 0) && ok;
+  if (!ok || rename(tmpName.Data(), nameFileMap.c_str()))
+  {
+    G4cout << "A2MagneticField::WriteBinaryMap() Could not write the binary field map " << nameFileMap << G4endl;
+    remove(tmpName.Data());
+    return false;
+  }
+
+  G4cout << "A2MagneticField::WriteBinaryMap() Wrote the binary field map " << nameFileMap << G4endl;
+  return true;
+}
+
+//______________________________________________________________________________________________________
+// Read field map from a field_map.dat file and fill the field map array
+G4bool A2MagneticField::ReadTextMap(const G4String &nameFileMap)
 {
   // Print info
   G4cout.setf(std::ios_base::unitbuf);
-  G4cout << "A2MagneticField::ReadFieldMap() Reading target magnetic field map " << nameFileMap;
+  G4cout << "A2MagneticField::ReadTextMap() Reading target magnetic field map " << nameFileMap;
+
+  // Remember size and modification time for the binary cache
+  struct stat st;
+  fSourceSize = stat(nameFileMap.c_str(), &st) ? -1 : st.st_size;
+  fSourceTime = fSourceSize < 0 ? -1 : st.st_mtime;
 
   // Open input stream
   FILE* fin = 0;
@@ -87,17 +310,17 @@ G4bool A2MagneticField::ReadFieldMap(const G4String &nameFileMap)
     fPointMin[i]   = fPointMin[i]*cm - fPointStep[i]/2.;
     fPointMax[i]   = fPointMax[i]*cm + fPointStep[i]/2.;
     fPointsN[i]    = ceil((fPointMax[i] - fPointMin[i])/fPointStep[i]);
+    fInvStep[i]    = 1./fPointStep[i];
   }
 
-  // Allocate memory for fFieldMap
-  fFieldMap = new A2Bvector**[fPointsN[0]];
-  for(int i=0; i<fPointsN[0]; ++i)
+  // Allocate memory for the field map
+  G4double* field = AllocateFieldMap();
+  if(!field)
   {
-    fFieldMap[i] = new A2Bvector*[fPointsN[1]];
-    for(int j=0; j<fPointsN[1]; ++j)
-    {
-      fFieldMap[i][j] = new A2Bvector[fPointsN[2]];
-    }
+    G4cout << " **ERROR** - Could not allocate the field map." << G4endl;
+    if (name.EndsWith(".xz")) pclose(fin);
+    else fclose(fin);
+    return false;
   }
 
   // Read the magnetic field map
@@ -120,11 +343,21 @@ G4bool A2MagneticField::ReadFieldMap(const G4String &nameFileMap)
     iPoint[0] = GetPointIndex(p[0]*cm,fPointMin[0],fPointStep[0]); // index x
     iPoint[1] = GetPointIndex(p[1]*cm,fPointMin[1],fPointStep[1]); // index y
     iPoint[2] = GetPointIndex(p[2]*cm,fPointMin[2],fPointStep[2]); // index z
+    if(iPoint[0] < 0 || iPoint[0] >= fPointsN[0] ||
+       iPoint[1] < 0 || iPoint[1] >= fPointsN[1] ||
+       iPoint[2] < 0 || iPoint[2] >= fPointsN[2])
+    {
+      G4cout << " **ERROR** - Data point outside of the grid." << G4endl;
+      if (name.EndsWith(".xz")) pclose(fin);
+      else fclose(fin);
+      return false;
+    }
 
-    // Fill the fFiledMap array
-    fFieldMap[iPoint[0]][iPoint[1]][iPoint[2]][0] = b[0]*gauss; // Bx
-    fFieldMap[iPoint[0]][iPoint[1]][iPoint[2]][1] = b[1]*gauss; // By
-    fFieldMap[iPoint[0]][iPoint[1]][iPoint[2]][2] = b[2]*gauss; // Bz
+    // Fill the field map array
+    G4double* f = field + iPoint[0]*fStride[0] + iPoint[1]*fStride[1] + iPoint[2]*fStride[2];
+    f[0] = b[0]*gauss; // Bx
+    f[1] = b[1]*gauss; // By
+    f[2] = b[2]*gauss; // Bz
 
     nline++;
   }
@@ -153,23 +386,289 @@ void A2MagneticField::GetFieldValue(const G4double point[4], G4double *field) co
 {
   // Set default magnetic field
   field[0] = field[1] = field[2] = 0.;
-  
+
   // Check bounds
   if(point[0] < fPointMin[0] || point[0] > fPointMax[0]) return; // x
   if(point[1] < fPointMin[1] || point[1] > fPointMax[1]) return; // y
   if(point[2] < fPointMin[2] || point[2] > fPointMax[2]) return; // z
-  
-  // Get indexes of fFieldMap array which correspond to the point
-  G4int iPoint[3] = {
-                     GetPointIndex(point[0],fPointMin[0],fPointStep[0]), // x
-                     GetPointIndex(point[1],fPointMin[1],fPointStep[1]), // y
-                     GetPointIndex(point[2],fPointMin[2],fPointStep[2])  // z
-                    };
-  
+
   // Set field
-  field[0] = fFieldMap[iPoint[0]][iPoint[1]][iPoint[2]][0];
-  field[1] = fFieldMap[iPoint[0]][iPoint[1]][iPoint[2]][1];
-  field[2] = fFieldMap[iPoint[0]][iPoint[1]][iPoint[2]][2];
+  if(fStorage == kFieldAxial) InterpolateAxial(point, fTrilinear, field);
+  else if(fStorage == kFieldFloat) Interpolate3D(&fFieldFloat[0], point, fTrilinear, field);
+  else Interpolate3D(fField, point, fTrilinear, field);
+}
+
+//______________________________________________________________________________________________________
+// Get the field of the 3D map 'data' (Bx,By,Bz of type T) at the point inside the map
+template <typename T>
+void A2MagneticField::Interpolate3D(const T* data, const G4double* point, G4bool trilinear, G4double* field) const
+{
+  if(!trilinear)
+  {
+    // Offset of the nearest grid point (the upper bound belongs to the last cell)
+    G4int offset = 0;
+    for(G4int k=0; k<3; ++k)
+    {
+      G4int i = (point[k] - fPointMin[k])*fInvStep[k];
+      if(i >= fPointsN[k]) i = fPointsN[k] - 1;
+      offset += i*fStride[k];
+    }
+
+    const T* f = data + offset;
+    field[0] = f[0];
+    field[1] = f[1];
+    field[2] = f[2];
+    return;
+  }
+
+  // Lower grid point, fractional position and offset to the upper grid point in x,y,z
+  // (grid points are at the cell centres, the field is constant beyond the outer grid points)
+  G4int offset = 0;
+  G4int d[3];
+  G4double u[3];
+  for(G4int k=0; k<3; ++k)
+  {
+    G4double t = (point[k] - fPointMin[k])*fInvStep[k] - 0.5;
+    G4int i;
+    if(t <= 0.) { i = 0; u[k] = 0.; }
+    else if(t >= fPointsN[k] - 1) { i = fPointsN[k] - 1; u[k] = 0.; }
+    else { i = t; u[k] = t - i; }
+    offset += i*fStride[k];
+    d[k] = i < fPointsN[k] - 1 ? fStride[k] : 0;
+  }
+
+  // Interpolate along x, y and z
+  const T* f = data + offset;
+  for(G4int j=0; j<3; ++j)
+  {
+    G4double f00 = f[j]           + u[0]*(f[j+d[0]]           - f[j]);
+    G4double f10 = f[j+d[1]]      + u[0]*(f[j+d[1]+d[0]]      - f[j+d[1]]);
+    G4double f01 = f[j+d[2]]      + u[0]*(f[j+d[2]+d[0]]      - f[j+d[2]]);
+    G4double f11 = f[j+d[2]+d[1]] + u[0]*(f[j+d[2]+d[1]+d[0]] - f[j+d[2]+d[1]]);
+    G4double f0 = f00 + u[1]*(f10 - f00);
+    G4double f1 = f01 + u[1]*(f11 - f01);
+    field[j] = f0 + u[2]*(f1 - f0);
+  }
+}
+
+//______________________________________________________________________________________________________
+// Get the field of the axially symmetric (r,z) map at the point inside the map
+void A2MagneticField::InterpolateAxial(const G4double* point, G4bool trilinear, G4double* field) const
+{
+  G4double r = sqrt(point[0]*point[0] + point[1]*point[1]);
+  G4double tr = r*fAxialInvStep;                                  // r grid points at i*step
+  G4double tz = (point[2] - fPointMin[2])*fInvStep[2] - 0.5;      // z grid points as in the 3D map
+  G4double br, bz;
+
+  if(!trilinear)
+  {
+    G4int ir = tr + 0.5;
+    G4int iz = tz + 0.5;
+    if(ir >= fAxialN) ir = fAxialN - 1;
+    if(iz < 0) iz = 0;
+    if(iz >= fPointsN[2]) iz = fPointsN[2] - 1;
+    const G4double* f = &fFieldAxial[2*(ir*fPointsN[2] + iz)];
+    br = f[0];
+    bz = f[1];
+  }
+  else
+  {
+    // Bilinear interpolation in r and z
+    G4int ir, iz;
+    G4double ur, uz;
+    if(tr >= fAxialN - 1) { ir = fAxialN - 1; ur = 0.; }
+    else { ir = tr; ur = tr - ir; }
+    if(tz <= 0.) { iz = 0; uz = 0.; }
+    else if(tz >= fPointsN[2] - 1) { iz = fPointsN[2] - 1; uz = 0.; }
+    else { iz = tz; uz = tz - iz; }
+    G4int dr = ir < fAxialN - 1 ? 2*fPointsN[2] : 0;
+    G4int dz = iz < fPointsN[2] - 1 ? 2 : 0;
+    const G4double* f = &fFieldAxial[2*(ir*fPointsN[2] + iz)];
+    G4double b[2];
+    for(G4int j=0; j<2; ++j)
+    {
+      G4double f0 = f[j]    + ur*(f[j+dr]    - f[j]);
+      G4double f1 = f[j+dz] + ur*(f[j+dr+dz] - f[j+dz]);
+      b[j] = f0 + uz*(f1 - f0);
+    }
+    br = b[0];
+    bz = b[1];
+  }
+
+  // Radial component along the direction of the point
+  if(r > 0.)
+  {
+    field[0] = br*point[0]/r;
+    field[1] = br*point[1]/r;
+  }
+  field[2] = bz;
+}
+
+//______________________________________________________________________________________________________
+// Convert the loaded 3D map into the storage 'storage' (full, float, axial or auto), report the memory
+// footprint and the maximum deviation from the 3D map and free the 3D map if it is not used anymore
+G4bool A2MagneticField::SetStorage(const G4String& storage)
+{
+  if(!fField)
+  {
+    G4cout << "A2MagneticField::SetStorage() **ERROR** - No 3D field map loaded." << G4endl;
+    return false;
+  }
+  if(storage != "full" && storage != "float" && storage != "axial" && storage != "auto")
+  {
+    G4cout << "A2MagneticField::SetStorage() **ERROR** - Unknown field map storage '" << storage << "'." << G4endl;
+    return false;
+  }
+
+  G4long nPoints = (G4long)fPointsN[0]*fPointsN[1]*fPointsN[2];
+  G4double fullSize = 3.*nPoints*sizeof(G4double);
+  if(storage == "full")
+  {
+    G4cout << "A2MagneticField::SetStorage() Using the full 3D field map (" << fullSize/1024./1024. << " MB)" << G4endl;
+    return true;
+  }
+
+  // Build the alternative representation
+  if(storage == "float")
+  {
+    fFieldFloat.assign(fField, fField + 3*nPoints);
+  }
+  else
+  {
+    // Axial grid: r points at multiples of half the x,y step up to the largest radius of the map,
+    // z points of the 3D map
+    fAxialStep = std::min(fPointStep[0], fPointStep[1])/2.;
+    fAxialInvStep = 1./fAxialStep;
+    G4double lo[2], hi[2], rMax2 = 0.;
+    for(G4int k=0; k<2; ++k)
+    {
+      lo[k] = fPointMin[k] + fPointStep[k]/2.;
+      hi[k] = fPointMax[k] - fPointStep[k]/2.;
+      rMax2 += std::max(lo[k]*lo[k], hi[k]*hi[k]);
+    }
+    fAxialN = ceil(sqrt(rMax2)*fAxialInvStep) + 1;
+
+    // Average Br and Bz of the 3D map over the azimuth (where inside the 3D grid)
+    const G4int nPhi = 16;
+    fFieldAxial.assign(2*fAxialN*fPointsN[2], 0.);
+    for(G4int ir=0; ir<fAxialN; ++ir)
+    {
+      G4double r = ir*fAxialStep;
+      for(G4int iz=0; iz<fPointsN[2]; ++iz)
+      {
+        G4double p[3], b[3], sum[2] = { 0., 0. };
+        G4int n = 0;
+        p[2] = fPointMin[2] + (iz + 0.5)*fPointStep[2];
+        for(G4int iphi=0; iphi<nPhi; ++iphi)
+        {
+          G4double phi = iphi*twopi/nPhi;
+          p[0] = r*cos(phi);
+          p[1] = r*sin(phi);
+          if(p[0] < lo[0] - 1e-9 || p[0] > hi[0] + 1e-9 || p[1] < lo[1] - 1e-9 || p[1] > hi[1] + 1e-9) continue;
+          Interpolate3D(fField, p, true, b);
+          sum[0] += b[0]*cos(phi) + b[1]*sin(phi);
+          sum[1] += b[2];
+          n++;
+        }
+        G4double* f = &fFieldAxial[2*(ir*fPointsN[2] + iz)];
+        if(n)
+        {
+          f[0] = sum[0]/n;
+          f[1] = sum[1]/n;
+        }
+        else if(ir)
+        {
+          f[0] = f[-2*fPointsN[2]];
+          f[1] = f[-2*fPointsN[2]+1];
+        }
+      }
+    }
+  }
+  EA2FieldStorage newStorage = storage == "float" ? kFieldFloat : kFieldAxial;
+  G4double newSize = newStorage == kFieldFloat ? fFieldFloat.size()*sizeof(float) :
+                                                 fFieldAxial.size()*sizeof(G4double);
+
+  // Maximum deviation from the 3D map at its grid points (interpolated)
+  G4double maxDev = 0., maxB = 0.;
+  for(G4int ix=0; ix<fPointsN[0]; ++ix)
+  {
+    for(G4int iy=0; iy<fPointsN[1]; ++iy)
+    {
+      for(G4int iz=0; iz<fPointsN[2]; ++iz)
+      {
+        G4double p[3] = { fPointMin[0] + (ix + 0.5)*fPointStep[0],
+                          fPointMin[1] + (iy + 0.5)*fPointStep[1],
+                          fPointMin[2] + (iz + 0.5)*fPointStep[2] };
+        G4double b[3] = { 0., 0., 0. };
+        if(newStorage == kFieldFloat) Interpolate3D(&fFieldFloat[0], p, true, b);
+        else InterpolateAxial(p, true, b);
+        const G4double* f = fField + ix*fStride[0] + iy*fStride[1] + iz*fStride[2];
+        G4double dev2 = 0., b2 = 0.;
+        for(G4int j=0; j<3; ++j)
+        {
+          dev2 += (b[j] - f[j])*(b[j] - f[j]);
+          b2 += f[j]*f[j];
+        }
+        maxDev = std::max(maxDev, sqrt(dev2));
+        maxB = std::max(maxB, sqrt(b2));
+      }
+    }
+  }
+
+  G4cout << "A2MagneticField::SetStorage() " << (newStorage == kFieldFloat ? "Float 3D" : "Axial (r,z)")
+         << " field map: " << newSize/1024./1024. << " MB instead of " << fullSize/1024./1024.
+         << " MB, max. deviation " << maxDev/tesla << " T (" << (maxB > 0 ? 100.*maxDev/maxB : 0.)
+         << "% of max. |B| = " << maxB/tesla << " T)" << G4endl;
+
+  // Automatic selection: axial only if the map is axially symmetric within the tolerance
+  if(storage == "auto" && maxDev > fgAxialTolerance*maxB)
+  {
+    G4cout << "A2MagneticField::SetStorage() Field map not axially symmetric, using the full 3D field map" << G4endl;
+    fFieldAxial.clear();
+    return true;
+  }
+
+  // Use the new representation and free the 3D map
+  fStorage = newStorage;
+  ReleaseFieldMap();
+  return true;
+}
+
+//______________________________________________________________________________________________________
+// Measure the number of GetFieldValue() calls per second at random points of the map
+void A2MagneticField::Benchmark(G4int nCalls)
+{
+  if((fStorage == kFieldFull && !fField) || nCalls <= 0) return;
+
+  // Random points inside the map (own engine, the event seeds are not affected)
+  const G4int nPoints = 4096;
+  CLHEP::MTwistEngine engine(12345);
+  std::vector<G4double> points(4*nPoints);
+  for(G4int i=0; i<nPoints; ++i)
+  {
+    for(G4int k=0; k<3; ++k)
+      points[4*i+k] = fPointMin[k] + engine.flat()*(fPointMax[k] - fPointMin[k]);
+    points[4*i+3] = 0.;
+  }
+
+  // Time both modes
+  G4bool trilinear = fTrilinear;
+  for(G4int mode=0; mode<2; ++mode)
+  {
+    fTrilinear = mode;
+    G4double b[3], sum = 0.;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(G4int i=0; i<nCalls; ++i)
+    {
+      GetFieldValue(&points[4*(i & (nPoints-1))], b);
+      sum += b[2];
+    }
+    G4double t = std::chrono::duration<G4double>(std::chrono::steady_clock::now() - start).count();
+    G4cout << "A2MagneticField::Benchmark() " << (mode ? "trilinear" : "nearest grid point") << ": "
+           << nCalls << " calls in " << t << " s = " << (t > 0 ? nCalls/t : 0) << " calls/s (mean Bz = "
+           << sum/nCalls/tesla << " T)" << G4endl;
+  }
+  fTrilinear = trilinear;
 }
 
 //______________________________________________________________________________________________________
@@ -0,0 +1,141 @@
+// Shared cache of Geant4 particle definitions indexed by PDG code
+
+#include "G4ParticleDefinition.hh"
+#include "G4ParticleTable.hh"
+#include "G4IonTable.hh"
+#include "G4AutoLock.hh"
+
+#include "A2ParticleCache.hh"
+
+namespace { G4Mutex instanceMutex = G4MUTEX_INITIALIZER; }
+
+A2ParticleCache* A2ParticleCache::fgInstance = 0;
+G4ThreadLocal std::unordered_map<G4int, G4ParticleDefinition*>* A2ParticleCache::fgThreadIons = 0;
+
+//______________________________________________________________________________
+A2ParticleCache::A2ParticleCache()
+    : fDense(2*kDenseMax-1, 0)
+{
+    // Constructor.
+    // Fill the cache with all particles of the particle table, which has to be
+    // set up by the physics list.
+
+    G4MUTEXINIT(fMutex);
+
+    // loop over particle table
+    G4ParticleTable::G4PTblDicIterator* it = G4ParticleTable::GetParticleTable()->GetIterator();
+    it->reset();
+    while ((*it)())
+    {
+        G4ParticleDefinition* partDef = it->value();
+        G4int pdg = partDef->GetPDGEncoding();
+        if (pdg == 0)
+            continue;
+        else if (pdg > -kDenseMax && pdg < kDenseMax)
+            fDense[pdg + kDenseMax - 1] = partDef;
+        else
+            fIons[pdg] = partDef;
+    }
+}
+
+//______________________________________________________________________________
+A2ParticleCache* A2ParticleCache::Instance()
+{
+    // Return the shared instance, which is created by the first call.
+    // (the lock is only taken by the first call of every thread)
+
+    static G4ThreadLocal A2ParticleCache* instance = 0;
+    if (!instance)
+    {
+        G4AutoLock lock(&instanceMutex);
+        if (!fgInstance)
+            fgInstance = new A2ParticleCache();
+        instance = fgInstance;
+    }
+    return instance;
+}
+
+//______________________________________________________________________________
+G4ParticleDefinition* A2ParticleCache::Find(G4int pdg, G4bool create)
+{
+    // Return the Geant4 particle definition of the particle with the PDG
+    // code 'pdg' or 0 if it is not known.
+    // If 'create' is true, missing ions are created and unknown codes are
+    // counted (Geant4 threads only). Otherwise, only cached particles are
+    // returned, which can be done from any thread.
+
+    // check for invalid code
+    if (pdg == 0)
+        return 0;
+
+    // particles with small codes are never created later
+    if (pdg > -kDenseMax && pdg < kDenseMax)
+    {
+        G4ParticleDefinition* partDef = fDense[pdg + kDenseMax - 1];
+        if (!partDef && create)
+        {
+            G4AutoLock lock(&fMutex);
+            fUnknown[pdg]++;
+        }
+        return partDef;
+    }
+
+    // look-up particle of the particle table (not modified after the construction)
+    std::unordered_map<G4int, G4ParticleDefinition*>::const_iterator it = fIons.find(pdg);
+    if (it != fIons.end())
+        return it->second;
+
+    // look-up ion created by this thread
+    if (!fgThreadIons)
+        fgThreadIons = new std::unordered_map<G4int, G4ParticleDefinition*>();
+    it = fgThreadIons->find(pdg);
+    if (it != fgThreadIons->end())
+    {
+        if (!it->second && create)
+        {
+            G4AutoLock lock(&fMutex);
+            fUnknown[pdg]++;
+        }
+        return it->second;
+    }
+    if (!create)
+        return 0;
+
+    // create ion
+    // (every thread calls GetIon() itself, so that the ion is registered in
+    // the thread-local ion list and process manager of this thread)
+    G4ParticleDefinition* partDef = 0;
+    G4int Z, A, L, J;
+    G4double E;
+    if (G4IonTable::GetNucleusByEncoding(pdg, Z, A, L, E, J))
+        partDef = G4ParticleTable::GetParticleTable()->GetIonTable()->GetIon(Z, A, L, 0.0, J);
+    if (!partDef)
+    {
+        G4AutoLock lock(&fMutex);
+        fUnknown[pdg]++;
+    }
+    (*fgThreadIons)[pdg] = partDef;
+
+    return partDef;
+}
+
+//______________________________________________________________________________
+void A2ParticleCache::PrintUnknown()
+{
+    // Print a summary of the unknown PDG codes looked up since the last call
+    // and reset the counters.
+
+    if (!fgInstance)
+        return;
+
+    G4AutoLock lock(&fgInstance->fMutex);
+    if (fgInstance->fUnknown.empty())
+        return;
+
+    G4cout << "A2ParticleCache::PrintUnknown(): Undefined particles were not tracked:" << G4endl;
+    for (std::map<G4int, G4long>::const_iterator it = fgInstance->fUnknown.begin();
+         it != fgInstance->fUnknown.end(); ++it)
+        G4cout << "  PDG ID " << it->first << " : " << it->second << " times" << G4endl;
+    fgInstance->fUnknown.clear();
+}
+
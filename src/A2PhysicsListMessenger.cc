@@ -45,8 +45,19 @@
 
 #include "A2PhysicsListMessenger.hh"
 
+#include <sstream>
+
 #include "A2PhysicsList.hh"
+#include "A2CBShowerModel.hh"
+#include "A2TAPSShowerModel.hh"
+#include "A2ShowerLibrary.hh"
+#include "A2StackingAction.hh"
+#include "A2TrackKiller.hh"
+#include "A2SteppingAction.hh"
 #include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4UIcmdWithADouble.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithAnInteger.hh"
 #include "G4UIcmdWithAString.hh"
 #include "G4UIcmdWithoutParameter.hh"
 #include "G4UImanager.hh"
@@ -120,6 +131,98 @@ A2PhysicsListMessenger::A2PhysicsListMessenger(A2PhysicsList* pPhys)
   fRegCmd->SetGuidance("Select region to set cut for");
   fRegCmd->SetParameterName("Region",false);
   fRegCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fFastCBCmd = new G4UIcmdWithABool("/A2/physics/FastCBShower",this);
+  fFastCBCmd->SetGuidance("Parameterise the showers of e+-/gamma in the CB crystals instead of tracking them");
+  fFastCBCmd->SetParameterName("FastCB",false);
+  fFastCBCmd->AvailableForStates(G4State_PreInit);
+
+  fFastCBMinECmd = new G4UIcmdWithADoubleAndUnit("/A2/physics/FastCBShowerMinEnergy",this);
+  fFastCBMinECmd->SetGuidance("Minimum kinetic energy of e+-/gamma for parameterised CB showers");
+  fFastCBMinECmd->SetParameterName("Emin",false);
+  fFastCBMinECmd->SetUnitCategory("Energy");
+  fFastCBMinECmd->SetRange("Emin>=0.0");
+  fFastCBMinECmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fFastCBSpotECmd = new G4UIcmdWithADoubleAndUnit("/A2/physics/FastCBShowerSpotEnergy",this);
+  fFastCBSpotECmd->SetGuidance("Energy of one energy spot of the parameterised CB showers");
+  fFastCBSpotECmd->SetParameterName("Espot",false);
+  fFastCBSpotECmd->SetUnitCategory("Energy");
+  fFastCBSpotECmd->SetRange("Espot>0.0");
+  fFastCBSpotECmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fTAPSLibCmd = new G4UIcmdWithAString("/A2/physics/TAPSShowerLibrary",this);
+  fTAPSLibCmd->SetGuidance("Use the frozen showers of this shower library for e+-/gamma entering the TAPS crystals");
+  fTAPSLibCmd->SetParameterName("file",false);
+  fTAPSLibCmd->AvailableForStates(G4State_PreInit);
+
+  fTAPSLibRecCmd = new G4UIcmdWithAString("/A2/physics/TAPSShowerLibraryRecord",this);
+  fTAPSLibRecCmd->SetGuidance("Record the showers of primary e+-/gamma entering the TAPS crystals into this shower library file");
+  fTAPSLibRecCmd->SetParameterName("file",false);
+  fTAPSLibRecCmd->AvailableForStates(G4State_PreInit);
+
+  fTAPSLibMaxCmd = new G4UIcmdWithAnInteger("/A2/physics/TAPSShowerLibraryMaxShowers",this);
+  fTAPSLibMaxCmd->SetGuidance("Maximum number of recorded showers per shower library bin");
+  fTAPSLibMaxCmd->SetParameterName("N",false);
+  fTAPSLibMaxCmd->SetRange("N>0");
+  fTAPSLibMaxCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fRouletteECmd = new G4UIcmdWithADoubleAndUnit("/A2/physics/RouletteEnergy",this);
+  fRouletteECmd->SetGuidance("Play Russian roulette with e+-/gamma below this energy created in passive volumes (0 = off)");
+  fRouletteECmd->SetParameterName("Eroul",false);
+  fRouletteECmd->SetUnitCategory("Energy");
+  fRouletteECmd->SetRange("Eroul>=0.0");
+  fRouletteECmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fRouletteSurvCmd = new G4UIcmdWithADouble("/A2/physics/RouletteSurvival",this);
+  fRouletteSurvCmd->SetGuidance("Survival probability of the Russian roulette (the weight of survivors is divided by it)");
+  fRouletteSurvCmd->SetParameterName("P",false);
+  fRouletteSurvCmd->SetRange("P>0.0 && P<=1.0");
+  fRouletteSurvCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fRouletteSplitCmd = new G4UIcmdWithABool("/A2/physics/RouletteSplit",this);
+  fRouletteSplitCmd->SetGuidance("Split weighted tracks entering sensitive volumes into copies of about unit weight");
+  fRouletteSplitCmd->SetParameterName("Split",false);
+  fRouletteSplitCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fKillBelowCmd = new G4UIcmdWithAString("/A2/physics/KillBelow",this);
+  fKillBelowCmd->SetGuidance("Kill tracks of a particle below a kinetic energy in a region");
+  fKillBelowCmd->SetGuidance("  region particle energy [unit], e.g. DefaultRegionForTheWorld e- 100 keV");
+  fKillBelowCmd->SetGuidance("  (region/particle \"all\", particle \"neutrino\" for all neutrinos)");
+  fKillBelowCmd->SetParameterName("rule",false);
+  fKillBelowCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fKillAfterCmd = new G4UIcmdWithAString("/A2/physics/KillAfter",this);
+  fKillAfterCmd->SetGuidance("Kill tracks of a particle after a global time in a region");
+  fKillAfterCmd->SetGuidance("  region particle time [unit], e.g. all neutron 2000 ns (default: all all 2 ms)");
+  fKillAfterCmd->SetParameterName("rule",false);
+  fKillAfterCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fKillParticleCmd = new G4UIcmdWithAString("/A2/physics/KillParticle",this);
+  fKillParticleCmd->SetGuidance("Do not track a particle in a region, e.g. all neutrino");
+  fKillParticleCmd->SetGuidance("Energy floors and time limits of other rules do not lift it");
+  fKillParticleCmd->SetParameterName("rule",false);
+  fKillParticleCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fKillClearCmd = new G4UIcmdWithoutParameter("/A2/physics/ClearKillRules",this);
+  fKillClearCmd->SetGuidance("Remove all track kill rules including the default time limit of 2 ms");
+  fKillClearCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fKillListCmd = new G4UIcmdWithoutParameter("/A2/physics/ListKillRules",this);
+  fKillListCmd->SetGuidance("Show the track kill rules");
+  fKillListCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fSteppingCmd = new G4UIcmdWithABool("/A2/physics/SteppingAction",this);
+  fSteppingCmd->SetGuidance("Switch the stepping action on or off (off: only applied if no user-defined step-level kill rules,");
+  fSteppingCmd->SetGuidance("splitting, shower recording or profiling need it; the stuck-photon workaround and the default");
+  fSteppingCmd->SetGuidance("time limit at the step points are disabled with it, new tracks are still checked)");
+  fSteppingCmd->SetParameterName("Stepping",false);
+  fSteppingCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fStuckPhotonCmd = new G4UIcmdWithABool("/A2/physics/KillStuckPhotons",this);
+  fStuckPhotonCmd->SetGuidance("Kill photons below 100 eV after a photoelectric step (workaround for photons stuck in phot)");
+  fStuckPhotonCmd->SetParameterName("Kill",false);
+  fStuckPhotonCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -135,6 +238,22 @@ A2PhysicsListMessenger::~A2PhysicsListMessenger()
   delete fListCmd;
   delete fRegCutCmd;
   delete fRegCmd;
+  delete fFastCBCmd;
+  delete fFastCBMinECmd;
+  delete fFastCBSpotECmd;
+  delete fTAPSLibCmd;
+  delete fTAPSLibRecCmd;
+  delete fTAPSLibMaxCmd;
+  delete fRouletteECmd;
+  delete fRouletteSurvCmd;
+  delete fRouletteSplitCmd;
+  delete fKillBelowCmd;
+  delete fKillAfterCmd;
+  delete fKillParticleCmd;
+  delete fKillClearCmd;
+  delete fKillListCmd;
+  delete fSteppingCmd;
+  delete fStuckPhotonCmd;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -223,6 +342,50 @@ void A2PhysicsListMessenger::SetNewValue(G4UIcommand* command, G4String newValue
     G4cout<<"Selected region "<<fRegion<<G4endl;
   }
 
+  if( command == fFastCBCmd )
+    A2CBShowerModel::SetEnabled(fFastCBCmd->GetNewBoolValue(newValue));
+  if( command == fFastCBMinECmd )
+    A2CBShowerModel::SetMinEnergy(fFastCBMinECmd->GetNewDoubleValue(newValue));
+  if( command == fFastCBSpotECmd )
+    A2CBShowerModel::SetSpotEnergy(fFastCBSpotECmd->GetNewDoubleValue(newValue));
+  if( command == fTAPSLibCmd )
+    A2TAPSShowerModel::SetLibrary(newValue);
+  if( command == fTAPSLibRecCmd )
+    A2ShowerLibrary::SetRecording(newValue);
+  if( command == fTAPSLibMaxCmd )
+    A2ShowerLibrary::SetMaxShowers(fTAPSLibMaxCmd->GetNewIntValue(newValue));
+  if( command == fRouletteECmd )
+    A2StackingAction::SetRouletteEnergy(fRouletteECmd->GetNewDoubleValue(newValue));
+  if( command == fRouletteSurvCmd )
+    A2StackingAction::SetSurvival(fRouletteSurvCmd->GetNewDoubleValue(newValue));
+  if( command == fRouletteSplitCmd )
+    A2StackingAction::SetSplit(fRouletteSplitCmd->GetNewBoolValue(newValue));
+
+  // track kill rules: region particle [value [unit]]
+  if( command == fKillBelowCmd || command == fKillAfterCmd || command == fKillParticleCmd ) {
+    std::istringstream is(newValue);
+    G4String region, particle, unit = command == fKillBelowCmd ? "MeV" : "ns";
+    G4double value = 0;
+    is >> region >> particle;
+    if( command != fKillParticleCmd ) is >> value >> unit;
+    if( is.fail() && command != fKillParticleCmd )
+      G4cout << "A2PhysicsListMessenger::SetNewValue() Invalid kill rule " << newValue << G4endl;
+    else if( command == fKillBelowCmd )
+      A2TrackKiller::AddRule(region, particle, kKillBelow, value*G4UIcommand::ValueOf(unit));
+    else if( command == fKillAfterCmd )
+      A2TrackKiller::AddRule(region, particle, kKillAfter, value*G4UIcommand::ValueOf(unit));
+    else
+      A2TrackKiller::AddRule(region, particle, kKillAlways, 0);
+  }
+  if( command == fKillClearCmd )
+    A2TrackKiller::ClearRules();
+  if( command == fKillListCmd )
+    A2TrackKiller::PrintRules();
+  if( command == fSteppingCmd )
+    A2SteppingAction::SetActive(fSteppingCmd->GetNewBoolValue(newValue));
+  if( command == fStuckPhotonCmd )
+    A2SteppingAction::SetKillStuckPhotons(fStuckPhotonCmd->GetNewBoolValue(newValue));
+
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -47,6 +47,8 @@
 
 #include "A2PhysicsList.hh"
 #include "A2PhysicsListMessenger.hh"
+#include "A2CBShowerModel.hh"
+#include "A2TAPSShowerModel.hh"
 
 #include "G4DecayPhysics.hh"
 #include "G4EmStandardPhysics.hh"
@@ -151,6 +153,7 @@ void A2PhysicsList::ConstructProcess()
   for(size_t i=0; i<fHadronPhys.size(); i++) {
     fHadronPhys[i]->ConstructProcess();
   }
+  if(A2CBShowerModel::IsEnabled()||A2TAPSShowerModel::IsEnabled()) A2ShowerModel::AddProcess();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo.....
@@ -10,6 +10,20 @@
 #include "A2MagneticField.hh"
 #include "G4FieldManager.hh"
 #include "G4TransportationManager.hh"
+#include "G4ChordFinder.hh"
+#include "G4Mag_UsualEqRhs.hh"
+#include "G4ClassicalRK4.hh"
+#include "G4SimpleRunge.hh"
+#include "G4CashKarpRKF45.hh"
+#include "G4NystromRK4.hh"
+#include "G4HelixExplicitEuler.hh"
+#include "G4HelixImplicitEuler.hh"
+#include "G4HelixSimpleRunge.hh"
+#include "G4HelixMixedStepper.hh"
+#include "G4Version.hh"
+#if G4VERSION_NUMBER >= 1040
+#include "G4DormandPrince745.hh"
+#endif
 #include "CLHEP/Units/SystemOfUnits.h"
 
 using namespace CLHEP;
@@ -19,36 +33,77 @@ A2PolarizedTarget::A2PolarizedTarget()
   fLength=20.0*mm;
   fRadius=9.905*mm; //was 0.5mm
   fMagneticField = NULL;
+  fStepper = "default";
+  fMinStep = 1.0e-2*mm;
+  fDeltaChord = 0;
+  fDeltaOneStep = 0;
 }
 A2PolarizedTarget::~A2PolarizedTarget()
 {
   if(fMagneticField) delete fMagneticField;
 }
 
-void A2PolarizedTarget::SetMagneticField(G4String &nameFileFieldMap)
+void A2PolarizedTarget::SetMagneticField(G4String &nameFileFieldMap, G4bool trilinear, const G4String &storage)
 {
   // If nameFileFieldMap is a NULL string then do not set the target magnetic field
   if(nameFileFieldMap.isNull()) {G4cout<<"Warning A2PolarizedTarget::SetMagneticField No field map given, therefore there will be no field!"<<G4endl;return;}
   
   // Create magnetic field
   fMagneticField = new A2MagneticField();
+  fMagneticField->SetTrilinear(trilinear);
   
-  // Read magnetic field map
-  // Set this field as default and create trajectory calculator
+  // Read magnetic field map and convert it to the requested storage
+  // (the field is attached to the field manager after the geometry was built)
   // Or, in case of a problem reading the field map, delete fMagneticField and abort the simulation
-  if(fMagneticField->ReadFieldMap(nameFileFieldMap))
-  {
-    G4FieldManager* fieldMgr = G4TransportationManager::GetTransportationManager()->GetFieldManager();
-    fieldMgr->SetDetectorField(fMagneticField);
-    fieldMgr->CreateChordFinder(fMagneticField);
-  }
-  else
+  if(!fMagneticField->ReadFieldMap(nameFileFieldMap) || !fMagneticField->SetStorage(storage))
   {
     delete fMagneticField;
     exit(1);
   }
 }
 
+G4MagIntegratorStepper* A2PolarizedTarget::CreateStepper()
+{
+  // Create the selected stepper (0 for the default stepper of the chord finder)
+  if(fStepper=="default") return 0;
+  G4Mag_UsualEqRhs* equation = new G4Mag_UsualEqRhs(fMagneticField);
+  if(fStepper=="ClassicalRK4") return new G4ClassicalRK4(equation);
+  if(fStepper=="SimpleRunge") return new G4SimpleRunge(equation);
+  if(fStepper=="CashKarpRKF45") return new G4CashKarpRKF45(equation);
+  if(fStepper=="NystromRK4") return new G4NystromRK4(equation);
+  if(fStepper=="HelixExplicitEuler") return new G4HelixExplicitEuler(equation);
+  if(fStepper=="HelixImplicitEuler") return new G4HelixImplicitEuler(equation);
+  if(fStepper=="HelixSimpleRunge") return new G4HelixSimpleRunge(equation);
+  if(fStepper=="HelixMixed") return new G4HelixMixedStepper(equation);
+#if G4VERSION_NUMBER >= 1040
+  if(fStepper=="DormandPrince745") return new G4DormandPrince745(equation);
+#endif
+  G4cerr<<"A2PolarizedTarget::CreateStepper() Stepper "<<fStepper<<" is not available"<<G4endl;
+  exit(1);
+}
+
+void A2PolarizedTarget::AttachMagneticField(const std::vector<G4LogicalVolume*>& volumes)
+{
+  // The field map itself is read-only and shared, but every thread has its own
+  // field manager and chord finder
+  if(!fMagneticField) return;
+  G4ChordFinder* chordFinder = new G4ChordFinder(fMagneticField, fMinStep, CreateStepper());
+  if(fDeltaChord>0) chordFinder->SetDeltaChord(fDeltaChord);
+
+  G4FieldManager* fieldMgr;
+  if(volumes.empty()){
+    fieldMgr = G4TransportationManager::GetTransportationManager()->GetFieldManager();
+    fieldMgr->SetDetectorField(fMagneticField);
+    fieldMgr->SetChordFinder(chordFinder);
+  }
+  else{
+    //no field propagation outside of the given volumes (e.g. in the calorimeters)
+    fieldMgr = new G4FieldManager(fMagneticField, chordFinder);
+    for(size_t i=0;i<volumes.size();i++) volumes[i]->SetFieldManager(fieldMgr, true);
+  }
+  if(fDeltaOneStep>0) fieldMgr->SetDeltaOneStep(fDeltaOneStep);
+}
+
 G4VPhysicalVolume* A2PolarizedTarget::Construct(G4LogicalVolume *MotherLogic, G4double Z0)
 {
 
@@ -3,14 +3,16 @@
 
 #include "A2PrimaryGeneratorMessenger.hh"
 #include "A2DetectorConstruction.hh"
-#include "A2FileGeneratorMkin.hh"
-#include "A2FileGeneratorPluto.hh"
-#include "A2FileGeneratorGiBUU.hh"
+#include "A2FileGenerator.hh"
+#include "A2FileGeneratorPrefetch.hh"
+#include "A2EventStats.hh"
 
 #include "G4ParticleGun.hh"
+#include "G4Event.hh"
+#include "G4RunManager.hh"
+#include "G4Threading.hh"
 #include "Randomize.hh"
 #include "TLorentzVector.h"
-#include "TFile.h"
 
 #include "MCNtuple.h"
 
@@ -54,6 +56,9 @@ A2PrimaryGeneratorAction::A2PrimaryGeneratorAction()
 
   fDetCon=NULL;
   fInFileName="";
+  fShard=0;
+  fNShards=1;
+  fPrefetchDepth=0;
 }
 
 
@@ -120,7 +125,19 @@ void A2PrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent)
       }
 
       // get the event from input tree
-      fFileGen->ReadEvent(fNevent);
+      // (worker threads process the events in arbitrary order)
+      if (G4Threading::IsWorkerThread())
+        fNevent = anEvent->GetEventID();
+      // (abort the run softly, so that the output is still closed and merged)
+      if (!fFileGen->ReadEvent(fNevent))
+      {
+        G4cout << "A2PrimaryGeneratorAction::GeneratePrimaries(): Could not read event " << fNevent
+               << " of the input file (" << fFileGen->GetNEvents() << " events), aborting the run" << G4endl;
+        anEvent->SetEventAborted();
+        G4RunManager::GetRunManager()->AbortRun(true);
+        return;
+      }
+      A2EventStats::Instance()->SetInputEvent(fNevent);
       //fFileGen->Print();
 
       //
@@ -352,6 +369,8 @@ void A2PrimaryGeneratorAction::OverlapGenerator(G4Event* anEvent){
 }
 void A2PrimaryGeneratorAction::SetUpFileInput(){
   if(fInFileName==TString(""))return;
+  // input already prepared (worker threads call this at the start of every run)
+  if(fFileGen && fInFileName==fFileGen->GetFileName().c_str())return;
   G4cout<<"A2PrimaryGeneratorAction::SetUpFileInput(): input file set as "<<fInFileName<<G4endl;
 
   fMode=EPGA_FILE;
@@ -363,51 +382,28 @@ void A2PrimaryGeneratorAction::SetUpFileInput(){
     exit(1);
   }
 
-  // look for supported event trees in ROOT file
-  TFile* ftest = new TFile(fInFileName);
-  TTree* tree_mkin = 0;
-  TTree* tree_pluto = 0;
-  TTree* tree_gibuu = 0;
-  if (ftest && !ftest->IsZombie())
-  {
-    tree_mkin = (TTree*)ftest->Get("h1");
-    tree_pluto = (TTree*)ftest->Get("data");
-    tree_gibuu = (TTree*)ftest->Get("RootTuple");
-    delete ftest;
-  }
-  else
-  {
-    G4cout << "A2PrimaryGeneratorAction::SetUpFileInput(): Could not open ROOT file " << fInFileName << G4endl;
-    exit(1);
-  }
+  // prefetching needs sequentially read events: the worker threads of a
+  // multithreaded run read interleaved events and the master generates none
+  G4bool prefetch = fPrefetchDepth > 0 &&
+                    G4RunManager::GetRunManager()->GetRunManagerType() == G4RunManager::sequentialRM;
+  if (fPrefetchDepth > 0 && !prefetch && !G4Threading::IsWorkerThread())
+    G4cout << "A2PrimaryGeneratorAction::SetUpFileInput(): Input prefetching is not used in multithreaded runs" << G4endl;
 
-  // open file
-  if (tree_mkin)
+  // open file and select the event range
+  fFileGen = A2FileGenerator::Open(fInFileName, fShard, fNShards);
+  if (!fFileGen)
   {
-    fFileGen = new A2FileGeneratorMkin(fInFileName);
-  }
-  else if (tree_pluto)
-  {
-#ifdef WITH_PLUTO
-    fFileGen = new A2FileGeneratorPluto(fInFileName);
-#else
-    G4cout << "A2PrimaryGeneratorAction::SetUpFileInput(): Support for Pluto event files was not activated at compile time!" << G4endl;
+    G4cout << "A2PrimaryGeneratorAction::SetUpFileInput(): Could not set up the input file " << fInFileName << G4endl;
     exit(1);
-#endif
-  }
-  else if (tree_gibuu)
-  {
-    fFileGen = new A2FileGeneratorGiBUU(fInFileName);
   }
-  else
+
+  // decode the events in a background thread
+  if (prefetch)
   {
-    G4cout << "A2PrimaryGeneratorAction::SetUpFileInput(): ROOT event-tree format is not supported!" << G4endl;
-    exit(1);
+    fFileGen = new A2FileGeneratorPrefetch(fFileGen, fPrefetchDepth);
+    fFileGen->Init();
   }
 
-  // init the file
-  fFileGen->Init();
-
   // user info
   if (fFileGen->GetType() == A2FileGenerator::kMkin)
     G4cout << "A2PrimaryGeneratorAction::SetUpFileInput(): Opening mkin event-file" << G4endl;
@@ -417,6 +413,10 @@ void A2PrimaryGeneratorAction::SetUpFileInput(){
     G4cout << "A2PrimaryGeneratorAction::SetUpFileInput(): Opening Pluto cocktail-event file" << G4endl;
   else if (fFileGen->GetType() == A2FileGenerator::kGiBUU)
     G4cout << "A2PrimaryGeneratorAction::SetUpFileInput(): Opening GiBUU-event file" << G4endl;
+  if (fNShards > 1)
+    G4cout << "A2PrimaryGeneratorAction::SetUpFileInput(): Processing shard " << fShard << " of " << fNShards
+           << " (events " << fFileGen->GetFirstEvent() << " to " << fFileGen->GetFirstEvent()+fFileGen->GetNEvents()-1
+           << " of " << fFileGen->GetNEntries() << ")" << G4endl;
 
   // create data structures for generated particles
   fNGenMaxParticles = fFileGen->GetMaxParticles();
@@ -47,6 +47,30 @@ A2PrimaryGeneratorMessenger::A2PrimaryGeneratorMessenger(
   SetSeedCmd->SetParameterName("Seed",false);
   SetSeedCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
 
+  SetShardCmd = new G4UIcmdWithAnInteger("/A2/generator/Shard",this);
+  SetShardCmd->SetGuidance("Set the index of the event range (shard) of the input file to be processed");
+  SetShardCmd->SetParameterName("Shard",false);
+  SetShardCmd->SetRange("Shard>=0");
+  SetShardCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  SetNShardsCmd = new G4UIcmdWithAnInteger("/A2/generator/NShards",this);
+  SetNShardsCmd->SetGuidance("Set the number of equally sized event ranges (shards) the input file is split into");
+  SetNShardsCmd->SetParameterName("NShards",false);
+  SetNShardsCmd->SetRange("NShards>0");
+  SetNShardsCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  SetPrefetchCmd = new G4UIcmdWithAnInteger("/A2/generator/PrefetchDepth",this);
+  SetPrefetchCmd->SetGuidance("Set the number of input-file events decoded in advance by a background thread (0=off)");
+  SetPrefetchCmd->SetParameterName("PrefetchDepth",false);
+  SetPrefetchCmd->SetRange("PrefetchDepth>=0");
+  SetPrefetchCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  SetStartEventCmd = new G4UIcmdWithAnInteger("/A2/generator/StartEvent",this);
+  SetStartEventCmd->SetGuidance("Set the input-file event read next in sequential runs (e.g. to replay a dumped event)");
+  SetStartEventCmd->SetParameterName("StartEvent",false);
+  SetStartEventCmd->SetRange("StartEvent>=0");
+  SetStartEventCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
   SetTminCmd = new G4UIcmdWithADoubleAndUnit("/A2/generator/SetTMin",this);
   SetTminCmd->SetGuidance("Set the minimum particle energy for the phase space generator");
   SetTminCmd->SetParameterName("Tmin",false);
@@ -136,6 +160,10 @@ A2PrimaryGeneratorMessenger::~A2PrimaryGeneratorMessenger()
   delete SetThetamaxCmd;
   delete SetModeCmd;
   delete SetSeedCmd;
+  delete SetShardCmd;
+  delete SetNShardsCmd;
+  delete SetPrefetchCmd;
+  delete SetStartEventCmd;
   delete SetBeamEnergyCmd;
   delete SetBeamXSigmaCmd;
   delete SetBeamYSigmaCmd;
@@ -169,6 +197,17 @@ void A2PrimaryGeneratorMessenger::SetNewValue(
   if( command == SetSeedCmd )
     { CLHEP::HepRandom::setTheSeed(SetSeedCmd->GetNewIntValue(newValue));}
 
+  if( command == SetShardCmd )
+    { A2Action->SetShard(SetShardCmd->GetNewIntValue(newValue));}
+
+  if( command == SetNShardsCmd )
+    { A2Action->SetNShards(SetNShardsCmd->GetNewIntValue(newValue));}
+
+  if( command == SetPrefetchCmd )
+    { A2Action->SetPrefetchDepth(SetPrefetchCmd->GetNewIntValue(newValue));}
+  if( command == SetStartEventCmd )
+    { A2Action->SetStartEvent(SetStartEventCmd->GetNewIntValue(newValue));}
+
    if( command == SetTminCmd )
      { A2Action->SetTmin(SetTminCmd->GetNewDoubleValue(newValue));}
  
@@ -0,0 +1,241 @@
+// Profiler of the tracking: steps, tracks, wall and CPU time per region,
+// particle type and process
+
+#include <ctime>
+#include <algorithm>
+
+#include "G4Track.hh"
+#include "G4Step.hh"
+#include "G4StepPoint.hh"
+#include "G4VProcess.hh"
+#include "G4Region.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4AutoLock.hh"
+#include "G4ios.hh"
+#include "TH2D.h"
+#include "TString.h"
+
+#include "A2Profiler.hh"
+
+namespace { G4Mutex gProfileMutex = G4MUTEX_INITIALIZER; }
+
+G4bool A2Profiler::fgEnabled = false;
+std::map<G4String, A2Profiler::A2ProfEntry_t> A2Profiler::fgTotals[A2Profiler::kNKeys];
+G4ThreadLocal A2Profiler* A2Profiler::fgInstance = 0;
+
+//______________________________________________________________________________
+A2Profiler::A2Profiler()
+{
+    // Constructor.
+
+    // init members
+    fLastTime = std::chrono::steady_clock::now();
+    fTrackCPU = 0;
+    fTrackRegion = -1;
+    fTrackParticle = -1;
+}
+
+//______________________________________________________________________________
+G4double A2Profiler::GetThreadCPUTime()
+{
+    // Return the CPU time used by this thread [s].
+
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + 1e-9*ts.tv_nsec;
+}
+
+//______________________________________________________________________________
+G4int A2Profiler::AddEntry(EA2ProfileKey key, const void* ptr)
+{
+    // Return the entry of the region/particle/process 'ptr' in the table of
+    // the key type 'key' if it is not the one of the last look-up, create
+    // the entry if needed.
+
+    A2ProfTable_t& t = fTables[key];
+    std::unordered_map<const void*, G4int>::const_iterator it = t.fIndex.find(ptr);
+    G4int index;
+    if (it != t.fIndex.end())
+    {
+        index = it->second;
+    }
+    else
+    {
+        G4String name("none");
+        if (ptr && key == kRegion) name = static_cast<const G4Region*>(ptr)->GetName();
+        else if (ptr && key == kParticle) name = static_cast<const G4ParticleDefinition*>(ptr)->GetParticleName();
+        else if (ptr && key == kProcess) name = static_cast<const G4VProcess*>(ptr)->GetProcessName();
+        index = t.fEntries.size();
+        t.fNames.push_back(name);
+        t.fEntries.push_back(A2ProfEntry_t());
+        t.fIndex[ptr] = index;
+    }
+
+    t.fLast = ptr;
+    t.fLastIndex = index;
+    return index;
+}
+
+//______________________________________________________________________________
+void A2Profiler::BeginTrack(const G4Track* track)
+{
+    // Count the track and start its timing.
+
+    const G4ParticleDefinition* part = track->GetDefinition();
+    fTrackParticle = GetEntry(kParticle, part);
+    fTables[kParticle].fEntries[fTrackParticle].fTracks++;
+
+    const G4VPhysicalVolume* pv = track->GetVolume();
+    const G4Region* region = pv ? pv->GetLogicalVolume()->GetRegion() : 0;
+    fTrackRegion = GetEntry(kRegion, region);
+    fTables[kRegion].fEntries[fTrackRegion].fTracks++;
+
+    fTrackCPU = GetThreadCPUTime();
+    fLastTime = std::chrono::steady_clock::now();
+}
+
+//______________________________________________________________________________
+void A2Profiler::Step(const G4Step* step)
+{
+    // Count the step and add the wall time since the end of the last step to
+    // its region, particle and process.
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    G4double dt = std::chrono::duration<G4double>(now - fLastTime).count();
+    fLastTime = now;
+
+    // region of the pre-step point
+    const G4VPhysicalVolume* pv = step->GetPreStepPoint()->GetPhysicalVolume();
+    const G4Region* region = pv ? pv->GetLogicalVolume()->GetRegion() : 0;
+    A2ProfEntry_t& r = fTables[kRegion].fEntries[GetEntry(kRegion, region)];
+    r.fSteps++;
+    r.fWall += dt;
+
+    // particle
+    const G4ParticleDefinition* part = step->GetTrack()->GetDefinition();
+    A2ProfEntry_t& p = fTables[kParticle].fEntries[GetEntry(kParticle, part)];
+    p.fSteps++;
+    p.fWall += dt;
+
+    // process limiting the step
+    const G4VProcess* proc = step->GetPostStepPoint()->GetProcessDefinedStep();
+    A2ProfEntry_t& q = fTables[kProcess].fEntries[GetEntry(kProcess, proc)];
+    q.fSteps++;
+    q.fWall += dt;
+}
+
+//______________________________________________________________________________
+void A2Profiler::EndTrack(const G4Track*)
+{
+    // Add the CPU time of the track to its particle and start region.
+
+    G4double cpu = GetThreadCPUTime() - fTrackCPU;
+    if (fTrackParticle >= 0) fTables[kParticle].fEntries[fTrackParticle].fCPU += cpu;
+    if (fTrackRegion >= 0) fTables[kRegion].fEntries[fTrackRegion].fCPU += cpu;
+    fTrackParticle = -1;
+    fTrackRegion = -1;
+}
+
+//______________________________________________________________________________
+void A2Profiler::Merge()
+{
+    // Add the counters of this thread to the totals of all threads and reset
+    // them.
+
+    G4AutoLock lock(&gProfileMutex);
+    for (G4int k = 0; k < kNKeys; k++)
+    {
+        A2ProfTable_t& t = fTables[k];
+        for (size_t i = 0; i < t.fEntries.size(); i++)
+        {
+            A2ProfEntry_t& tot = fgTotals[k][t.fNames[i]];
+            tot.fSteps += t.fEntries[i].fSteps;
+            tot.fTracks += t.fEntries[i].fTracks;
+            tot.fWall += t.fEntries[i].fWall;
+            tot.fCPU += t.fEntries[i].fCPU;
+            t.fEntries[i] = A2ProfEntry_t();
+        }
+    }
+}
+
+//______________________________________________________________________________
+void A2Profiler::ResetTotals()
+{
+    // Reset the totals of all threads.
+
+    G4AutoLock lock(&gProfileMutex);
+    for (G4int k = 0; k < kNKeys; k++)
+        fgTotals[k].clear();
+}
+
+//______________________________________________________________________________
+void A2Profiler::PrintTable()
+{
+    // Print the totals of all threads sorted by wall time.
+
+    const char* title[kNKeys] = { "Region", "Particle", "Process" };
+
+    G4AutoLock lock(&gProfileMutex);
+    G4cout << "A2Profiler::PrintTable(): Tracking profile (wall time of the steps, CPU time of the tracks)" << G4endl;
+    for (G4int k = 0; k < kNKeys; k++)
+    {
+        // sort by wall time
+        std::vector<std::pair<G4double, G4String> > order;
+        G4double wallTot = 0;
+        for (std::map<G4String, A2ProfEntry_t>::const_iterator it = fgTotals[k].begin(); it != fgTotals[k].end(); ++it)
+        {
+            order.push_back(std::make_pair(-it->second.fWall, it->first));
+            wallTot += it->second.fWall;
+        }
+        std::sort(order.begin(), order.end());
+
+        G4cout << TString::Format("  %-24s %14s %12s %12s %7s %12s", title[k], "steps", "tracks", "wall [s]", "wall %", "CPU [s]") << G4endl;
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            const A2ProfEntry_t& e = fgTotals[k][order[i].second];
+            G4cout << TString::Format("  %-24s %14lld %12lld %12.3f %7.2f %12s", order[i].second.c_str(),
+                                      (Long64_t)e.fSteps, (Long64_t)e.fTracks, e.fWall,
+                                      wallTot > 0 ? 100*e.fWall/wallTot : 0.,
+                                      k == kProcess ? "-" : TString::Format("%.3f", e.fCPU).Data()) << G4endl;
+        }
+    }
+}
+
+//______________________________________________________________________________
+void A2Profiler::WriteHistogram()
+{
+    // Write the totals of all threads as a histogram (x: "region:name",
+    // "particle:name", "process:name", y: steps, tracks, wall time [s],
+    // CPU time [s]) to the current directory.
+
+    const char* prefix[kNKeys] = { "region", "particle", "process" };
+
+    G4AutoLock lock(&gProfileMutex);
+    G4int n = 0;
+    for (G4int k = 0; k < kNKeys; k++)
+        n += fgTotals[k].size();
+    if (!n)
+        return;
+
+    TH2D h("A2Geant4 Profile", "Tracking profile", n, 0, n, 4, 0, 4);
+    h.SetDirectory(0);
+    h.GetYaxis()->SetBinLabel(1, "steps");
+    h.GetYaxis()->SetBinLabel(2, "tracks");
+    h.GetYaxis()->SetBinLabel(3, "wall time [s]");
+    h.GetYaxis()->SetBinLabel(4, "CPU time [s]");
+    G4int bin = 1;
+    for (G4int k = 0; k < kNKeys; k++)
+    {
+        for (std::map<G4String, A2ProfEntry_t>::const_iterator it = fgTotals[k].begin(); it != fgTotals[k].end(); ++it, bin++)
+        {
+            h.GetXaxis()->SetBinLabel(bin, TString::Format("%s:%s", prefix[k], it->first.c_str()));
+            h.SetBinContent(bin, 1, it->second.fSteps);
+            h.SetBinContent(bin, 2, it->second.fTracks);
+            h.SetBinContent(bin, 3, it->second.fWall);
+            h.SetBinContent(bin, 4, it->second.fCPU);
+        }
+    }
+    h.Write();
+}
@@ -1,15 +1,29 @@
 
 #include "A2RunAction.hh"
+#include "A2PrimaryGeneratorAction.hh"
+#include "A2FileGenerator.hh"
+#include "A2ParticleCache.hh"
+#include "A2HitArena.hh"
+#include "A2CBShowerModel.hh"
+#include "A2TAPSShowerModel.hh"
+#include "A2ShowerLibrary.hh"
+#include "A2StackingAction.hh"
+#include "A2TrackKiller.hh"
+#include "A2SteppingAction.hh"
+#include "A2Profiler.hh"
+#include "A2EventStats.hh"
 
 #include "G4Run.hh"
 #include "G4RunManager.hh"
 #include "G4UnitsTable.hh"
+#include "G4Threading.hh"
 
 
 
-A2RunAction::A2RunAction()
+A2RunAction::A2RunAction(A2EventAction* masterEventAction)
 {
   fEventAction=NULL;
+  fMasterEventAction=masterEventAction;
 }
 
 
@@ -27,8 +41,28 @@ void A2RunAction::BeginOfRunAction(const G4Run* aRun)
   //G4RunManager::GetRunManager()->SetRandomNumberStore(true);
 
   //Open output file
-  fEventAction=  const_cast<A2EventAction*>(static_cast<const A2EventAction*>(G4RunManager::GetRunManager()->GetUserEventAction()));
+  //(the master of a multithreaded run has no event action of its own)
+  if(fMasterEventAction) fEventAction=fMasterEventAction;
+  else fEventAction=  const_cast<A2EventAction*>(static_cast<const A2EventAction*>(G4RunManager::GetRunManager()->GetUserEventAction()));
+
+  //worker threads set up their own copy of the input file
+  if(G4Threading::IsWorkerThread()){
+    A2PrimaryGeneratorAction* pga=const_cast<A2PrimaryGeneratorAction*>(static_cast<const A2PrimaryGeneratorAction*>(G4RunManager::GetRunManager()->GetUserPrimaryGeneratorAction()));
+    pga->SetUpFileInput();
+  }
+  //(also for runs started by /run/beamOn in a macro)
+  fEventAction->SetReqEvents(aRun->GetNumberOfEventToBeProcessed());
   fEventAction->PrepareOutput();
+  //the master of a multithreaded run has no hits collections
+  if(!fMasterEventAction) fEventAction->ResolveCollectionIDs();
+
+  //the profile of all threads is accumulated per run
+  if(!G4Threading::IsWorkerThread()) A2Profiler::ResetTotals();
+  if(!G4Threading::IsWorkerThread()) A2EventStats::ResetTotals();
+  if(!fMasterEventAction) A2EventStats::Instance()->BeginOfRun();
+
+  //per-run settings of the stepping action
+  if(!fMasterEventAction && A2SteppingAction::Instance()) A2SteppingAction::Instance()->BeginOfRun();
 }
 
 
@@ -37,8 +71,36 @@ void A2RunAction::BeginOfRunAction(const G4Run* aRun)
 void A2RunAction::EndOfRunAction(const G4Run* aRun)
 {
   G4int NbOfEvents = aRun->GetNumberOfEvent();
-  if (NbOfEvents == 0) return;
-
+  //input statistics (e.g. prefetching)
+  if(!fMasterEventAction){
+    A2PrimaryGeneratorAction* pga=const_cast<A2PrimaryGeneratorAction*>(static_cast<const A2PrimaryGeneratorAction*>(G4RunManager::GetRunManager()->GetUserPrimaryGeneratorAction()));
+    if(pga && pga->GetFileGen()) pga->GetFileGen()->PrintStatistics();
+    A2HitArena::Instance()->PrintStatistics();
+    if(A2CBShowerModel::Instance()) A2CBShowerModel::Instance()->PrintStatistics();
+    if(A2TAPSShowerModel::Instance()) A2TAPSShowerModel::Instance()->PrintStatistics();
+    if(A2StackingAction::Instance()) A2StackingAction::Instance()->PrintStatistics();
+    A2TrackKiller::Instance()->PrintStatistics();
+    if(A2SteppingAction::Instance()) A2SteppingAction::Instance()->EndOfRun();
+    if(A2Profiler::IsEnabled()) A2Profiler::Instance()->Merge();
+    A2EventStats::Instance()->Merge();
+  }
+
+  //tracking profile of all threads (also written to the output file)
+  if(!G4Threading::IsWorkerThread() && A2Profiler::IsEnabled()) A2Profiler::PrintTable();
+
+  //slowest events of all threads (random number states for the replay)
+  if(!G4Threading::IsWorkerThread()) A2EventStats::PrintSlowest(aRun->GetRunID());
+
+  //undefined input particles of all threads
+  if(!G4Threading::IsWorkerThread()) A2ParticleCache::PrintUnknown();
+
+  //shower library recorded by all threads
+  if(!G4Threading::IsWorkerThread() && A2ShowerLibrary::IsRecording()) A2ShowerLibrary::WriteRecorded();
+
+  //worker threads always close their file so that the master can merge it
+  if (NbOfEvents == 0 && !G4Threading::IsWorkerThread()) return;
+
+  fEventAction->SetProcessedEvents(NbOfEvents);
   fEventAction->CloseOutput();
 
 }
@@ -30,6 +30,8 @@ A2SD::A2SD(G4String name,G4int Nelements):G4VSensitiveDetector(name)
  
   fNhits=0;
   fHCID=-1;
+  fLastPV[0]=fLastPV[1]=NULL;
+  fLastProp[0]=fLastProp[1]=NULL;
 }
 
 
@@ -51,6 +53,24 @@ void A2SD::Initialize(G4HCofThisEvent*)
 }
 
 
+const A2SDVolume_t* A2SD::ResolveVolume(const G4VPhysicalVolume* pv)
+{
+  //look up the properties of a volume, deduce them from its name on first use
+  std::unordered_map<const G4VPhysicalVolume*,A2SDVolume_t>::const_iterator it=fVolumes.find(pv);
+  if(it!=fVolumes.end()) return &it->second;
+
+  A2SDVolume_t prop;
+  //TAPS volume  is contained in COVR which is the multiple placed volume!
+  //For PbWO4 they have an additional Copy Number which should be added on to the COVR volume
+  prop.fCOVR=pv->GetName().contains("COVR");
+  //more realistic hit times: only larger energy deposits define the time
+  if(pv->GetName().contains("TAPS")) prop.fTimeThresh=4*MeV;
+  else if(pv->GetName().contains("CRYSTAL")) prop.fTimeThresh=2*MeV;
+  else prop.fTimeThresh=-1;
+  return &(fVolumes[pv]=prop);
+}
+
+
 G4bool A2SD::ProcessHits(G4Step* aStep,G4TouchableHistory*)
 { 
   
@@ -63,15 +83,14 @@ G4bool A2SD::ProcessHits(G4Step* aStep,G4TouchableHistory*)
   
   G4VPhysicalVolume* volume=theTouchable->GetVolume();
   G4VPhysicalVolume* mothervolume=theTouchable->GetVolume(1);
+  const A2SDVolume_t* prop=GetVolume(volume,0);
+  const A2SDVolume_t* motherprop=GetVolume(mothervolume,1);
   G4int id;
-  //Get element copy number
-  //TAPS volume  is contained in COVR which is the multiple placed volume!
-  //For PbWO4 they have an additional Copy Number which should be added on to the COVR volume
-  //if(volume->GetName().contains("TAPS")||volume->GetName().contains("PbWO"))id=mothervolume->GetCopyNo()+volume->GetCopyNo();
-  if(mothervolume->GetName().contains("COVR"))id=mothervolume->GetCopyNo()+volume->GetCopyNo();
+  //Get element copy number (TAPS: offset by the COVR copy number)
+  if(motherprop->fCOVR)id=mothervolume->GetCopyNo()+volume->GetCopyNo();
   else id = volume->GetCopyNo();
   //seperate ADC gates for TAPS
-  if((mothervolume->GetName().contains("COVR"))&&(aStep->GetPreStepPoint()->GetGlobalTime()>2000*ns))return false;
+  if((motherprop->fCOVR)&&(aStep->GetPreStepPoint()->GetGlobalTime()>2000*ns))return false;
   else if (aStep->GetPreStepPoint()->GetGlobalTime()>600*ns)return false; 
 
   // energy correction for non-linearity in plastic scintillators
@@ -89,6 +108,10 @@ G4bool A2SD::ProcessHits(G4Step* aStep,G4TouchableHistory*)
   A2UserTrackInformation* track_info = (A2UserTrackInformation*)
                                         track->GetUserInformation();
 
+  // statistical weight of rouletted/split tracks (the deposit itself stays
+  // unweighted, the weighted sum is kept separately in the hit)
+  G4double weight = track->GetWeight();
+
   //if(volume->GetName().contains("Pb")) G4cout<<volume->GetName()<<" id "<<id <<" "<<mothervolume->GetCopyNo()<<" "<<volume->GetCopyNo()<<" edep "<<edep/MeV<<G4endl;
   if (fhitID[id]==-1){
     //if this crystal has already had a hit
@@ -96,7 +119,7 @@ G4bool A2SD::ProcessHits(G4Step* aStep,G4TouchableHistory*)
     // G4cout<<"Make hit "<<fCollection<<G4endl;    
     A2Hit* myHit = new A2Hit;
     myHit->SetID(id);
-    myHit->AddEnergy(edep);
+    myHit->AddEnergy(edep, weight);
     myHit->AddPartEnergy(track_info->GetPartID(), edep);
     myHit->SetPos(aStep->GetPreStepPoint()->GetPosition());
     myHit->SetTime(aStep->GetPreStepPoint()->GetGlobalTime());
@@ -105,20 +128,13 @@ G4bool A2SD::ProcessHits(G4Step* aStep,G4TouchableHistory*)
   }
   else // This is not new
   {
-    (*fCollection)[fhitID[id]]->AddEnergy(edep);
+    (*fCollection)[fhitID[id]]->AddEnergy(edep, weight);
     (*fCollection)[fhitID[id]]->AddPartEnergy(track_info->GetPartID(), edep);
     // set more realistic hit times
     G4double time = aStep->GetPreStepPoint()->GetGlobalTime();
-    if (volume->GetName().contains("TAPS"))
-    {
-      if (edep/MeV > 4. && time < (*fCollection)[fhitID[id]]->GetTime())
-        (*fCollection)[fhitID[id]]->SetTime(time);
-    }
-    else if (volume->GetName().contains("CRYSTAL"))
-    {
-      if (edep/MeV > 2. && time < (*fCollection)[fhitID[id]]->GetTime())
-        (*fCollection)[fhitID[id]]->SetTime(time);
-    }
+    if (prop->fTimeThresh >= 0 && edep > prop->fTimeThresh &&
+        time < (*fCollection)[fhitID[id]]->GetTime())
+      (*fCollection)[fhitID[id]]->SetTime(time);
   }
   //G4cout<<"done "<<fNhits<<G4endl;
   return true;
@@ -130,6 +146,7 @@ void A2SD::EndOfEvent(G4HCofThisEvent* HCE)
   // G4cout<<"EndOfEvent( "<<fHCID<<" "<<fCollection<<" "<<fNhits<<G4endl;
   if(fHCID<0) fHCID = G4SDManager::GetSDMpointer()->GetCollectionID(collectionName[0]);
   if(fNhits>0)  HCE->AddHitsCollection(fHCID,fCollection);
+  else delete fCollection; //empty collections are not owned by the event
   //G4cout<<"EndOfEvent( "<<G4endl;
  
   //reset hit arrays
@@ -155,3 +172,10 @@ void A2SD::DrawAll()
 void A2SD::PrintAll()
 {} 
 
+
+G4VSensitiveDetector* A2SD::Clone() const
+{
+  //worker thread copy of this detector (fNelements includes the 0 element)
+  return new A2SD(SensitiveDetectorName,fNelements-1);
+}
+
@@ -0,0 +1,387 @@
+// library of frozen electromagnetic showers: recording in a dedicated run
+// mode, compact binary file format and memory-mapped read access
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "G4Step.hh"
+#include "G4StepPoint.hh"
+#include "G4Track.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4VTouchable.hh"
+#include "G4NavigationHistory.hh"
+#include "G4Material.hh"
+#include "G4Gamma.hh"
+#include "G4Electron.hh"
+#include "G4Positron.hh"
+#include "G4AutoLock.hh"
+#include "Randomize.hh"
+#include "CLHEP/Units/SystemOfUnits.h"
+#include "TString.h"
+#include "G4ios.hh"
+
+#include "A2ShowerLibrary.hh"
+#include "A2ShowerModel.hh"
+
+using namespace CLHEP;
+
+namespace { G4Mutex gRecordMutex = G4MUTEX_INITIALIZER; }
+
+const char A2ShowerLibrary::fgMagic[8] = "A2SHLIB";
+const uint32_t A2ShowerLibrary::fgVersion = 1;
+
+G4bool A2ShowerLibrary::fgRecording = false;
+G4String A2ShowerLibrary::fgRecordFile;
+G4int A2ShowerLibrary::fgMaxShowers = 50;
+G4double A2ShowerLibrary::fgCellSize = 10*mm;
+A2ShowerLibHeader_t A2ShowerLibrary::fgRecBinning;
+std::vector<std::vector<A2ShowerLibrary::A2RecShower_t> > A2ShowerLibrary::fgRecorded;
+G4ThreadLocal A2ShowerLibrary::A2RecState_t* A2ShowerLibrary::fgRecState = 0;
+
+//______________________________________________________________________________
+A2ShowerLibrary::A2ShowerLibrary()
+{
+    // Constructor.
+
+    // init members
+    fMapping = 0;
+    fMappingSize = 0;
+    fHeader = 0;
+    fBins = 0;
+    fShowers = 0;
+    fSpots = 0;
+}
+
+//______________________________________________________________________________
+A2ShowerLibrary::~A2ShowerLibrary()
+{
+    // Destructor.
+
+    if (fMapping)
+        munmap(fMapping, fMappingSize);
+}
+
+//______________________________________________________________________________
+G4bool A2ShowerLibrary::Map(const G4String& name)
+{
+    // Memory-map the library file 'name' read-only, so that all threads and
+    // all jobs on a node share the same pages.
+
+    // map the whole file
+    int fd = open(name.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        G4cout << "A2ShowerLibrary::Map(): File " << name << " not found!" << G4endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) || (size_t)st.st_size < sizeof(A2ShowerLibHeader_t))
+    {
+        G4cout << "A2ShowerLibrary::Map(): File " << name << " too short!" << G4endl;
+        close(fd);
+        return false;
+    }
+    void* map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        G4cout << "A2ShowerLibrary::Map(): Could not map " << name << "!" << G4endl;
+        return false;
+    }
+
+    // check the header and the table sizes
+    const A2ShowerLibHeader_t* h = static_cast<const A2ShowerLibHeader_t*>(map);
+    uint64_t nBins = (uint64_t)h->fNParticle * h->fNEnergy * h->fNAngle * h->fNCrystal;
+    uint64_t size = sizeof(A2ShowerLibHeader_t) + (nBins + 1)*sizeof(uint64_t) +
+                    h->fNShowers*sizeof(A2ShowerLibShower_t) + h->fNSpots*sizeof(A2ShowerLibSpot_t);
+    if (memcmp(h->fMagic, fgMagic, sizeof(fgMagic)) || h->fVersion != fgVersion ||
+        h->fNParticle != 3 || h->fNCrystal != 2 || (uint64_t)st.st_size != size)
+    {
+        G4cout << "A2ShowerLibrary::Map(): Unknown file format of " << name << "!" << G4endl;
+        munmap(map, st.st_size);
+        return false;
+    }
+
+    // set the tables
+    fMapping = map;
+    fMappingSize = st.st_size;
+    fHeader = h;
+    fBins = (const uint64_t*)((const char*)map + sizeof(A2ShowerLibHeader_t));
+    fShowers = (const A2ShowerLibShower_t*)(fBins + nBins + 1);
+    fSpots = (const A2ShowerLibSpot_t*)(fShowers + h->fNShowers);
+
+    G4cout << "A2ShowerLibrary::Map(): Mapped " << name << G4endl;
+    Print();
+
+    return true;
+}
+
+//______________________________________________________________________________
+G4int A2ShowerLibrary::GetBin(const A2ShowerLibHeader_t* h, const G4ParticleDefinition* part, G4double energy,
+                              G4double angle, const G4Material* mat)
+{
+    // Return the library bin of a particle 'part' with the shower energy
+    // 'energy' entering a crystal of the material 'mat' at the angle 'angle' to
+    // the crystal axis. Return -1 if the particle is outside of the library or
+    // 'mat' is not a crystal material.
+
+    // particle
+    G4int ip;
+    if (part == G4Gamma::Definition()) ip = 0;
+    else if (part == G4Electron::Definition()) ip = 1;
+    else if (part == G4Positron::Definition()) ip = 2;
+    else return -1;
+
+    // energy (logarithmic bins) and angle
+    G4double e = energy/MeV;
+    if (e < h->fEMin || e >= h->fEMax || angle < 0 || angle >= h->fAngleMax)
+        return -1;
+    G4int ie = (G4int)(h->fNEnergy * std::log(e / h->fEMin) / std::log(h->fEMax / h->fEMin));
+    G4int ia = (G4int)(h->fNAngle * angle / h->fAngleMax);
+    if (ie >= (G4int)h->fNEnergy) ie = h->fNEnergy - 1;
+    if (ia >= (G4int)h->fNAngle) ia = h->fNAngle - 1;
+
+    // crystal type (BaF2, PbWO4)
+    G4int ic;
+    if (mat->GetName().contains("BARIUM_FLUORIDE")) ic = 0;
+    else if (mat->GetName().contains("PbWO")) ic = 1;
+    else return -1;
+
+    return ((ip*h->fNEnergy + ie)*h->fNAngle + ia)*h->fNCrystal + ic;
+}
+
+//______________________________________________________________________________
+const A2ShowerLibShower_t* A2ShowerLibrary::SampleShower(G4int bin) const
+{
+    // Return a random shower of the bin 'bin' (0 if the bin is empty).
+
+    G4int n = GetNShowers(bin);
+    if (n <= 0)
+        return 0;
+    G4int i = (G4int)(n * G4UniformRand());
+    if (i >= n) i = n - 1;
+    return fShowers + fBins[bin] + i;
+}
+
+//______________________________________________________________________________
+void A2ShowerLibrary::Print() const
+{
+    // Print the binning and the content of the library.
+
+    if (!fHeader)
+        return;
+
+    G4int nBins = fHeader->fNParticle * fHeader->fNEnergy * fHeader->fNAngle * fHeader->fNCrystal;
+    G4int nFilled = 0;
+    for (G4int i = 0; i < nBins; i++)
+        if (GetNShowers(i)) nFilled++;
+
+    G4cout << "A2ShowerLibrary::Print(): " << fHeader->fNShowers << " showers, " << fHeader->fNSpots
+           << " energy spots, " << fMappingSize/1024./1024. << " MB, " << nFilled << " of " << nBins
+           << " bins filled (" << fHeader->fNEnergy << " energy bins " << fHeader->fEMin << " - "
+           << fHeader->fEMax << " MeV, " << fHeader->fNAngle << " angle bins 0 - "
+           << fHeader->fAngleMax/deg << " deg, gamma/e-/e+, BaF2/PbWO4)" << G4endl;
+}
+
+//______________________________________________________________________________
+void A2ShowerLibrary::SetRecording(const G4String& file)
+{
+    // Record the showers of single e+-/gamma entering the TAPS crystals in this
+    // run and write them to 'file' at the end of the run.
+
+    fgRecording = true;
+    fgRecordFile = file;
+
+    // default binning
+    memset(&fgRecBinning, 0, sizeof(fgRecBinning));
+    memcpy(fgRecBinning.fMagic, fgMagic, sizeof(fgMagic));
+    fgRecBinning.fVersion = fgVersion;
+    fgRecBinning.fNParticle = 3;
+    fgRecBinning.fNEnergy = 16;
+    fgRecBinning.fNAngle = 8;
+    fgRecBinning.fNCrystal = 2;
+    fgRecBinning.fEMin = 10;
+    fgRecBinning.fEMax = 2000;
+    fgRecBinning.fAngleMax = 24*deg;
+
+    fgRecorded.clear();
+    fgRecorded.resize(fgRecBinning.fNParticle * fgRecBinning.fNEnergy * fgRecBinning.fNAngle * fgRecBinning.fNCrystal);
+
+    G4cout << "A2ShowerLibrary::SetRecording(): Recording the TAPS showers into " << file << G4endl;
+}
+
+//______________________________________________________________________________
+void A2ShowerLibrary::RecordStep(const G4Step* step)
+{
+    // Record the energy deposits of the shower of the first primary e+-/gamma
+    // entering a TAPS crystal in the current event.
+
+    if (!fgRecState)
+        fgRecState = new A2RecState_t();
+    A2RecState_t* s = fgRecState;
+
+    // only deposits in the TAPS region
+    const G4StepPoint* pre = step->GetPreStepPoint();
+    G4VPhysicalVolume* pv = pre->GetPhysicalVolume();
+    if (!pv)
+        return;
+    if (!s->fRegion)
+        s->fRegion = G4RegionStore::GetInstance()->GetRegion("TAPS", false);
+    if (pv->GetLogicalVolume()->GetRegion() != s->fRegion)
+        return;
+
+    // start of the shower: primary entering a crystal
+    if (!s->fActive)
+    {
+        const G4Track* track = step->GetTrack();
+        if (track->GetParentID() != 0 || pre->GetStepStatus() != fGeomBoundary)
+            return;
+        s->fActive = true;
+        s->fEnergy = A2ShowerModel::GetShowerEnergy(track->GetDefinition(), pre->GetKineticEnergy());
+        s->fTime = pre->GetGlobalTime();
+        s->fPos = pre->GetPosition();
+        s->fDir = pre->GetMomentumDirection();
+        s->fU = s->fDir.orthogonal().unit();
+        s->fV = s->fDir.cross(s->fU);
+
+        // angle to the crystal axis
+        G4ThreeVector local = pre->GetTouchableHandle()->GetHistory()->GetTopTransform().TransformAxis(s->fDir);
+        G4double angle = std::acos(std::min(1., std::fabs(local.z())));
+        s->fBin = GetBin(&fgRecBinning, track->GetDefinition(), s->fEnergy, angle, pre->GetMaterial());
+    }
+    if (s->fBin < 0)
+        return;
+
+    // add the deposit to its cell in the shower frame
+    G4double edep = step->GetTotalEnergyDeposit();
+    if (edep <= 0)
+        return;
+    G4ThreeVector d = 0.5*(pre->GetPosition() + step->GetPostStepPoint()->GetPosition()) - s->fPos;
+    G4double l = d.dot(s->fDir);
+    G4double u = d.dot(s->fU);
+    G4double v = d.dot(s->fV);
+    G4long key = ((((G4long)std::floor(l/fgCellSize)) & 0x1FFFFF) << 42) |
+                 ((((G4long)std::floor(u/fgCellSize)) & 0x1FFFFF) << 21) |
+                 (((G4long)std::floor(v/fgCellSize)) & 0x1FFFFF);
+    A2ShowerLibSpot_t& cell = s->fCells[key];
+    G4double dt = pre->GetGlobalTime() - s->fTime;
+    cell.fL += l*edep;
+    cell.fU += u*edep;
+    cell.fV += v*edep;
+    cell.fE += edep;
+    cell.fT += dt*edep;
+}
+
+//______________________________________________________________________________
+void A2ShowerLibrary::EndOfEvent()
+{
+    // Add the shower of the current event to the library bins.
+
+    A2RecState_t* s = fgRecState;
+    if (!s)
+        return;
+
+    if (s->fActive && s->fBin >= 0 && !s->fCells.empty())
+    {
+        // energy-weighted cell positions and energy fractions
+        A2RecShower_t shower;
+        shower.fEnergy = s->fEnergy/MeV;
+        shower.fSpots.reserve(s->fCells.size());
+        for (std::unordered_map<G4long, A2ShowerLibSpot_t>::const_iterator it = s->fCells.begin();
+             it != s->fCells.end(); ++it)
+        {
+            const A2ShowerLibSpot_t& c = it->second;
+            A2ShowerLibSpot_t spot;
+            spot.fL = c.fL / c.fE / mm;
+            spot.fU = c.fU / c.fE / mm;
+            spot.fV = c.fV / c.fE / mm;
+            spot.fT = c.fT / c.fE / ns;
+            spot.fE = c.fE / s->fEnergy;
+            shower.fSpots.push_back(spot);
+        }
+
+        G4AutoLock lock(&gRecordMutex);
+        if ((G4int)fgRecorded[s->fBin].size() < fgMaxShowers)
+            fgRecorded[s->fBin].push_back(shower);
+    }
+
+    // reset
+    s->fActive = false;
+    s->fBin = -1;
+    s->fCells.clear();
+}
+
+//______________________________________________________________________________
+G4bool A2ShowerLibrary::WriteRecorded()
+{
+    // Write the recorded showers of all threads to the library file.
+
+    G4AutoLock lock(&gRecordMutex);
+
+    // header and bin table
+    A2ShowerLibHeader_t h = fgRecBinning;
+    std::vector<uint64_t> bins(fgRecorded.size() + 1, 0);
+    for (size_t i = 0; i < fgRecorded.size(); i++)
+    {
+        bins[i+1] = bins[i] + fgRecorded[i].size();
+        for (size_t j = 0; j < fgRecorded[i].size(); j++)
+            h.fNSpots += fgRecorded[i][j].fSpots.size();
+    }
+    h.fNShowers = bins.back();
+
+    // write to a temporary file and rename it, so that jobs never see a partial file
+    TString tmpName = TString::Format("%s.%d.tmp", fgRecordFile.c_str(), (G4int)getpid());
+    FILE* fout = fopen(tmpName.Data(), "wb");
+    if (!fout)
+    {
+        G4cout << "A2ShowerLibrary::WriteRecorded(): Could not write the shower library " << fgRecordFile << G4endl;
+        return false;
+    }
+    G4bool ok = fwrite(&h, sizeof(h), 1, fout) == 1 &&
+                fwrite(&bins[0], sizeof(uint64_t), bins.size(), fout) == bins.size();
+
+    // shower table
+    uint64_t first = 0;
+    for (size_t i = 0; ok && i < fgRecorded.size(); i++)
+    {
+        for (size_t j = 0; ok && j < fgRecorded[i].size(); j++)
+        {
+            A2ShowerLibShower_t s;
+            s.fEnergy = fgRecorded[i][j].fEnergy;
+            s.fNSpots = fgRecorded[i][j].fSpots.size();
+            s.fFirstSpot = first;
+            first += s.fNSpots;
+            ok = fwrite(&s, sizeof(s), 1, fout) == 1;
+        }
+    }
+
+    // energy spots
+    for (size_t i = 0; ok && i < fgRecorded.size(); i++)
+    {
+        for (size_t j = 0; ok && j < fgRecorded[i].size(); j++)
+        {
+            const std::vector<A2ShowerLibSpot_t>& spots = fgRecorded[i][j].fSpots;
+            ok = spots.empty() || fwrite(&spots[0], sizeof(A2ShowerLibSpot_t), spots.size(), fout) == spots.size();
+        }
+    }
+
+    ok = (fclose(fout) == 0) && ok;
+    if (!ok || rename(tmpName.Data(), fgRecordFile.c_str()))
+    {
+        G4cout << "A2ShowerLibrary::WriteRecorded(): Could not write the shower library " << fgRecordFile << G4endl;
+        remove(tmpName.Data());
+        return false;
+    }
+
+    G4cout << "A2ShowerLibrary::WriteRecorded(): Wrote " << h.fNShowers << " showers with "
+           << h.fNSpots << " energy spots to " << fgRecordFile << G4endl;
+    return true;
+}
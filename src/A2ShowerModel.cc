@@ -0,0 +1,205 @@
+// base class of the fast electromagnetic shower models depositing energy
+// spots in the crystals of a calorimeter region
+
+#include "G4Region.hh"
+#include "G4Navigator.hh"
+#include "G4TransportationManager.hh"
+#include "G4TouchableHistory.hh"
+#include "G4Step.hh"
+#include "G4StepPoint.hh"
+#include "G4Track.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4VSensitiveDetector.hh"
+#include "G4FastSimulationManagerProcess.hh"
+#include "G4ProcessManager.hh"
+#include "G4Gamma.hh"
+#include "G4Electron.hh"
+#include "G4Positron.hh"
+#include "CLHEP/Units/PhysicalConstants.h"
+#include "G4ios.hh"
+
+#include "A2ShowerModel.hh"
+
+//______________________________________________________________________________
+A2ShowerModel::A2ShowerModel(const G4String& name, G4Region* region)
+    : G4VFastSimulationModel(name, region)
+{
+    // Constructor.
+
+    // init members
+    fRegion = region;
+    fNavigator = new G4Navigator();
+    fNavigatorReady = false;
+    fTouchable = new G4TouchableHistory();
+    fFakeStep = new G4Step();
+    fFakePreStepPoint = fFakeStep->GetPreStepPoint();
+    fNShowers = 0;
+    fNSpots = 0;
+    fEDeposited = 0;
+    fETotal = 0;
+}
+
+//______________________________________________________________________________
+A2ShowerModel::~A2ShowerModel()
+{
+    // Destructor.
+
+    delete fFakeStep;
+    delete fNavigator;
+}
+
+//______________________________________________________________________________
+void A2ShowerModel::AddProcess()
+{
+    // Add the fast simulation process to e+-/gamma. Has to be called in the
+    // ConstructProcess() method of the physics list after AddTransportation().
+
+    G4FastSimulationManagerProcess* fsmp = new G4FastSimulationManagerProcess("A2FastShower");
+    G4Gamma::Gamma()->GetProcessManager()->AddDiscreteProcess(fsmp);
+    G4Electron::Electron()->GetProcessManager()->AddDiscreteProcess(fsmp);
+    G4Positron::Positron()->GetProcessManager()->AddDiscreteProcess(fsmp);
+
+    G4cout << "A2ShowerModel::AddProcess(): Fast shower simulation enabled for e+-/gamma" << G4endl;
+}
+
+//______________________________________________________________________________
+G4bool A2ShowerModel::IsApplicable(const G4ParticleDefinition& particle)
+{
+    // Return true for e+-/gamma.
+
+    return &particle == G4Gamma::Definition() ||
+           &particle == G4Electron::Definition() ||
+           &particle == G4Positron::Definition();
+}
+
+//______________________________________________________________________________
+G4double A2ShowerModel::GetShowerEnergy(const G4ParticleDefinition* part, G4double ekin)
+{
+    // Return the energy deposited by the shower of a particle 'part' with the
+    // kinetic energy 'ekin' (positrons annihilate).
+
+    if (part == G4Positron::Definition())
+        return ekin + 2*CLHEP::electron_mass_c2;
+    return ekin;
+}
+
+//______________________________________________________________________________
+G4double A2ShowerModel::GetShowerEnergy(const G4Track* track)
+{
+    // Return the energy deposited by the shower of 'track'.
+
+    return GetShowerEnergy(track->GetDefinition(), track->GetKineticEnergy());
+}
+
+//______________________________________________________________________________
+void A2ShowerModel::BeginShower(const G4FastTrack& fastTrack, G4FastStep& fastStep)
+{
+    // Kill the particle of 'fastTrack' whose energy is deposited in energy
+    // spots via the sensitive detectors only.
+
+    const G4Track* track = fastTrack.GetPrimaryTrack();
+
+    fastStep.KillPrimaryTrack();
+    fastStep.ProposePrimaryTrackPathLength(0);
+    fastStep.ProposeTotalEnergyDeposited(0);
+
+    fFakeStep->SetTrack(const_cast<G4Track*>(track));
+    fNShowers++;
+    fETotal += GetShowerEnergy(track);
+}
+
+//______________________________________________________________________________
+void A2ShowerModel::Deposit(const G4ThreeVector& pos, G4double time, G4double edep)
+{
+    // Add the energy deposit 'edep' at 'pos' to the crystal at this position.
+    // Spots outside the crystals of the region are lost (leakage). The spots
+    // are passed to the sensitive detectors per crystal by EndShower().
+
+    fNSpots++;
+
+    // the first search starts at the world volume, later ones at the last spot
+    if (!fNavigatorReady)
+    {
+        fNavigator->SetWorldVolume(G4TransportationManager::GetTransportationManager()->
+                                   GetNavigatorForTracking()->GetWorldVolume());
+        fNavigator->LocateGlobalPointAndUpdateTouchableHandle(pos, G4ThreeVector(0, 0, 0), fTouchable, false);
+        fNavigatorReady = true;
+    }
+    else
+    {
+        fNavigator->LocateGlobalPointAndUpdateTouchableHandle(pos, G4ThreeVector(0, 0, 0), fTouchable);
+    }
+    G4VPhysicalVolume* pv = fTouchable->GetVolume();
+    if (!pv)
+        return;
+    G4LogicalVolume* lv = pv->GetLogicalVolume();
+    if (lv->GetRegion() != fRegion)
+        return;
+    G4VSensitiveDetector* sd = lv->GetSensitiveDetector();
+    if (!sd)
+        return;
+
+    // sum the spots per crystal, keep the earliest spot
+    A2CrystalKey_t key(pv, fTouchable->GetVolume(1));
+    std::map<A2CrystalKey_t, size_t>::iterator it = fDepositIndex.find(key);
+    if (it == fDepositIndex.end())
+    {
+        A2ShowerDeposit_t d;
+        d.fTouchable = fTouchable;
+        d.fSD = sd;
+        d.fPos = pos;
+        d.fTime = time;
+        d.fEdep = edep;
+        fDepositIndex[key] = fDeposits.size();
+        fDeposits.push_back(d);
+    }
+    else
+    {
+        A2ShowerDeposit_t& d = fDeposits[it->second];
+        d.fEdep += edep;
+        if (time < d.fTime)
+        {
+            d.fTime = time;
+            d.fPos = pos;
+        }
+    }
+    fEDeposited += edep;
+}
+
+//______________________________________________________________________________
+void A2ShowerModel::EndShower()
+{
+    // Pass the summed energy of the current shower in each crystal to its
+    // sensitive detector in one step with the time of the earliest spot.
+    // Single spots are below the energy thresholds of the sensitive detectors
+    // updating the hit times, the summed deposits give the same hit times as
+    // the full simulation.
+
+    for (size_t i = 0; i < fDeposits.size(); i++)
+    {
+        const A2ShowerDeposit_t& d = fDeposits[i];
+        fFakePreStepPoint->SetPosition(d.fPos);
+        fFakePreStepPoint->SetGlobalTime(d.fTime);
+        fFakePreStepPoint->SetTouchableHandle(d.fTouchable);
+        fFakeStep->SetTotalEnergyDeposit(d.fEdep);
+        d.fSD->Hit(fFakeStep);
+    }
+    fDeposits.clear();
+    fDepositIndex.clear();
+}
+
+//______________________________________________________________________________
+void A2ShowerModel::PrintStatistics()
+{
+    // Print the statistics of the showers and reset them.
+
+    G4cout << GetName() << "::PrintStatistics(): " << fNShowers << " showers, "
+           << fNSpots << " energy spots, " << (fETotal > 0 ? 100*fEDeposited/fETotal : 0.)
+           << "% of the energy deposited in the crystals" << G4endl;
+
+    fNShowers = 0;
+    fNSpots = 0;
+    fEDeposited = 0;
+    fETotal = 0;
+}
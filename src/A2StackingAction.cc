@@ -0,0 +1,142 @@
+// A2StackingAction
+// Russian roulette of low-energy e+-/gamma created outside of the sensitive
+// volumes and splitting of weighted tracks entering them
+
+#include "G4Track.hh"
+#include "G4Step.hh"
+#include "G4StepPoint.hh"
+#include "G4DynamicParticle.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4Gamma.hh"
+#include "G4Electron.hh"
+#include "G4Positron.hh"
+#include "Randomize.hh"
+#include "CLHEP/Units/SystemOfUnits.h"
+#include "G4ios.hh"
+
+#include "A2StackingAction.hh"
+#include "A2UserTrackInformation.hh"
+#include "A2TrackKiller.hh"
+
+using namespace CLHEP;
+
+G4double A2StackingAction::fgRouletteEnergy = 0;
+G4double A2StackingAction::fgSurvival = 0.1;
+G4bool A2StackingAction::fgSplit = true;
+G4int A2StackingAction::fgMaxSplit = 100;
+G4ThreadLocal A2StackingAction* A2StackingAction::fgInstance = 0;
+
+//______________________________________________________________________________
+A2StackingAction::A2StackingAction()
+{
+    // Constructor.
+
+    // init members
+    fNRoulette = 0;
+    fNKilled = 0;
+    fNSplit = 0;
+
+    fgInstance = this;
+}
+
+//______________________________________________________________________________
+A2StackingAction::~A2StackingAction()
+{
+    // Destructor.
+
+    if (fgInstance == this)
+        fgInstance = 0;
+}
+
+//______________________________________________________________________________
+G4ClassificationOfNewTrack A2StackingAction::ClassifyNewTrack(const G4Track* aTrack)
+{
+    // Kill tracks excluded by the track killer rules. Play Russian roulette
+    // with e+-/gamma below the energy threshold created in a volume without
+    // sensitive detector: the track survives with the survival probability
+    // and its weight is divided by it.
+
+    if (A2TrackKiller::Instance()->KillNewTrack(aTrack))
+        return fKill;
+
+    // secondaries carry the touchable of their creation point
+    if (fgRouletteEnergy <= 0 || aTrack->GetParentID() == 0 || aTrack->GetKineticEnergy() >= fgRouletteEnergy)
+        return fUrgent;
+
+    // e+-/gamma only
+    const G4ParticleDefinition* part = aTrack->GetDefinition();
+    if (part != G4Gamma::Definition() && part != G4Electron::Definition() && part != G4Positron::Definition())
+        return fUrgent;
+
+    // passive volumes only
+    const G4VPhysicalVolume* pv = aTrack->GetVolume();
+    if (!pv || pv->GetLogicalVolume()->GetSensitiveDetector())
+        return fUrgent;
+
+    // roulette
+    fNRoulette++;
+    if (G4UniformRand() >= fgSurvival)
+    {
+        fNKilled++;
+        return fKill;
+    }
+    const_cast<G4Track*>(aTrack)->SetWeight(aTrack->GetWeight() / fgSurvival);
+
+    return fUrgent;
+}
+
+//______________________________________________________________________________
+void A2StackingAction::SplitTrack(const G4Step* aStep, G4TrackVector* secondaries)
+{
+    // Split a weighted track entering a sensitive volume into copies of about
+    // unit weight to reduce the weight fluctuations of the energy deposits.
+
+    if (!fgSplit)
+        return;
+
+    // weighted track entering a sensitive volume
+    G4Track* track = aStep->GetTrack();
+    G4double w = track->GetWeight();
+    if (w < 2)
+        return;
+    const G4StepPoint* post = aStep->GetPostStepPoint();
+    if (post->GetStepStatus() != fGeomBoundary || !post->GetPhysicalVolume() ||
+        !post->GetPhysicalVolume()->GetLogicalVolume()->GetSensitiveDetector())
+        return;
+
+    // create the copies at the entry point
+    G4int n = (G4int)(w + 0.5);
+    if (n > fgMaxSplit) n = fgMaxSplit;
+    G4double wSplit = w / n;
+    track->SetWeight(wSplit);
+    A2UserTrackInformation* info = (A2UserTrackInformation*) track->GetUserInformation();
+    for (G4int i = 1; i < n; i++)
+    {
+        G4Track* copy = new G4Track(new G4DynamicParticle(*track->GetDynamicParticle()),
+                                    post->GetGlobalTime(), post->GetPosition());
+        copy->SetTouchableHandle(post->GetTouchableHandle());
+        copy->SetParentID(track->GetTrackID());
+        copy->SetWeight(wSplit);
+        if (info) copy->SetUserInformation(new A2UserTrackInformation(info));
+        secondaries->push_back(copy);
+    }
+    fNSplit += n - 1;
+}
+
+//______________________________________________________________________________
+void A2StackingAction::PrintStatistics()
+{
+    // Print the roulette and splitting statistics and reset them.
+
+    if (!IsEnabled())
+        return;
+
+    G4cout << "A2StackingAction::PrintStatistics(): Russian roulette below " << fgRouletteEnergy/MeV
+           << " MeV (survival probability " << fgSurvival << "): " << fNKilled << " of " << fNRoulette
+           << " tracks killed, " << fNSplit << " track copies created by splitting" << G4endl;
+
+    fNRoulette = 0;
+    fNKilled = 0;
+    fNSplit = 0;
+}
@@ -4,17 +4,24 @@
 
 #include "A2DetectorConstruction.hh"
 #include "A2EventAction.hh"
+#include "A2ShowerLibrary.hh"
+#include "A2StackingAction.hh"
+#include "A2TrackKiller.hh"
+#include "A2Profiler.hh"
 
 #include "G4Track.hh"
 #include "G4Gamma.hh"
 #include "G4Proton.hh"
 #include "G4SteppingManager.hh"
+#include "G4ProcessManager.hh"
+#include "G4RunManager.hh"
 #include "CLHEP/Units/SystemOfUnits.h"
 
 using namespace CLHEP;
 
-////#include "G4RunManager.hh"
-
+G4bool A2SteppingAction::fgActive=true;
+G4bool A2SteppingAction::fgKillStuckPhotons=true;
+G4ThreadLocal A2SteppingAction* A2SteppingAction::fgInstance=0;
 
 
 A2SteppingAction::A2SteppingAction(A2DetectorConstruction* det,
@@ -22,12 +29,68 @@ A2SteppingAction::A2SteppingAction(A2DetectorConstruction* det,
 {
     detector = det;
     eventaction = evt;
+    fKiller = A2TrackKiller::Instance();
+    fGamma = G4Gamma::Gamma();
+    fPhot = 0;
+    fKillStuckPhotons = false;
+    fSplit = false;
+    fRecord = false;
+    fProfiler = A2Profiler::Instance();
+    fProfile = false;
+    fgInstance = this;
 }
 
 
 
 A2SteppingAction::~A2SteppingAction()
-{ }
+{
+  if(fgInstance==this) fgInstance=0;
+}
+
+
+
+void A2SteppingAction::BeginOfRun()
+{
+  //resolve the process and the settings used on every step once per run
+  G4ProcessManager* pm=fGamma->GetProcessManager();
+  fPhot = pm ? pm->GetProcess("phot") : 0;
+  fKillStuckPhotons = fgKillStuckPhotons && fPhot;
+  fSplit = A2StackingAction::IsEnabled();
+  fRecord = A2ShowerLibrary::IsRecording();
+  fProfile = A2Profiler::IsEnabled();
+
+  //switch the stepping action off for this run unless a user setting needs it
+  //(kill rules at the step points, splitting, recording, profiling)
+  if(fgActive) return;
+  G4String used;
+  if(A2TrackKiller::HasStepRules(false)) used+=", energy floors/time limits of the kill rules";
+  if(fSplit) used+=", splitting of weighted tracks";
+  if(fRecord) used+=", shower library recording";
+  if(fProfile) used+=", profiler";
+  if(used!=""){
+    G4cout<<"A2SteppingAction::BeginOfRun() Stepping action kept, it is needed for: "<<used.substr(2)<<G4endl;
+    return;
+  }
+
+  //the defaults depending on it are switched off with it, the default time
+  //limit is still applied to new tracks by the stacking action
+  G4String off;
+  if(A2TrackKiller::HasStepRules()) off+=", default time limit at the step points (new tracks are still checked)";
+  if(fKillStuckPhotons) off+=", stuck-photon workaround";
+  fKillStuckPhotons=false;
+  G4cout<<"A2SteppingAction::BeginOfRun() Stepping action switched off";
+  if(off!="") G4cout<<", disabled: "<<off.substr(2);
+  G4cout<<G4endl;
+  G4RunManager::GetRunManager()->SetUserAction((G4UserSteppingAction*)0);
+}
+
+
+
+void A2SteppingAction::EndOfRun()
+{
+  //the run manager owns the stepping action again
+  G4RunManager::GetRunManager()->SetUserAction(this);
+}
 
 
 
@@ -35,14 +98,16 @@ void A2SteppingAction::UserSteppingAction(const G4Step* aStep)
 {
   //  return;
   G4Track* track = aStep->GetTrack();
+  if(fProfile) fProfiler->Step(aStep);
 //   G4VPhysicalVolume* volume = track->GetVolume();
   
 //   // collect energy and track length step by step
 //   G4double edep = aStep->GetTotalEnergyDeposit();
   
 //   G4double stepl = 0.;
-//stop tracking after the trigger time
-  if(aStep->GetPreStepPoint()->GetGlobalTime()>2*ms)track->SetTrackStatus(fStopAndKill);
+//energy floors and time windows per region and particle (by default tracking
+//stops after the trigger time of 2 ms)
+  if(fKiller->KillAtStepPoint(track,aStep->GetPostStepPoint()))track->SetTrackStatus(fStopAndKill);
 //   if(track->GetDefinition()->GetParticleName()==G4String("pi0"))
 //     {G4cout<<"Got a pi0 "<<aStep->GetPreStepPoint()->GetGlobalTime()/ns<<" "<<track->GetKineticEnergy()/MeV<<" "<< fpSteppingManager->GetfCurrentVolume()->GetName()<<G4endl;track->SetTrackStatus(fStopAndKill);}
 //  if(track->GetDefinition()->GetParticleName()==G4String("pi+"))
@@ -76,7 +141,13 @@ void A2SteppingAction::UserSteppingAction(const G4Step* aStep)
 
   //bug in phot process, can't get rid of gamma with energy 1.2E-5MeV
   //goes into infinite loop!
-  if(track->GetDefinition()->GetParticleName()==G4Gamma::Gamma()->GetParticleName()&&track->GetKineticEnergy()/MeV<1E-4&&fpSteppingManager->GetfCurrentProcess()->GetProcessName()==G4String("phot"))track->SetTrackStatus(fStopAndKill);
+  if(fKillStuckPhotons&&track->GetDefinition()==fGamma&&track->GetKineticEnergy()<1E-4*MeV&&fpSteppingManager->GetfCurrentProcess()==fPhot)track->SetTrackStatus(fStopAndKill);
+
+  //splitting of weighted tracks entering sensitive volumes
+  if(fSplit) A2StackingAction::Instance()->SplitTrack(aStep,fpSteppingManager->GetfSecondary());
+
+  //shower library recording run
+  if(fRecord) A2ShowerLibrary::RecordStep(aStep);
 }
 
 
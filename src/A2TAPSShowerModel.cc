@@ -0,0 +1,122 @@
+// fast simulation of electromagnetic showers in the TAPS crystals using a
+// library of frozen showers
+
+#include <cmath>
+
+#include "G4Region.hh"
+#include "G4Track.hh"
+#include "G4Step.hh"
+#include "G4StepPoint.hh"
+#include "G4AutoLock.hh"
+#include "Randomize.hh"
+#include "CLHEP/Units/SystemOfUnits.h"
+#include "G4ios.hh"
+
+#include "A2TAPSShowerModel.hh"
+#include "A2ShowerLibrary.hh"
+
+using namespace CLHEP;
+
+namespace { G4Mutex gLibraryMutex = G4MUTEX_INITIALIZER; }
+
+G4ThreadLocal A2TAPSShowerModel* A2TAPSShowerModel::fgInstance = 0;
+G4bool A2TAPSShowerModel::fgEnabled = false;
+G4String A2TAPSShowerModel::fgLibraryName;
+A2ShowerLibrary* A2TAPSShowerModel::fgLibrary = 0;
+
+//______________________________________________________________________________
+A2TAPSShowerModel::A2TAPSShowerModel(G4Region* region)
+    : A2ShowerModel("A2TAPSShowerModel", region)
+{
+    // Constructor.
+    // The model replaces the tracking of e+-/gamma entering the crystals of
+    // 'region' by a random shower of the library of the corresponding bin.
+
+    // init members
+    fBin = -1;
+
+    // map the library once for all threads
+    {
+        G4AutoLock lock(&gLibraryMutex);
+        if (!fgLibrary)
+        {
+            fgLibrary = new A2ShowerLibrary();
+            if (!fgLibrary->Map(fgLibraryName))
+            {
+                G4cout << "A2TAPSShowerModel::A2TAPSShowerModel(): Could not load the shower library "
+                       << fgLibraryName << "!" << G4endl;
+                exit(1);
+            }
+        }
+    }
+
+    fgInstance = this;
+
+    G4cout << "A2TAPSShowerModel::A2TAPSShowerModel(): Frozen showers in region " << region->GetName()
+           << " from " << fgLibraryName << G4endl;
+}
+
+//______________________________________________________________________________
+A2TAPSShowerModel::~A2TAPSShowerModel()
+{
+    // Destructor.
+
+    if (fgInstance == this)
+        fgInstance = 0;
+}
+
+//______________________________________________________________________________
+G4bool A2TAPSShowerModel::ModelTrigger(const G4FastTrack& fastTrack)
+{
+    // Use a frozen shower for particles that have just entered a crystal if
+    // the library contains showers of their bin, otherwise keep the full
+    // simulation.
+
+    // particle entering the crystal (the pre-step point of the step being
+    // defined is the end point of the previous step)
+    const G4Track* track = fastTrack.GetPrimaryTrack();
+    const G4Step* step = track->GetStep();
+    if (!step || step->GetPreStepPoint()->GetStepStatus() != fGeomBoundary)
+        return false;
+
+    // angle to the crystal axis
+    G4double cosAngle = std::fabs(fastTrack.GetPrimaryTrackLocalDirection().z());
+    G4double angle = std::acos(std::min(1., cosAngle));
+
+    fBin = fgLibrary->GetBin(track->GetDefinition(), GetShowerEnergy(track), angle, track->GetMaterial());
+    return fgLibrary->GetNShowers(fBin) > 0;
+}
+
+//______________________________________________________________________________
+void A2TAPSShowerModel::DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep)
+{
+    // Kill the particle and deposit the energy spots of a random shower of its
+    // bin, rotated randomly around the particle direction and scaled to the
+    // particle energy. The spots are summed per crystal and passed to its
+    // sensitive detector, spots outside the crystals are lost (leakage).
+
+    const G4Track* track = fastTrack.GetPrimaryTrack();
+    BeginShower(fastTrack, fastStep);
+    G4double energy = GetShowerEnergy(track);
+
+    // shower frame with a random azimuthal orientation
+    G4ThreeVector pos = track->GetPosition();
+    G4ThreeVector dir = track->GetMomentumDirection();
+    G4ThreeVector u0 = dir.orthogonal().unit();
+    G4ThreeVector v0 = dir.cross(u0);
+    G4double phi = twopi * G4UniformRand();
+    G4ThreeVector u = std::cos(phi)*u0 + std::sin(phi)*v0;
+    G4ThreeVector v = dir.cross(u);
+    G4double time = track->GetGlobalTime();
+
+    // energy spots
+    const A2ShowerLibShower_t* shower = fgLibrary->SampleShower(fBin);
+    const A2ShowerLibSpot_t* spots = fgLibrary->GetSpots(shower);
+    for (uint32_t i = 0; i < shower->fNSpots; i++)
+    {
+        const A2ShowerLibSpot_t& s = spots[i];
+        G4ThreeVector spot = pos + s.fL*mm*dir + s.fU*mm*u + s.fV*mm*v;
+        Deposit(spot, time + s.fT*ns, s.fE*energy);
+    }
+    EndShower();
+}
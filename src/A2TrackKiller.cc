@@ -0,0 +1,271 @@
+// Table-driven killing of tracks by region and particle type: energy floors,
+// time windows and particles that are never tracked
+
+#include <cfloat>
+#include <algorithm>
+
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4Track.hh"
+#include "G4StepPoint.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "CLHEP/Units/SystemOfUnits.h"
+#include "G4ios.hh"
+
+#include "A2TrackKiller.hh"
+
+using namespace CLHEP;
+
+// tracks are killed after 2 ms (after the trigger time) by default
+std::vector<A2TrackKiller::A2KillRule_t> A2TrackKiller::fgRules(1, { "all", "all", kKillAfter, 2*ms });
+G4int A2TrackKiller::fgGeneration = 1;
+G4bool A2TrackKiller::fgDefaultRule = true;
+G4ThreadLocal A2TrackKiller* A2TrackKiller::fgInstance = 0;
+
+//______________________________________________________________________________
+A2TrackKiller::A2TrackKiller()
+{
+    // Constructor.
+
+    // init members
+    fGeneration = 0;
+    fLastRegion = 0;
+    fLastRow = 0;
+    fLastPart = 0;
+    fLastCol = 0;
+    for (G4int i = 0; i < 3; i++)
+        fNKilled[i] = 0;
+}
+
+//______________________________________________________________________________
+void A2TrackKiller::AddRule(const G4String& region, const G4String& particle, EA2KillRule type, G4double value)
+{
+    // Add a kill rule for the particle 'particle' in the region 'region'.
+    // Rules of a specific region/particle take precedence over rules for
+    // "all", later rules of the same specificity replace earlier ones.
+    // Energy floors and time limits never lift a rule killing a particle
+    // always, e.g. a region-specific floor for all particles keeps the
+    // neutrinos of an all-region kill rule killed.
+
+    A2KillRule_t rule = { region, particle, type, value };
+    fgRules.push_back(rule);
+    fgGeneration++;
+}
+
+//______________________________________________________________________________
+void A2TrackKiller::ClearRules()
+{
+    // Remove all kill rules including the default time limit.
+
+    fgRules.clear();
+    fgGeneration++;
+    fgDefaultRule = false;
+}
+
+//______________________________________________________________________________
+void A2TrackKiller::PrintRules()
+{
+    // Print the configured kill rules.
+
+    G4cout << "A2TrackKiller::PrintRules(): " << fgRules.size() << " kill rules" << G4endl;
+    for (size_t i = 0; i < fgRules.size(); i++)
+    {
+        const A2KillRule_t& r = fgRules[i];
+        G4cout << "  region " << r.fRegion << ", particle " << r.fParticle << ": ";
+        if (r.fType == kKillBelow) G4cout << "kill below " << r.fValue/MeV << " MeV";
+        else if (r.fType == kKillAfter) G4cout << "kill after " << r.fValue/ns << " ns";
+        else G4cout << "kill always";
+        G4cout << G4endl;
+    }
+}
+
+//______________________________________________________________________________
+G4bool A2TrackKiller::HasStepRules(G4bool withDefault)
+{
+    // Return true if a rule is checked at the step points, i.e. an energy
+    // floor or a time limit (the other rules act on new tracks only).
+    // The default time limit is ignored if 'withDefault' is false.
+
+    for (size_t i = (fgDefaultRule && !withDefault) ? 1 : 0; i < fgRules.size(); i++)
+        if (fgRules[i].fType == kKillBelow || fgRules[i].fType == kKillAfter)
+            return true;
+    return false;
+}
+
+//______________________________________________________________________________
+void A2TrackKiller::Compile()
+{
+    // Compile the kill rules into the region/particle table of this thread.
+
+    // rows and columns of the regions and particles named in the rules
+    fRegionKeys.assign(1, "");
+    fPartKeys.assign(1, "");
+    for (size_t i = 0; i < fgRules.size(); i++)
+    {
+        const A2KillRule_t& r = fgRules[i];
+        if (r.fRegion != "all" && std::find(fRegionKeys.begin(), fRegionKeys.end(), r.fRegion) == fRegionKeys.end())
+            fRegionKeys.push_back(r.fRegion);
+        if (r.fParticle != "all" && std::find(fPartKeys.begin(), fPartKeys.end(), r.fParticle) == fPartKeys.end())
+            fPartKeys.push_back(r.fParticle);
+    }
+
+    // fill the cells: rules for all regions and particles first, specific rules last
+    A2KillCut_t none = { 0, DBL_MAX, false };
+    fTable.assign(fRegionKeys.size()*fPartKeys.size(), none);
+    for (G4int level = 0; level < 4; level++)
+    {
+        for (size_t i = 0; i < fgRules.size(); i++)
+        {
+            const A2KillRule_t& r = fgRules[i];
+            G4bool allRegions = r.fRegion == "all";
+            G4bool allParts = r.fParticle == "all";
+            if ((allRegions ? 0 : 2) + (allParts ? 0 : 1) != level)
+                continue;
+            for (size_t row = 0; row < fRegionKeys.size(); row++)
+            {
+                if (!allRegions && fRegionKeys[row] != r.fRegion)
+                    continue;
+                for (size_t col = 0; col < fPartKeys.size(); col++)
+                {
+                    if (!allParts && fPartKeys[col] != r.fParticle)
+                        continue;
+                    A2KillCut_t& cut = fTable[row*fPartKeys.size() + col];
+                    if (r.fType == kKillBelow) cut.fEMin = r.fValue;
+                    else if (r.fType == kKillAfter) cut.fTMax = r.fValue;
+                    else cut.fAlways = true;
+                }
+            }
+        }
+    }
+
+    // look-ups are resolved again
+    fRegionIndex.clear();
+    fPartIndex.clear();
+    fLastRegion = 0;
+    fLastRow = 0;
+    fLastPart = 0;
+    fLastCol = 0;
+    fGeneration = fgGeneration;
+}
+
+//______________________________________________________________________________
+G4int A2TrackKiller::GetRow(const G4Region* region)
+{
+    // Return the table row of the region 'region'.
+
+    if (region == fLastRegion)
+        return fLastRow;
+
+    std::unordered_map<const G4Region*, G4int>::const_iterator it = fRegionIndex.find(region);
+    G4int row = 0;
+    if (it != fRegionIndex.end())
+    {
+        row = it->second;
+    }
+    else
+    {
+        for (size_t i = 1; region && i < fRegionKeys.size(); i++)
+            if (region->GetName() == fRegionKeys[i]) row = i;
+        fRegionIndex[region] = row;
+    }
+
+    fLastRegion = region;
+    fLastRow = row;
+    return row;
+}
+
+//______________________________________________________________________________
+G4int A2TrackKiller::GetColumn(const G4ParticleDefinition* part)
+{
+    // Return the table column of the particle 'part'.
+
+    if (part == fLastPart)
+        return fLastCol;
+
+    std::unordered_map<const G4ParticleDefinition*, G4int>::const_iterator it = fPartIndex.find(part);
+    G4int col = 0;
+    if (it != fPartIndex.end())
+    {
+        col = it->second;
+    }
+    else
+    {
+        const G4String& name = part->GetParticleName();
+        G4bool isNeutrino = part->GetParticleType() == "lepton" && part->GetPDGCharge() == 0;
+        for (size_t i = 1; i < fPartKeys.size(); i++)
+            if (name == fPartKeys[i] || (isNeutrino && fPartKeys[i] == "neutrino")) col = i;
+        fPartIndex[part] = col;
+    }
+
+    fLastPart = part;
+    fLastCol = col;
+    return col;
+}
+
+//______________________________________________________________________________
+G4bool A2TrackKiller::Check(const G4Region* region, const G4ParticleDefinition* part, G4double ekin, G4double time)
+{
+    // Check the cuts of the region/particle cell.
+
+    if (fGeneration != fgGeneration)
+        Compile();
+
+    const A2KillCut_t& cut = fTable[GetRow(region)*fPartKeys.size() + GetColumn(part)];
+    if (cut.fAlways)
+    {
+        fNKilled[kKillAlways]++;
+        return true;
+    }
+    if (time > cut.fTMax)
+    {
+        fNKilled[kKillAfter]++;
+        return true;
+    }
+    if (ekin < cut.fEMin)
+    {
+        fNKilled[kKillBelow]++;
+        return true;
+    }
+    return false;
+}
+
+//______________________________________________________________________________
+G4bool A2TrackKiller::KillNewTrack(const G4Track* track)
+{
+    // Return true if the new track 'track' should not be tracked at all.
+    // Secondaries carry the touchable of their creation point, tracks without
+    // volume (primaries) use the rules for all regions.
+
+    const G4VPhysicalVolume* pv = track->GetVolume();
+    const G4Region* region = pv ? pv->GetLogicalVolume()->GetRegion() : 0;
+    return Check(region, track->GetDefinition(), track->GetKineticEnergy(), track->GetGlobalTime());
+}
+
+//______________________________________________________________________________
+G4bool A2TrackKiller::KillAtStepPoint(const G4Track* track, const G4StepPoint* point)
+{
+    // Return true if the track 'track' should be killed at the step point
+    // 'point' (the end point of the current step) before its next step.
+    // Particles stopped but still alive (e.g. positrons before annihilation at
+    // rest) are not subject to the energy floors.
+
+    const G4VPhysicalVolume* pv = point->GetPhysicalVolume();
+    if (!pv || track->GetTrackStatus() == fStopAndKill || track->GetTrackStatus() == fKillTrackAndSecondaries)
+        return false;
+    G4double ekin = track->GetTrackStatus() == fStopButAlive ? DBL_MAX : point->GetKineticEnergy();
+    return Check(pv->GetLogicalVolume()->GetRegion(), track->GetDefinition(), ekin, point->GetGlobalTime());
+}
+
+//______________________________________________________________________________
+void A2TrackKiller::PrintStatistics()
+{
+    // Print the number of killed tracks and reset it.
+
+    G4cout << "A2TrackKiller::PrintStatistics(): Tracks killed: " << fNKilled[kKillBelow] << " below energy floors, "
+           << fNKilled[kKillAfter] << " after time limits, " << fNKilled[kKillAlways] << " by particle type" << G4endl;
+
+    for (G4int i = 0; i < 3; i++)
+        fNKilled[i] = 0;
+}
@@ -8,6 +8,8 @@
 #include "A2TrackingAction.hh"
 #include "A2UserTrackInformation.hh"
 #include "A2PrimaryGeneratorAction.hh"
+#include "A2Profiler.hh"
+#include "A2EventStats.hh"
 
 //______________________________________________________________________________
 A2TrackingAction::A2TrackingAction()
@@ -16,6 +18,7 @@ A2TrackingAction::A2TrackingAction()
 
     fPGA = (A2PrimaryGeneratorAction*)
             G4RunManager::GetRunManager()->GetUserPrimaryGeneratorAction();
+    fEventStats = A2EventStats::Instance();
 }
 
 //______________________________________________________________________________
@@ -49,6 +52,10 @@ void A2TrackingAction::PreUserTrackingAction(const G4Track* aTrack)
                << G4endl;
         exit(-1);
     }
+
+    // tracking profile
+    if (A2Profiler::IsEnabled())
+        A2Profiler::Instance()->BeginTrack(aTrack);
 }
 
 //______________________________________________________________________________
@@ -56,6 +63,13 @@ void A2TrackingAction::PostUserTrackingAction(const G4Track* aTrack)
 {
     // Overwrite PostUserTrackingAction().
 
+    // tracking profile
+    if (A2Profiler::IsEnabled())
+        A2Profiler::Instance()->EndTrack(aTrack);
+
+    // steps and tracks of the event
+    fEventStats->EndTrack(aTrack);
+
     // get list of secondaries
     G4TrackVector* secondaries = fpTrackingManager->GimmeSecondaries();
 
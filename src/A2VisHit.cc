@@ -6,8 +6,6 @@
 
 using namespace CLHEP;
 
-G4Allocator<A2VisHit> A2VisHitAllocator;
-
 A2VisHit::A2VisHit()
 {
   fEdep=0;
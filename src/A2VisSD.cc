@@ -87,7 +87,7 @@ G4bool A2VisSD::ProcessHits(G4Step* aStep,G4TouchableHistory*)
     A2VisHit* myHit = new A2VisHit();
     //standard hit stuff
     myHit->SetID(id);
-    myHit->AddEnergy(edep);
+    myHit->AddEnergy(edep, aStep->GetTrack()->GetWeight());
     myHit->AddPartEnergy(track_info->GetPartID(), edep);
     myHit->SetPos(aStep->GetPreStepPoint()->GetPosition());
     myHit->SetTime(aStep->GetPreStepPoint()->GetGlobalTime());
@@ -101,7 +101,7 @@ G4bool A2VisSD::ProcessHits(G4Step* aStep,G4TouchableHistory*)
   }
   else // This is not new
     {
-    (*fCollection)[fhitID[id]]->AddEnergy(edep);
+    (*fCollection)[fhitID[id]]->AddEnergy(edep, aStep->GetTrack()->GetWeight());
     (*fCollection)[fhitID[id]]->AddPartEnergy(track_info->GetPartID(), edep);
     }
   return true;
@@ -113,6 +113,7 @@ void A2VisSD::EndOfEvent(G4HCofThisEvent* HCE)
   // G4cout<<"EndOfEvent( "<<fHCID<<" "<<fCollection<<" "<<fNhits<<G4endl;
   if(fHCID<0) fHCID = G4SDManager::GetSDMpointer()->GetCollectionID(collectionName[0]);
   if(fNhits>0)  HCE->AddHitsCollection(fHCID,fCollection);
+  else delete fCollection; //empty collections are not owned by the event
   //G4cout<<"EndOfEvent( "<<G4endl;
  
   //reset hit arrays
@@ -138,6 +139,13 @@ void A2VisSD::PrintAll()
 {} 
 
 
+G4VSensitiveDetector* A2VisSD::Clone() const
+{
+  //worker thread copy of this detector (fNelements includes the 0 element)
+  return new A2VisSD(SensitiveDetectorName,fNelements-1);
+}
+
+
 
 
 
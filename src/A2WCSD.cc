@@ -11,21 +11,28 @@
 #include "CLHEP/Units/SystemOfUnits.h"
 
 #include "stdio.h"
+#include <stdint.h>
+#include <cmath>
 
 using namespace CLHEP;
 
+//hits closer than this are merged (e.g. ionised electrons should not create a new hit)
+const G4double A2WCSD::fgMergeRadius=3*mm;
+
 A2WCSD::A2WCSD(G4String name,G4int Nelements):G4VSensitiveDetector(name)
 {
   collectionName.insert(G4String("A2WCSDHits")+name);
   fCollection=NULL;
 
   fNelements=Nelements+1;//numbering starts from 1 not 0
-  //fNelements=100;//now total number of hit positions stored
-  fhitID=new G4int[fNelements];
-  for(G4int i=0;i<fNelements;i++)fhitID[i]=-1;
-  fHits=new G4int[fNelements];
-  for(G4int i=0;i<fNelements;i++)fHits[i]=0;
- 
+  //fNelements is only the initial capacity, the hash grows with the hits
+  fNext.reserve(fNelements);
+  fPos.reserve(fNelements);
+  fHashMask=0;
+  size_t nslots=16;
+  while(nslots<2*(size_t)fNelements) nslots*=2;
+  ResizeHash(nslots);
+
   fNhits=0;
   fHCID=-1;
 }
@@ -69,32 +76,28 @@ G4bool A2WCSD::ProcessHits(G4Step* aStep,G4TouchableHistory*)
   id = volume->GetCopyNo();
 
   //  G4cout<<volume->GetName()<<" id "<<id <<" edep "<<edep/MeV<<" "<<track->GetDefinition()->GetParticleName()<<" "<<track->GetParentID()<<G4endl;
-  if(fNhits>fNelements){G4cout<<"Too many hits stored in G4bool A2WCSD::ProcessHits(G4Step* aStep,G4TouchableHistory*) need to increase fNelements from A2DetMWPC.cc if 100 is not enough!!!"<<G4endl;return false;}
 
   //check to see if this hit is close to a previous hit
   // e.g. ionised electrons should not create a new hit
   G4ThreeVector vhit=aStep->GetPreStepPoint()->GetPosition();
-  G4int oldid=-1;
-  for(G4int i=0;i<fNhits;i++){
-    if((fabs((vhit-((*fCollection)[i]->GetPos())).r()))<3*mm) {oldid=i;}
-    // G4cout<<" diff " <<i<<" "<<abs((vhit-((*fCollection)[i]->GetPos())).r())/mm<<G4endl;
-  }
+  G4int oldid=FindHit(vhit);
   if (oldid<0){
     //if this crystal has already had a hit
     //don't make a new one, add on to old one.   
     //  G4cout<<"Make hit "<<fNhits<<" "<<vhit<<G4endl;    
     A2Hit* myHit = new A2Hit;
-    myHit->AddEnergy(edep);
+    myHit->AddEnergy(edep, aStep->GetTrack()->GetWeight());
     myHit->SetPos(aStep->GetPreStepPoint()->GetPosition());
     myHit->SetID(id);
     myHit->SetTime(aStep->GetPreStepPoint()->GetGlobalTime());
     fCollection->insert(myHit);
+    AddHit(vhit);
     fNhits++;
   }
   else // This is not new
     {
       //  G4cout<<"Add to prvoius hit "<<G4endl;
-    (*fCollection)[oldid]->AddEnergy(edep);
+    (*fCollection)[oldid]->AddEnergy(edep, aStep->GetTrack()->GetWeight());
     }
   //G4cout<<"done "<<fNhits<<G4endl;
   return true;
@@ -106,20 +109,82 @@ void A2WCSD::EndOfEvent(G4HCofThisEvent* HCE)
   // G4cout<<"EndOfEvent( "<<fHCID<<" "<<fCollection<<" "<<fNhits<<G4endl;
   if(fHCID<0) fHCID = G4SDManager::GetSDMpointer()->GetCollectionID(collectionName[0]);
   if(fNhits>0)  HCE->AddHitsCollection(fHCID,fCollection);
+  else delete fCollection; //empty collections are not owned by the event
   //G4cout<<"EndOfEvent( "<<G4endl;
  
-  //reset hit arrays
-  for (G4int i=0;i<fNhits;i++) 
-    {
-      fhitID[fHits[i]]=-1;
-      fHits[i]=0;
-    }
+  //reset the spatial hash
+  for (size_t i=0;i<fCellUsed.size();i++) fCellHead[fCellUsed[i]]=-1;
+  fCellUsed.clear();
+  fNext.clear();
+  fPos.clear();
   fNhits=0;
   //G4cout<<"EndOfEvent( done"<<G4endl;
 }
 
 
 
+void A2WCSD::ResizeHash(size_t nslots)
+{
+  //(re)allocate nslots (power of 2) hash slots and insert the current hits
+  fCellKey.assign(nslots,0);
+  fCellHead.assign(nslots,-1);
+  fCellUsed.clear();
+  fCellUsed.reserve(nslots/2);
+  fHashMask=nslots-1;
+  std::vector<G4ThreeVector> pos;
+  pos.swap(fPos);
+  fNext.clear();
+  for(size_t i=0;i<pos.size();i++) AddHit(pos[i]);
+}
+
+
+size_t A2WCSD::FindSlot(G4long key) const
+{
+  //slot of the cell 'key' or the empty slot where it would be inserted
+  size_t slot=((uint64_t)key*0x9E3779B97F4A7C15ULL)>>32 & fHashMask;
+  while(fCellHead[slot]>=0 && fCellKey[slot]!=key) slot=(slot+1)&fHashMask;
+  return slot;
+}
+
+
+G4int A2WCSD::FindHit(const G4ThreeVector& pos) const
+{
+  //last created hit closer than the merge radius to pos (-1 if none):
+  //only the 27 cells around pos can contain such hits
+  G4long ix=(G4long)std::floor(pos.x()/fgMergeRadius);
+  G4long iy=(G4long)std::floor(pos.y()/fgMergeRadius);
+  G4long iz=(G4long)std::floor(pos.z()/fgMergeRadius);
+  G4int oldid=-1;
+  for(G4long dx=-1;dx<=1;dx++)
+    for(G4long dy=-1;dy<=1;dy++)
+      for(G4long dz=-1;dz<=1;dz++){
+        size_t slot=FindSlot(CellKey(ix+dx,iy+dy,iz+dz));
+        //hits of a cell are chained from the newest to the oldest
+        for(G4int i=fCellHead[slot];i>oldid;i=fNext[i])
+          if((pos-fPos[i]).r()<fgMergeRadius) {oldid=i;break;}
+      }
+  return oldid;
+}
+
+
+void A2WCSD::AddHit(const G4ThreeVector& pos)
+{
+  //add the next hit at pos to the spatial hash (load factor <= 1/2)
+  if(2*(fCellUsed.size()+1)>fCellHead.size()) ResizeHash(2*fCellHead.size());
+  G4long key=CellKey((G4long)std::floor(pos.x()/fgMergeRadius),
+                     (G4long)std::floor(pos.y()/fgMergeRadius),
+                     (G4long)std::floor(pos.z()/fgMergeRadius));
+  size_t slot=FindSlot(key);
+  if(fCellHead[slot]<0){
+    fCellKey[slot]=key;
+    fCellUsed.push_back(slot);
+  }
+  fNext.push_back(fCellHead[slot]);
+  fCellHead[slot]=fPos.size();
+  fPos.push_back(pos);
+}
+
+
 void A2WCSD::clear()
 {} 
 
@@ -132,6 +197,13 @@ void A2WCSD::PrintAll()
 {} 
 
 
+G4VSensitiveDetector* A2WCSD::Clone() const
+{
+  //worker thread copy of this detector (fNelements includes the 0 element)
+  return new A2WCSD(SensitiveDetectorName,fNelements-1);
+}
+
+
 
 
 
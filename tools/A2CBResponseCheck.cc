@@ -0,0 +1,297 @@
+// compare the Crystal Ball response of a run with parameterised showers
+// (/A2/physics/FastCBShower) with the one of a fully simulated run
+//
+// Usage: A2CBResponseCheck full.root fast.root [histograms.root]
+// Both runs should use the same single-particle generator settings, e.g. single
+// photons. Run it in the A2Geant4 directory: the CB geometry is built to get the
+// crystal neighbours (data/CrystalConvert.in is needed for the crystal ids).
+// Compared per event are the response of the whole ball (energy sum, fraction of
+// the highest crystal E1/E, fraction of the two highest crystals (E1+E2)/E,
+// number of crystals) and of the clusters: the energy of the cluster around the
+// highest crystal (the crystal and its neighbours), its shape E1/Ecl and the
+// number of clusters, i.e. of local maxima above the seed threshold. Events with
+// more than one generated particle are skipped.
+
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+#include <functional>
+
+#include "TFile.h"
+#include "TTree.h"
+#include "TH1.h"
+#include "TString.h"
+
+#include "G4ios.hh"
+#include "G4NistManager.hh"
+#include "G4Box.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4SystemOfUnits.hh"
+
+#include "A2DetCrystalBall.hh"
+
+// CB observables
+enum {
+    kESum,
+    kE1,
+    kE2,
+    kNCryst,
+    kECl,
+    kShape,
+    kNClust,
+    kNObs
+};
+
+static const char* gObsName[kNObs] = { "esum", "e1", "e2", "ncryst", "ecl", "e1ecl", "nclust" };
+static const char* gObsTitle[kNObs] = { "CB energy sum [GeV]", "E_{1}/E", "(E_{1}+E_{2})/E", "number of crystals",
+                                        "cluster energy [GeV]", "E_{1}/E_{cl}", "number of clusters" };
+
+// CB crystals and their neighbours
+static const Int_t gNCryst = 720;
+static std::vector<Int_t> gNeighbours[gNCryst];
+
+// cluster seed threshold [GeV]
+static const Double_t gSeedThreshold = 0.015;
+
+//______________________________________________________________________________
+static G4bool BuildNeighbours()
+{
+    // Build the CB geometry and fill the neighbour lists of the crystals.
+    // The neighbours of a crystal are the crystals seen from the target within
+    // 2.3 times the angle to the closest one. In a plane of triangles of side a
+    // the 12 crystals sharing an edge or a corner are at a/sqrt(3) to 2a/sqrt(3),
+    // the closest crystals not touching at 1.53a.
+
+    // place the crystals in an empty world
+    G4LogicalVolume* world = new G4LogicalVolume(new G4Box("World", 2*m, 2*m, 2*m),
+                                                 G4NistManager::Instance()->FindOrBuildMaterial("G4_AIR"), "World");
+    A2DetCrystalBall* cb = new A2DetCrystalBall();
+    cb->SetIsInteractive(0);
+    cb->Construct(world);
+
+    // crystal directions (the copy number is the crystal id of the output)
+    std::vector<G4ThreeVector> dir(gNCryst);
+    std::vector<G4bool> placed(gNCryst, false);
+    for (size_t i = 0; i < world->GetNoDaughters(); i++)
+    {
+        G4VPhysicalVolume* pv = world->GetDaughter(i);
+        if (pv->GetName().find("CRYSTAL_") != 0)
+            continue;
+        G4int id = pv->GetCopyNo();
+        if (id < 0 || id >= gNCryst)
+            continue;
+        dir[id] = pv->GetTranslation().unit();
+        placed[id] = true;
+    }
+
+    // neighbours
+    Int_t nPlaced = 0;
+    size_t nMin = gNCryst;
+    size_t nMax = 0;
+    for (Int_t i = 0; i < gNCryst; i++)
+    {
+        if (!placed[i])
+            continue;
+        nPlaced++;
+
+        G4double closest = 180*deg;
+        for (Int_t j = 0; j < gNCryst; j++)
+            if (j != i && placed[j])
+                closest = std::min(closest, dir[i].angle(dir[j]));
+        for (Int_t j = 0; j < gNCryst; j++)
+            if (j != i && placed[j] && dir[i].angle(dir[j]) < 2.3*closest)
+                gNeighbours[i].push_back(j);
+
+        nMin = std::min(nMin, gNeighbours[i].size());
+        nMax = std::max(nMax, gNeighbours[i].size());
+    }
+
+    if (nPlaced == 0)
+    {
+        G4cout << "Could not find the CB crystals in the geometry" << G4endl;
+        return false;
+    }
+    G4cout << "CB geometry: " << nPlaced << " crystals with " << nMin << " to "
+           << nMax << " neighbours" << G4endl;
+
+    return true;
+}
+
+//______________________________________________________________________________
+static G4bool FillHistograms(const char* fileName, const char* tag, Double_t eMax, TH1* h[kNObs])
+{
+    // Fill the histograms of the CB observables of the events in 'fileName'.
+
+    TFile* f = TFile::Open(fileName);
+    if (!f || f->IsZombie())
+    {
+        G4cout << "Could not open the file " << fileName << G4endl;
+        return false;
+    }
+    TTree* t = (TTree*) f->Get("h12");
+    if (!t)
+    {
+        G4cout << "Could not find the tree h12 in " << fileName << G4endl;
+        return false;
+    }
+
+    // CB and generator branches
+    Int_t nhits;
+    Int_t npart;
+    std::vector<Float_t> ecryst(gNCryst);
+    std::vector<Int_t> icryst(gNCryst);
+    t->SetBranchStatus("*", 0);
+    t->SetBranchStatus("nhits", 1);
+    t->SetBranchStatus("ecryst", 1);
+    t->SetBranchStatus("icryst", 1);
+    t->SetBranchStatus("npart", 1);
+    t->SetBranchAddress("nhits", &nhits);
+    t->SetBranchAddress("ecryst", &ecryst[0]);
+    t->SetBranchAddress("icryst", &icryst[0]);
+    t->SetBranchAddress("npart", &npart);
+
+    // create histograms
+    Int_t nBins[kNObs] = { 200, 100, 100, 60, 200, 100, 10 };
+    Double_t max[kNObs] = { eMax, 1, 1, 60, eMax, 1, 10 };
+    for (Int_t i = 0; i < kNObs; i++)
+    {
+        h[i] = new TH1D(TString::Format("%s_%s", gObsName[i], tag), gObsTitle[i], nBins[i], 0, max[i]);
+        h[i]->SetDirectory(0);
+    }
+
+    // energies of the crystals of an event
+    std::vector<Double_t> ecr(gNCryst, 0);
+
+    // loop over events
+    Long64_t nSkipped = 0;
+    for (Long64_t i = 0; i < t->GetEntries(); i++)
+    {
+        t->GetEntry(i);
+
+        // the whole-ball sums and the leading cluster are only meaningful for
+        // single particles
+        if (npart != 1)
+        {
+            nSkipped++;
+            continue;
+        }
+        if (nhits <= 0)
+            continue;
+
+        // sort crystal energies
+        std::vector<Float_t> e(ecryst.begin(), ecryst.begin() + std::min(nhits, gNCryst));
+        std::sort(e.begin(), e.end(), std::greater<Float_t>());
+        Double_t sum = 0;
+        for (size_t j = 0; j < e.size(); j++)
+            sum += e[j];
+        if (sum <= 0)
+            continue;
+
+        h[kESum]->Fill(sum);
+        h[kE1]->Fill(e[0] / sum);
+        h[kE2]->Fill((e[0] + (e.size() > 1 ? e[1] : 0)) / sum);
+        h[kNCryst]->Fill(e.size());
+
+        // energies per crystal
+        for (size_t j = 0; j < e.size(); j++)
+            if (icryst[j] >= 0 && icryst[j] < gNCryst)
+                ecr[icryst[j]] += ecryst[j];
+
+        // clusters: local maxima above the seed threshold (for equal energies
+        // the crystal with the lower id is the maximum)
+        Int_t nClust = 0;
+        Int_t central = -1;
+        for (size_t j = 0; j < e.size(); j++)
+        {
+            Int_t id = icryst[j];
+            if (id < 0 || id >= gNCryst || ecr[id] < gSeedThreshold)
+                continue;
+            G4bool isMax = true;
+            for (size_t k = 0; k < gNeighbours[id].size(); k++)
+            {
+                Int_t n = gNeighbours[id][k];
+                if (ecr[n] > ecr[id] || (ecr[n] == ecr[id] && n < id))
+                {
+                    isMax = false;
+                    break;
+                }
+            }
+            if (!isMax)
+                continue;
+            nClust++;
+            if (central < 0 || ecr[id] > ecr[central])
+                central = id;
+        }
+        h[kNClust]->Fill(nClust);
+
+        // energy and shape of the cluster around the highest crystal
+        if (central >= 0)
+        {
+            Double_t ecl = ecr[central];
+            for (size_t k = 0; k < gNeighbours[central].size(); k++)
+                ecl += ecr[gNeighbours[central][k]];
+            h[kECl]->Fill(ecl);
+            h[kShape]->Fill(ecr[central] / ecl);
+        }
+
+        // reset the crystal energies
+        for (size_t j = 0; j < e.size(); j++)
+            if (icryst[j] >= 0 && icryst[j] < gNCryst)
+                ecr[icryst[j]] = 0;
+    }
+
+    G4cout << fileName << ": " << t->GetEntries() << " events";
+    if (nSkipped)
+        G4cout << " (" << nSkipped << " events with more than one generated particle skipped)";
+    G4cout << G4endl;
+
+    delete f;
+    return true;
+}
+
+//______________________________________________________________________________
+int main(int argc, char** argv)
+{
+    if (argc < 3 || argc > 4)
+    {
+        G4cout << "Usage: " << argv[0] << " full.root fast.root [histograms.root]" << G4endl;
+        return EXIT_FAILURE;
+    }
+
+    // crystal neighbours from the CB geometry
+    if (!BuildNeighbours())
+        return EXIT_FAILURE;
+
+    // fill histograms of both runs (energy range up to 1.5 GeV)
+    TH1* hFull[kNObs];
+    TH1* hFast[kNObs];
+    if (!FillHistograms(argv[1], "full", 1.5, hFull) ||
+        !FillHistograms(argv[2], "fast", 1.5, hFast))
+        return EXIT_FAILURE;
+
+    // compare the distributions
+    G4cout << TString::Format("%-12s %12s %12s %12s %12s %10s",
+                              "observable", "mean full", "mean fast", "rms full", "rms fast", "KS prob.") << G4endl;
+    for (Int_t i = 0; i < kNObs; i++)
+    {
+        G4cout << TString::Format("%-12s %12.4f %12.4f %12.4f %12.4f %10.3g", gObsName[i],
+                                  hFull[i]->GetMean(), hFast[i]->GetMean(),
+                                  hFull[i]->GetRMS(), hFast[i]->GetRMS(),
+                                  hFull[i]->KolmogorovTest(hFast[i])) << G4endl;
+    }
+
+    // save the histograms
+    if (argc == 4)
+    {
+        TFile out(argv[3], "RECREATE");
+        for (Int_t i = 0; i < kNObs; i++)
+        {
+            hFull[i]->Write();
+            hFast[i]->Write();
+        }
+        G4cout << "Histograms written to " << argv[3] << G4endl;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,35 @@
+// convert a text target magnetic field map (.dat or .dat.xz) into the
+// binary format memory-mapped by A2MagneticField
+//
+// Usage: A2FieldMapConvert map.dat.xz [map.a2fmap]
+// Without output file the cache file used by A2Geant4 (map.dat.xz.a2fmap) is written.
+
+#include <cstdlib>
+
+#include "G4ios.hh"
+
+#include "A2MagneticField.hh"
+
+int main(int argc, char** argv)
+{
+    if (argc < 2 || argc > 3)
+    {
+        G4cout << "Usage: " << argv[0] << " map.dat[.xz] [map.a2fmap]" << G4endl;
+        return EXIT_FAILURE;
+    }
+
+    G4String in = argv[1];
+    G4String out = argc == 3 ? G4String(argv[2]) : A2MagneticField::GetCacheName(in);
+
+    // read the text map and write it in the binary format
+    A2MagneticField field;
+    if (!field.ReadTextMap(in) || !field.WriteBinaryMap(out))
+        return EXIT_FAILURE;
+
+    // check the written map
+    A2MagneticField check;
+    if (!check.MapBinaryMap(out))
+        return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}